@@ -13,6 +13,26 @@
 #include "EquivalenceClass.h"
 #include "SearchPath.h"
 
+#include <vector>
+
+/**
+ * @namespace StatsPrecision
+ * @brief Contains enumeration for the floating type used by the pattern statistics.
+ */
+namespace StatsPrecision
+{
+/**
+ * @enum PrecisionEnum
+ * @brief Precision of the flows, descents and p-value computations.
+ */
+enum PrecisionEnum
+{
+    Double,  ///< Compute in double precision
+    Single,  ///< Compute in single precision (half the matrix memory)
+    Validate ///< Compute in single precision and check every pattern decision against double
+};
+}
+
 /**
  * @class ADIOSParams
  * @brief Parameter set for the ADIOS algorithm.
@@ -26,6 +46,12 @@ class ADIOSParams
         double alpha;             ///< Alpha parameter for ADIOS.
         unsigned int contextSize; ///< Context size parameter.
         double overlapThreshold;  ///< Overlap threshold parameter.
+        unsigned int relayoutInterval = 0; ///< Iterations between locality relayouts (0 disables relayout).
+        StatsPrecision::PrecisionEnum precision = StatsPrecision::Double; ///< Floating type of the flows/descents/p-value pipeline.
+        unsigned int approximateAbove = 0; ///< Pattern count from which significance tails may be approximated (0: always exact).
+        double approximationError = 1e-6; ///< Largest accepted error bound of an approximated significance tail (see binom_tail).
+        unsigned int publishInterval = 0; ///< Iterations between snapshots published for concurrent readers (0: none).
+        std::vector<unsigned int> contextSchedule; ///< Context sizes to converge at before contextSize, strictly increasing and below it (empty: contextSize only).
 
         /**
          * @brief Construct ADIOSParams with all parameters specified.
@@ -0,0 +1,117 @@
+/**
+ * @file BatchRunner.h
+ * @brief Declares the BatchRunner class, which distills many corpora concurrently in one process.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "ADIOSUtils.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * @class BatchRunner
+ * @brief Runs a manifest of distillation jobs on a shared pool of worker threads.
+ *
+ * Each job reads one corpus, distills it with its own parameters and writes the grammar to its
+ * own output file; the job's log messages go to "<output>.log" instead of stderr. A job runs on
+ * one worker thread under a JobMemory budget, so a job that allocates more than its limit fails
+ * alone while the others go on. Workers take the largest remaining corpus first, which keeps the
+ * pool busy until the end; results are reported in manifest order.
+ *
+ * Manifest lines (blank lines and lines starting with '#' are skipped):
+ *
+ *     corpus output eta alpha context_size coverage [format=pcfg|snapshot] [memory-mb=N]
+ *
+ * Relative corpus and output paths are taken relative to the manifest's directory.
+ */
+class BatchRunner
+{
+    public:
+        /**
+         * @brief One distillation job.
+         */
+        struct Job
+        {
+            std::string corpus;                      ///< Corpus file.
+            std::string output;                      ///< Grammar file to write.
+            std::string format = "pcfg";             ///< "pcfg" (text) or "snapshot" (binary).
+            ADIOSParams params = ADIOSParams(0.9, 0.01, 5, 0.65);  ///< Distillation parameters.
+            std::size_t memoryLimit = 0;             ///< Byte limit of this job (0: the runner's default).
+        };
+
+        /**
+         * @brief Outcome of a job.
+         */
+        enum class Status
+        {
+            Succeeded,      ///< The grammar was written.
+            Failed,         ///< The corpus could not be read or the output written (see message).
+            OutOfMemory     ///< The job hit its memory limit.
+        };
+
+        /**
+         * @brief Result and timing of one job.
+         */
+        struct Result
+        {
+            Status status = Status::Failed;
+            std::string message;             ///< Error message (failed jobs).
+            std::size_t sequences = 0;       ///< Sequences in the corpus.
+            unsigned int patterns = 0;       ///< Significant patterns learned.
+            double seconds = 0.0;            ///< Wall time of the job.
+            std::size_t peakBytes = 0;       ///< Peak net heap allocation of the job.
+        };
+
+        /**
+         * @brief Read a job manifest.
+         * @param in Stream to read from.
+         * @param directory Directory that relative paths are resolved against ("" for the working directory).
+         * @return The jobs in manifest order.
+         * @throws std::runtime_error on a malformed line (the message names the line).
+         */
+        static std::vector<Job> readManifest(std::istream &in, const std::string &directory = "");
+        /**
+         * @brief Get the name of a job status, as used in the report.
+         * @param status The status.
+         * @return "ok", "failed" or "out-of-memory".
+         */
+        static const char* statusName(Status status);
+
+        /**
+         * @brief Create a runner.
+         * @param threads Number of worker threads (at least 1).
+         * @param memoryLimit Default byte limit of each job (0: unlimited).
+         */
+        BatchRunner(unsigned int threads, std::size_t memoryLimit = 0);
+
+        /**
+         * @brief Run jobs concurrently.
+         * @param jobs The jobs.
+         * @return One result per job, in the order of jobs.
+         */
+        std::vector<Result> run(const std::vector<Job> &jobs) const;
+        /**
+         * @brief Write the per-job report and the totals, tab separated.
+         * @param out Stream to write to.
+         * @param jobs The jobs.
+         * @param results Their results.
+         * @param wallSeconds Wall time of the whole batch.
+         */
+        void writeReport(std::ostream &out, const std::vector<Job> &jobs, const std::vector<Result> &results, double wallSeconds) const;
+
+    private:
+        Result runJob(const Job &job) const;
+
+        unsigned int threads;
+        std::size_t memory_limit;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file DistillWorkspace.h
+ * @brief Declares ScratchMatrix and DistillWorkspace, reusable per-thread buffers for the flow/descent search.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef DISTILLWORKSPACE_H
+#define DISTILLWORKSPACE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class ScratchMatrix
+ * @brief Dense square matrix whose storage is kept at its high-water capacity across resets.
+ *
+ * Element access mirrors TNT::Array2D (operator(), dim1(), dim2()). reset() only touches the
+ * dim x dim entries in use and reallocates only when dim exceeds every earlier size.
+ */
+template <typename T>
+class ScratchMatrix
+{
+    public:
+        /**
+         * @brief Resize to dim x dim and fill with a value; capacity is never released.
+         * @param dim Number of rows and columns.
+         * @param value Value for every entry.
+         */
+        void reset(unsigned int dim, T value)
+        {
+            size = dim;
+            data.assign(std::size_t(dim) * dim, value);
+        }
+        /**
+         * @brief Access an entry.
+         * @param i Row index.
+         * @param j Column index.
+         * @return Reference to the entry.
+         */
+        T& operator()(unsigned int i, unsigned int j) { return data[std::size_t(i) * size + j]; }
+        /**
+         * @brief Access an entry.
+         * @param i Row index.
+         * @param j Column index.
+         * @return Const reference to the entry.
+         */
+        const T& operator()(unsigned int i, unsigned int j) const { return data[std::size_t(i) * size + j]; }
+        /**
+         * @brief Get the number of rows.
+         * @return The number of rows.
+         */
+        int dim1() const { return size; }
+        /**
+         * @brief Get the number of columns.
+         * @return The number of columns.
+         */
+        int dim2() const { return size; }
+        /**
+         * @brief Get the number of entries the storage can hold without reallocating.
+         * @return The capacity in entries.
+         */
+        std::size_t capacity() const { return data.capacity(); }
+
+    private:
+        unsigned int size = 0;
+        std::vector<T> data;
+};
+
+/**
+ * @class DistillWorkspace
+ * @brief Flow, descent and p-value buffers for the significant-pattern search of one thread.
+ *
+ * Every search path needs L x L flow and descent matrices (in the statistics precision) and an
+ * L x L p-value cache. Taking them from the calling thread's workspace instead of allocating them
+ * per path keeps their memory mapped across paths, so after the longest path has been seen the
+ * search no longer allocates or page-faults for them. A workspace is not shared between threads;
+ * local() hands each thread its own.
+ */
+class DistillWorkspace
+{
+    public:
+        /**
+         * @brief Flow and descent matrices in one precision.
+         */
+        template <typename Real>
+        struct Descents
+        {
+            ScratchMatrix<Real> flows;     ///< P_R (above the diagonal) and P_L (below it).
+            ScratchMatrix<Real> descents;  ///< D_R and D_L.
+        };
+
+        /**
+         * @brief Get the workspace of the calling thread.
+         * @return The thread's workspace, created on first use.
+         */
+        static DistillWorkspace& local();
+
+        /**
+         * @brief Get the flow and descent matrices of a precision.
+         * @return The matrices (single and double precision are separate, so both can be live at once).
+         */
+        template <typename Real>
+        Descents<Real>& descents();
+
+        /**
+         * @brief Cache of significance values per (row, column) of the current path; 2.0 marks "not computed".
+         */
+        ScratchMatrix<double> pvalueCache;
+
+    private:
+        DistillWorkspace() {}
+        DistillWorkspace(const DistillWorkspace&) = delete;
+        DistillWorkspace& operator=(const DistillWorkspace&) = delete;
+
+        Descents<float> float_descents;
+        Descents<double> double_descents;
+};
+
+template <>
+inline DistillWorkspace::Descents<float>& DistillWorkspace::descents<float>() { return float_descents; }
+template <>
+inline DistillWorkspace::Descents<double>& DistillWorkspace::descents<double>() { return double_descents; }
+
+#endif
@@ -10,6 +10,7 @@
 #define EQUIVALENCECLASS_H
 
 #include "LexiconUnit.h"
+#include "SearchPath.h"
 #include <vector>
 #include <string>
 #include <sstream>
@@ -32,6 +33,11 @@ class EquivalenceClass: public LexiconUnit, public std::vector<unsigned int>
          * @param units Vector of unit indices to initialize the class.
          */
         explicit EquivalenceClass(const std::vector<unsigned int> &units);
+        /**
+         * @brief Construct from a view of unit indices.
+         * @param units View of the unit indices to copy into the class.
+         */
+        explicit EquivalenceClass(PathView units);
         /**
          * @brief Destructor.
          */
@@ -0,0 +1,155 @@
+/**
+ * @file FrozenGrammar.h
+ * @brief Declares the FrozenGrammar class, an immutable snapshot of a learned grammar for concurrent readers.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef FROZENGRAMMAR_H
+#define FROZENGRAMMAR_H
+
+#include "InsideScorer.h"
+#include "PCFG.h"
+#include "SearchPath.h"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FrozenGrammar
+ * @brief Read-only grammar with flat rule tables, supporting sampling and scoring.
+ *
+ * Rules are grouped by left-hand side in one flat table (CSR): the alternatives of a symbol are
+ * contiguous and their right-hand sides are slices of a single symbol array. Each nonterminal has a
+ * Walker alias table over its alternatives, so generate() draws a rule in constant time. Nothing is
+ * modified after construction, so one instance (usually obtained from RDSGraph::freeze() and held
+ * by a std::shared_ptr<const FrozenGrammar>) can serve generate() and score() calls from any number
+ * of threads without locking, as long as every thread uses its own random engine.
+ */
+class FrozenGrammar
+{
+    public:
+        /**
+         * @brief Freeze a grammar.
+         * @param grammar The grammar (see PCFG). It must have an "S" start symbol and no unary cycles.
+         * @throws std::invalid_argument if the grammar has no start symbol.
+         * @throws std::runtime_error if the grammar has a unary cycle (see InsideScorer).
+         */
+        explicit FrozenGrammar(const PCFG &grammar);
+
+        /**
+         * @brief Sample a sentence from the start symbol.
+         * Alternatives are drawn in proportion to their probabilities; a symbol whose rules all have
+         * probability zero chooses uniformly among them.
+         * @param rng Random engine (not shared between threads).
+         * @param maxLength Maximum number of tokens; guards against runaway recursive grammars.
+         * @return The sentence tokens, without "*" and "#" markers.
+         * @throws std::runtime_error if the sentence grows beyond maxLength tokens.
+         */
+        std::vector<std::string> generate(std::mt19937 &rng, unsigned int maxLength = 10000) const;
+        /**
+         * @brief Sample the yield of any symbol and append it to a token list.
+         * @param symbol The symbol to expand (a terminal is appended as is).
+         * @param rng Random engine (not shared between threads).
+         * @param out Tokens to append to.
+         * @param maxLength Maximum size of out.
+         * @throws std::runtime_error if out grows beyond maxLength tokens.
+         */
+        void expand(unsigned int symbol, std::mt19937 &rng, std::vector<std::string> &out, unsigned int maxLength = 10000) const;
+        /**
+         * @brief Compute the log probability of a sentence with the inside algorithm.
+         * @param sentence The sentence tokens, without "*" and "#" markers.
+         * @return The log probability and parse status (see InsideScorer).
+         */
+        InsideScorer::Result score(const std::vector<std::string> &sentence) const { return scorer.score(sentence); }
+
+        /**
+         * @brief Get the number of symbols (terminals and nonterminals).
+         * @return The number of symbols.
+         */
+        unsigned int symbolCount() const { return names.size(); }
+        /**
+         * @brief Get the number of rules.
+         * @return The number of rules.
+         */
+        unsigned int ruleCount() const { return probabilities.size(); }
+        /**
+         * @brief Get the name of a symbol.
+         * @param id The symbol id (as in the PCFG the grammar was frozen from).
+         * @return The symbol name.
+         */
+        const std::string& symbolName(unsigned int id) const { return names[id]; }
+        /**
+         * @brief Look up a symbol id by name.
+         * @param name The symbol name.
+         * @return The symbol id, or PCFG::npos if the symbol is unknown.
+         */
+        unsigned int symbolId(const std::string &name) const;
+        /**
+         * @brief Get the id of the start symbol "S".
+         * @return The start symbol id.
+         */
+        unsigned int startSymbol() const { return start; }
+        /**
+         * @brief Get the total probability of the rules of a symbol that derive a given right-hand side.
+         * @param lhs The left-hand side symbol id.
+         * @param right The right-hand side symbol ids.
+         * @return The probability (0 if there is no such rule).
+         */
+        double ruleProbability(unsigned int lhs, const std::vector<unsigned int> &right) const;
+        /**
+         * @brief Check whether a symbol has rules.
+         * @param id The symbol id.
+         * @return True for nonterminals.
+         */
+        bool isNonterminal(unsigned int id) const { return rule_begin[id] != rule_begin[id + 1]; }
+        /**
+         * @brief Get the rules of a symbol as the index range [rulesBegin(symbol), rulesEnd(symbol)).
+         * @param symbol The left-hand side symbol id.
+         * @return The first rule index.
+         */
+        unsigned int rulesBegin(unsigned int symbol) const { return rule_begin[symbol]; }
+        /**
+         * @brief Get the end of the rule index range of a symbol.
+         * @param symbol The left-hand side symbol id.
+         * @return One past the last rule index.
+         */
+        unsigned int rulesEnd(unsigned int symbol) const { return rule_begin[symbol + 1]; }
+        /**
+         * @brief Get the right-hand side of a rule.
+         * @param rule The rule index.
+         * @return View of the right-hand side symbol ids.
+         */
+        PathView ruleRhs(unsigned int rule) const { return PathView(rhs.data() + rhs_begin[rule], rhs_begin[rule + 1] - rhs_begin[rule]); }
+        /**
+         * @brief Get the probability of a rule.
+         * @param rule The rule index.
+         * @return The rule probability.
+         */
+        double probability(unsigned int rule) const { return probabilities[rule]; }
+
+    private:
+        void buildAliasTable(unsigned int first, unsigned int last);
+        unsigned int sampleRule(unsigned int symbol, std::mt19937 &rng) const;
+
+        std::vector<std::string> names;
+        std::unordered_map<std::string, unsigned int> ids;
+        unsigned int start;
+
+        // rules grouped by left-hand side: the rules of symbol s are [rule_begin[s], rule_begin[s+1])
+        std::vector<unsigned int> rule_begin;
+        // right-hand side of rule r is rhs[rhs_begin[r] .. rhs_begin[r+1])
+        std::vector<unsigned int> rhs_begin;
+        std::vector<unsigned int> rhs;
+        std::vector<double> probabilities;
+        // Walker alias table per symbol, indexed by rule: keep rule r with chance alias_keep[r], else take alias_rule[r]
+        std::vector<double> alias_keep;
+        std::vector<unsigned int> alias_rule;
+
+        InsideScorer scorer;
+};
+
+#endif
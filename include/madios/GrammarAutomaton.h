@@ -0,0 +1,90 @@
+/**
+ * @file GrammarAutomaton.h
+ * @brief Declares the GrammarAutomaton class, a minimized DFA that recognizes the language of a learned grammar.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef GRAMMARAUTOMATON_H
+#define GRAMMARAUTOMATON_H
+
+#include "InsideScorer.h"
+#include "PCFG.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RDSGraph;
+
+/**
+ * @class GrammarAutomaton
+ * @brief Finite-state recognizer for the sentences a (non-recursive) grammar derives.
+ *
+ * SPs and ECs normally form a DAG, so the language of the start symbol is regular. The grammar is
+ * unfolded into an epsilon-free NFA (every rule is a chain of states between the two ends of its
+ * left-hand side), determinized by subset construction and minimized by Moore partition refinement.
+ * Recognition then takes one transition per token. If the grammar is recursive, or the NFA or DFA
+ * grows beyond the state limit, the automaton is not built and recognition falls back to the chart
+ * parser (see InsideScorer).
+ */
+class GrammarAutomaton
+{
+    public:
+        /**
+         * @brief Compile a grammar.
+         * @param grammar The grammar (see PCFG). It must have an "S" start symbol.
+         * @param maxStates Maximum number of NFA or DFA states before falling back to chart parsing.
+         * @throws std::invalid_argument if the grammar has no start symbol.
+         */
+        explicit GrammarAutomaton(const PCFG &grammar, unsigned int maxStates = 200000);
+        /**
+         * @brief Compile the grammar that convert2PCFG describes for a learned graph.
+         * @param graph The distilled graph.
+         * @param maxStates Maximum number of NFA or DFA states before falling back to chart parsing.
+         * @return The automaton.
+         */
+        static GrammarAutomaton fromGraph(const RDSGraph &graph, unsigned int maxStates = 200000);
+
+        /**
+         * @brief Check whether the grammar derives a sentence.
+         * @param sentence The sentence tokens, without "*" and "#" markers.
+         * @return True if the start symbol derives the sentence.
+         */
+        bool recognizes(const std::vector<std::string> &sentence) const;
+        /**
+         * @brief Check whether the finite-state automaton was built.
+         * @return True if recognition uses the DFA, false if it falls back to chart parsing.
+         */
+        bool isCompiled() const { return !fallback; }
+        /**
+         * @brief Get the reason the automaton was not built.
+         * @return Empty if the automaton was built, otherwise a short explanation.
+         */
+        const std::string& fallbackReason() const { return fallback_reason; }
+        /**
+         * @brief Get the number of states of the minimized DFA.
+         * @return The number of states (0 when falling back).
+         */
+        unsigned int stateCount() const { return accepting.size(); }
+        /**
+         * @brief Get the number of transitions of the minimized DFA.
+         * @return The number of transitions (0 when falling back).
+         */
+        unsigned int transitionCount() const { return edge_word.size(); }
+
+    private:
+        std::unordered_map<std::string, unsigned int> vocabulary;
+        // minimized DFA: state 0 is the start state, transitions sorted by word (CSR)
+        std::vector<unsigned int> edge_begin;
+        std::vector<unsigned int> edge_word;
+        std::vector<unsigned int> edge_target;
+        std::vector<bool> accepting;
+
+        std::shared_ptr<const InsideScorer> fallback;
+        std::string fallback_reason;
+};
+
+#endif
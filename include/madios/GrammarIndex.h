@@ -0,0 +1,137 @@
+/**
+ * @file GrammarIndex.h
+ * @brief Declares the GrammarIndex class, an inverted index from words and units to the SPs and ECs that contain them.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef GRAMMARINDEX_H
+#define GRAMMARINDEX_H
+
+#include "PCFG.h"
+#include "SearchPath.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RDSGraph;
+
+/**
+ * @class GrammarIndex
+ * @brief Read-only containment index over the units (words, SPs and ECs) of a learned grammar.
+ *
+ * For every unit the index stores the SPs and ECs that contain it directly (its parents, as in
+ * RDSNode::parents) and its own elements (children), both as flat CSR arrays. Containment queries
+ * ("which patterns contain this word, directly or through nested units") and reachability queries
+ * ("every unit below P123") are breadth-first walks over these arrays, so their cost is
+ * proportional to the size of the answer. The start symbol "S" is not a unit and is not indexed.
+ * All queries are const and may run concurrently.
+ */
+class GrammarIndex
+{
+    public:
+        /**
+         * @brief Kind of a unit.
+         */
+        enum class Kind
+        {
+            Word,     ///< Terminal symbol.
+            Pattern,  ///< Significant pattern ("P<n>").
+            Class     ///< Equivalence class ("E<n>").
+        };
+
+        /**
+         * @brief Index a grammar in the convert2PCFG form.
+         * @param grammar The grammar; its S rules are ignored.
+         */
+        explicit GrammarIndex(const PCFG &grammar);
+        /**
+         * @brief Index a learned graph from its nodes' parent links.
+         * @param graph The distilled graph.
+         * @return The index; unit ids are node indices and names are those used by convert2PCFG.
+         */
+        static GrammarIndex fromGraph(const RDSGraph &graph);
+
+        /**
+         * @brief Look up a unit by name.
+         * @param name A word or unit name such as "P12".
+         * @return The unit id, or PCFG::npos if unknown.
+         */
+        unsigned int unitId(const std::string &name) const;
+        /**
+         * @brief Get the name of a unit.
+         * @param id The unit id.
+         * @return The unit name.
+         */
+        const std::string& unitName(unsigned int id) const { return names[id]; }
+        /**
+         * @brief Get the kind of a unit.
+         * @param id The unit id.
+         * @return The unit kind.
+         */
+        Kind kind(unsigned int id) const { return kinds[id]; }
+        /**
+         * @brief Get the number of units.
+         * @return The number of units.
+         */
+        unsigned int unitCount() const { return names.size(); }
+
+        /**
+         * @brief Get the elements of a unit: the sequence of an SP or the members of an EC.
+         * @param id The unit id.
+         * @return View of the element ids (empty for words).
+         */
+        PathView elements(unsigned int id) const { return PathView(child_ids.data() + child_begin[id], child_begin[id + 1] - child_begin[id]); }
+        /**
+         * @brief Get the SPs and ECs that contain a unit directly.
+         * @param id The unit id.
+         * @return View of the parent ids, sorted and without duplicates.
+         */
+        PathView parents(unsigned int id) const { return PathView(parent_ids.data() + parent_begin[id], parent_begin[id + 1] - parent_begin[id]); }
+        /**
+         * @brief Find the SPs and ECs that contain a unit, directly or through other units.
+         * @param id The unit id.
+         * @return The containing unit ids, sorted.
+         */
+        std::vector<unsigned int> containers(unsigned int id) const;
+        /**
+         * @brief Find the SPs that contain a unit, directly or through other units.
+         * @param id The unit id.
+         * @param transitive False to return only the SPs that contain the unit directly.
+         * @return The pattern ids, sorted.
+         */
+        std::vector<unsigned int> patternsContaining(unsigned int id, bool transitive = true) const;
+        /**
+         * @brief Find the ECs that contain a unit, directly or through other units.
+         * @param id The unit id.
+         * @param transitive False to return only the ECs that have the unit as a member.
+         * @return The class ids, sorted.
+         */
+        std::vector<unsigned int> classesContaining(unsigned int id, bool transitive = true) const;
+        /**
+         * @brief Find every unit reachable below a unit (the units whose rules it can use).
+         * @param id The unit id.
+         * @return The reachable unit ids (words included, the unit itself excluded), sorted.
+         */
+        std::vector<unsigned int> reachable(unsigned int id) const;
+
+    private:
+        GrammarIndex() {}
+        void addUnit(const std::string &name, Kind kind);
+        void finish(const std::vector<std::vector<unsigned int> > &children);
+        std::vector<unsigned int> closure(unsigned int id, const std::vector<unsigned int> &begin, const std::vector<unsigned int> &edges) const;
+        std::vector<unsigned int> filter(std::vector<unsigned int> ids, Kind wanted) const;
+
+        std::vector<std::string> names;
+        std::vector<Kind> kinds;
+        std::unordered_map<std::string, unsigned int> ids;
+        // CSR adjacency: elements in order (with repeats), parents sorted and unique
+        std::vector<unsigned int> child_begin;
+        std::vector<unsigned int> child_ids;
+        std::vector<unsigned int> parent_begin;
+        std::vector<unsigned int> parent_ids;
+};
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file GraphEpoch.h
+ * @brief Declares the GraphEpoch struct, a published snapshot of a graph for readers on other threads.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef GRAPHEPOCH_H
+#define GRAPHEPOCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class FrozenGrammar;
+
+/**
+ * @struct GraphEpoch
+ * @brief Immutable state of an RDSGraph at an iteration boundary of distill().
+ *
+ * The learner publishes a new epoch every ADIOSParams::publishInterval iterations and when
+ * distillation ends (see RDSGraph::snapshot()). An epoch owns copies of everything it shows and is
+ * never modified after publication, so any number of threads can read it while distillation goes
+ * on. It is freed when the last reader releases it.
+ */
+struct GraphEpoch
+{
+    unsigned int number = 0;                         ///< Publication number, from 1.
+    unsigned int iteration = 0;                      ///< Iterations of distill() completed before publication.
+    bool final = false;                              ///< True if published when distillation ended.
+    std::shared_ptr<const FrozenGrammar> grammar;    ///< The grammar learned so far (see RDSGraph::freeze()).
+    std::vector<std::string> names;                  ///< Name of each node ("*", "#", words, "P12", "E7").
+    std::vector<std::vector<unsigned int> > paths;   ///< Node ids of each search path, in corpus order.
+
+    /**
+     * @brief Get a search path as node names.
+     * @param path Index of the path in corpus order.
+     * @return The names of its nodes, including "*" and "#".
+     */
+    std::vector<std::string> pathNames(unsigned int path) const
+    {
+        std::vector<std::string> result;
+        result.reserve(paths[path].size());
+        for(unsigned int node : paths[path])
+            result.push_back(names[node]);
+        return result;
+    }
+};
+
+#endif
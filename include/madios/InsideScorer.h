@@ -0,0 +1,102 @@
+/**
+ * @file InsideScorer.h
+ * @brief Declares the InsideScorer class, which computes sentence probabilities under a learned PCFG.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef INSIDESCORER_H
+#define INSIDESCORER_H
+
+#include "PCFG.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class InsideScorer
+ * @brief Inside algorithm over a binarized copy of a PCFG, in log space.
+ *
+ * Rules with more than two right-hand side symbols are right-binarized through intermediate
+ * symbols that are shared between rules with the same suffix. Terminals act as their own
+ * preterminals, so lexical and nonterminal unary rules are handled by one unary closure that is
+ * applied to every span in topological order. Charts are dense per span and allocated per call,
+ * so score() may be called concurrently from several threads.
+ */
+class InsideScorer
+{
+    public:
+        /**
+         * @brief Outcome of scoring a sentence.
+         */
+        enum class Status
+        {
+            Parsed,          ///< The start symbol derives the sentence.
+            OutOfVocabulary, ///< The sentence contains a word the grammar never produces.
+            Unparsed         ///< All words are known, but the sentence has no derivation.
+        };
+
+        /**
+         * @brief Log probability and status of one sentence.
+         */
+        struct Result
+        {
+            double logProbability; ///< Natural log of the inside probability (-infinity unless Parsed).
+            Status status;         ///< Whether the sentence parsed.
+        };
+
+        /**
+         * @brief Binarize a grammar for scoring.
+         * @param grammar The grammar (see PCFG). It must have an "S" start symbol.
+         * @throws std::invalid_argument if the grammar has no start symbol.
+         * @throws std::runtime_error if the unary rules contain a cycle.
+         */
+        explicit InsideScorer(const PCFG &grammar);
+
+        /**
+         * @brief Compute the log inside probability of a sentence under the start symbol.
+         * @param sentence The sentence tokens, without "*" and "#" markers.
+         * @return The log probability and parse status.
+         */
+        Result score(const std::vector<std::string> &sentence) const;
+        /**
+         * @brief Get the number of symbols after binarization.
+         * @return The number of symbols, including intermediate ones.
+         */
+        unsigned int symbolCount() const { return num_symbols; }
+        /**
+         * @brief Get the name of a status for reports.
+         * @param status The status.
+         * @return "ok", "oov" or "unparsed".
+         */
+        static const char* statusName(Status status);
+
+    private:
+        struct BinaryRule
+        {
+            unsigned int parent;
+            unsigned int right;
+            double logProbability;
+        };
+        struct UnaryRule
+        {
+            unsigned int parent;
+            unsigned int child;
+            double logProbability;
+        };
+
+        void closeUnary(std::vector<double> &chart, std::vector<unsigned int> &active, size_t cell) const;
+
+        unsigned int num_symbols;
+        unsigned int start_symbol;
+        std::unordered_map<std::string, unsigned int> terminals;
+        // binary rules grouped by left child (CSR)
+        std::vector<unsigned int> binary_begin;
+        std::vector<BinaryRule> binary_rules;
+        // unary rules sorted so that every child is complete before its parents
+        std::vector<UnaryRule> unary_rules;
+};
+
+#endif
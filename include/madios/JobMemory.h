@@ -0,0 +1,120 @@
+/**
+ * @file JobMemory.h
+ * @brief Declares the JobMemory class, an allocation budget for jobs sharing one process.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef JOBMEMORY_H
+#define JOBMEMORY_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class JobMemory
+ * @brief Scoped budget on the heap memory allocated by the current thread and the threads it starts.
+ *
+ * While a JobMemory is alive, every operator new on its thread is charged to it and every
+ * operator delete on its thread is credited. Threads the job starts share the budget through
+ * JobMemory::Attach. The charging is done by the global allocation functions in JobAllocator.cpp,
+ * which is linked into the madios executable but not into madioslib: a program that links the
+ * library keeps the standard allocator unless it links JobAllocator.cpp too, and without it budgets
+ * count nothing. An allocation that would take the net total over the limit throws std::bad_alloc;
+ * after that the budget only keeps counting, so that the job can unwind and report the failure.
+ * Memory allocated on the thread before the budget was opened and freed while it is open is
+ * credited too, so the total is a net figure for the job, not an exact resident size.
+ *
+ * Budgets do not nest: opening one replaces the thread's previous budget until it closes.
+ */
+class JobMemory
+{
+    public:
+        /**
+         * @brief Open a budget on the current thread.
+         * @param limit Largest net number of bytes the thread may allocate (0: unlimited, only counted).
+         */
+        explicit JobMemory(std::size_t limit);
+        /**
+         * @brief Close the budget (the thread's allocations are no longer counted).
+         */
+        ~JobMemory();
+
+        JobMemory(const JobMemory&) = delete;
+        JobMemory& operator=(const JobMemory&) = delete;
+
+        /**
+         * @class Attach
+         * @brief Scoped attachment of the current thread to a budget opened on another thread.
+         *
+         * A job that starts threads attaches each of them to its budget (see JobMemory::current()),
+         * so their allocations count against the job's limit too.
+         */
+        class Attach
+        {
+            public:
+                /**
+                 * @brief Charge the current thread's allocations to a budget.
+                 * @param budget The budget, or nullptr to leave the thread uncounted.
+                 */
+                explicit Attach(JobMemory *budget);
+                /**
+                 * @brief Detach the thread and restore its previous budget.
+                 */
+                ~Attach();
+
+                Attach(const Attach&) = delete;
+                Attach& operator=(const Attach&) = delete;
+
+            private:
+                JobMemory *previous;
+        };
+
+        /**
+         * @brief Get the net bytes allocated since the budget was opened.
+         * @return The bytes in use.
+         */
+        std::size_t used() const { long long bytes = net.load(); return (bytes > 0) ? static_cast<std::size_t>(bytes) : 0; }
+        /**
+         * @brief Get the highest net allocation seen.
+         * @return The peak in bytes.
+         */
+        std::size_t peak() const { return peak_bytes.load(); }
+        /**
+         * @brief Check whether an allocation was refused.
+         * @return True if the limit was hit.
+         */
+        bool exceeded() const { return refused.load(); }
+
+        /**
+         * @brief Charge an allocation to the current thread's budget (called by operator new).
+         * @param bytes Size of the block.
+         * @return False if the block must be refused.
+         */
+        static bool charge(std::size_t bytes);
+        /**
+         * @brief Credit a freed block to the current thread's budget (called by operator delete).
+         * @param bytes Size of the block.
+         */
+        static void credit(std::size_t bytes);
+        /**
+         * @brief Check whether the current thread has a budget.
+         * @return True if allocations are being counted.
+         */
+        static bool active();
+        /**
+         * @brief Get the budget the current thread charges, to attach the threads it starts.
+         * @return The budget, or nullptr if allocations are not counted.
+         */
+        static JobMemory* current();
+
+    private:
+        std::size_t limit;
+        std::atomic<long long> net{0};
+        std::atomic<std::size_t> peak_bytes{0};
+        std::atomic<bool> refused{false};
+        JobMemory *previous;
+};
+
+#endif
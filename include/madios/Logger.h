@@ -54,6 +54,16 @@ public:
      * @param msg The message to log.
      */
     static void error(const std::string& msg);
+    /**
+     * @brief Send the calling thread's messages to a stream instead of stderr (batch jobs log apart).
+     * @param sink The stream, or nullptr to log to stderr again. It must outlive its use.
+     */
+    static void setThreadSink(std::ostream* sink);
+    /**
+     * @brief Get the calling thread's sink, to pass it on to threads it starts.
+     * @return The stream, or nullptr for stderr.
+     */
+    static std::ostream* getThreadSink();
 private:
     /**
      * @brief Internal logging implementation.
@@ -63,6 +73,7 @@ private:
     static void log(Level level, const std::string& msg);
     static Level currentLevel; ///< Current logging level.
     static std::mutex logMutex; ///< Mutex for thread safety.
+    static thread_local std::ostream* threadSink; ///< Destination of this thread's messages (nullptr: stderr).
 };
 
 } // namespace madios
@@ -0,0 +1,110 @@
+/**
+ * @file MappedStore.h
+ * @brief Declares the MappedStore class, a memory resource backed by memory-mapped files for out-of-core graphs.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef MAPPEDSTORE_H
+#define MAPPEDSTORE_H
+
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class MappedStore
+ * @brief Memory resource that places allocations in shared mappings of unlinked files on local disk.
+ *
+ * Used for the path store, the occurrence lists and the parse trees of an out-of-core RDSGraph.
+ * Because the pages are file-backed, the kernel writes them back and drops them under memory
+ * pressure instead of needing swap, so the graph can be several times larger than physical memory.
+ * Blocks are rounded up to a power of two and carved from fixed-size segments; freed blocks go to
+ * a free list per size class. Blocks larger than a quarter segment get a mapping of their own.
+ * The files are unlinked as soon as they are created, so nothing is left on disk after exit.
+ *
+ * advise() passes access hints (madvise) for a range; it ignores memory the store does not own.
+ * Allocation is thread-safe.
+ */
+class MappedStore: public std::pmr::memory_resource
+{
+    public:
+        /**
+         * @brief Expected use of a range, passed to advise().
+         */
+        enum class Access
+        {
+            WillNeed,   ///< Needed soon: start reading it in.
+            Cold        ///< Not needed soon: reclaim it before other pages.
+        };
+
+        /**
+         * @brief Create an empty store and map its first segment; later segments are mapped on demand.
+         * @param directory Directory for the backing files (on local disk).
+         * @param residentBudget Bytes of hot occurrence lists the graph should keep resident.
+         * @param segmentSize Size of each segment in bytes (rounded up to whole pages).
+         * @throws std::runtime_error if no backing file can be created in the directory.
+         */
+        explicit MappedStore(const std::string &directory, std::size_t residentBudget = std::size_t(256) << 20,
+                             std::size_t segmentSize = std::size_t(64) << 20);
+        ~MappedStore() override;
+
+        MappedStore(const MappedStore&) = delete;
+        MappedStore& operator=(const MappedStore&) = delete;
+
+        /**
+         * @brief Pass an access hint for a range of memory allocated from this store.
+         * @param data Start of the range.
+         * @param bytes Length of the range.
+         * @param access The expected use.
+         */
+        void advise(const void *data, std::size_t bytes, Access access) const;
+        /**
+         * @brief Check whether a pointer lies in memory mapped by this store.
+         * @param data The pointer.
+         * @return True if the store owns it.
+         */
+        bool owns(const void *data) const;
+        /**
+         * @brief Get the budget for hot occurrence lists.
+         * @return The budget in bytes.
+         */
+        std::size_t residentBudget() const { return resident_budget; }
+        /**
+         * @brief Get the total size of all mappings.
+         * @return The mapped bytes.
+         */
+        std::size_t mappedBytes() const;
+        /**
+         * @brief Get the bytes in blocks currently allocated (after rounding to size classes).
+         * @return The allocated bytes.
+         */
+        std::size_t allocatedBytes() const;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+        char* mapFile(std::size_t bytes);
+        static unsigned int sizeClass(std::size_t bytes, std::size_t alignment);
+
+        std::string directory;
+        std::size_t resident_budget;
+        std::size_t segment_size;
+        std::size_t page_size;
+
+        mutable std::mutex mutex;
+        std::map<const char*, std::size_t> mappings;   // every mapping (segments and large blocks), by address
+        char *segment = nullptr;                       // segment blocks are currently carved from
+        std::size_t used = 0;                          // bytes carved from it
+        std::vector<void*> free_lists;                 // head of the free list of each size class
+        std::size_t mapped = 0;
+        std::size_t allocated = 0;
+};
+
+#endif
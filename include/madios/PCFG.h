@@ -0,0 +1,159 @@
+/**
+ * @file PCFG.h
+ * @brief Declares the PCFG class, an in-memory form of the grammar written by RDSGraph::convert2PCFG.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef PCFG_H
+#define PCFG_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RDSGraph;
+
+/**
+ * @class PCFG
+ * @brief Symbol table and rule list of a learned probabilistic context-free grammar.
+ *
+ * Rules have the text form "LHS -> RHS... [probability]". Every symbol that appears on the
+ * left-hand side of a rule is a nonterminal; all other symbols are terminals. Following the
+ * naming used by convert2PCFG, nonterminals named "P<n>" are significant patterns, "E<n>" are
+ * equivalence classes and "S" is the start symbol.
+ */
+class PCFG
+{
+    public:
+        /**
+         * @brief A single production.
+         */
+        struct Rule
+        {
+            unsigned int lhs;              ///< Left-hand side symbol id.
+            std::vector<unsigned int> rhs; ///< Right-hand side symbol ids.
+            double probability;            ///< Rule probability.
+        };
+
+        /**
+         * @brief Id returned for unknown symbols.
+         */
+        static const unsigned int npos;
+        /**
+         * @brief Version written into snapshots; readSnapshot rejects any other version.
+         */
+        static const unsigned int snapshotVersion;
+
+        /**
+         * @brief Default constructor. Creates an empty grammar.
+         */
+        PCFG();
+        /**
+         * @brief Parse a grammar in the convert2PCFG text format.
+         * @param in Input stream to read rules from. Blank lines are ignored.
+         * @return The parsed grammar.
+         * @throws std::runtime_error on a malformed rule (the message carries the line number).
+         */
+        static PCFG read(std::istream &in);
+        /**
+         * @brief Write the grammar in the convert2PCFG text format (the inverse of read).
+         * @param out Output stream; rules are written in rule order with the stream's precision.
+         */
+        void write(std::ostream &out) const;
+        /**
+         * @brief Write the grammar as a binary snapshot.
+         *
+         * A snapshot starts with the 8 bytes "MADIOSG\n" and a format version, followed by the symbol
+         * table and the rules. Integers are little-endian and probabilities are stored as IEEE-754
+         * doubles, so a snapshot reads back faster than the text form and without rounding.
+         * @param out Output stream (opened in binary mode).
+         */
+        void writeSnapshot(std::ostream &out) const;
+        /**
+         * @brief Read a grammar written by writeSnapshot.
+         * @param in Input stream (opened in binary mode), positioned at the magic bytes.
+         * @return The grammar.
+         * @throws std::runtime_error if the magic bytes or version do not match, or the snapshot is truncated or inconsistent.
+         */
+        static PCFG readSnapshot(std::istream &in);
+        /**
+         * @brief Read a grammar in either form, detecting a snapshot by its magic bytes.
+         * @param in Input stream (opened in binary mode).
+         * @return The grammar.
+         * @throws std::runtime_error on malformed input.
+         */
+        static PCFG load(std::istream &in);
+        /**
+         * @brief Build the grammar that convert2PCFG describes for a learned graph.
+         * @param graph The distilled graph.
+         * @return The grammar.
+         */
+        static PCFG fromGraph(const RDSGraph &graph);
+        /**
+         * @brief Add a rule, interning its symbols.
+         * @param lhs Left-hand side symbol name.
+         * @param rhs Right-hand side symbol names (must not be empty).
+         * @param probability Rule probability.
+         */
+        void addRule(const std::string &lhs, const std::vector<std::string> &rhs, double probability);
+
+        /**
+         * @brief Look up a symbol id by name.
+         * @param name The symbol name.
+         * @return The symbol id, or npos if the symbol is unknown.
+         */
+        unsigned int symbolId(const std::string &name) const;
+        /**
+         * @brief Get the name of a symbol.
+         * @param id The symbol id.
+         * @return The symbol name.
+         */
+        const std::string& symbolName(unsigned int id) const { return names[id]; }
+        /**
+         * @brief Get the number of symbols (terminals and nonterminals).
+         * @return The number of symbols.
+         */
+        unsigned int symbolCount() const { return names.size(); }
+        /**
+         * @brief Check whether a symbol is a nonterminal (appears on some left-hand side).
+         * @param id The symbol id.
+         * @return True for nonterminals.
+         */
+        bool isNonterminal(unsigned int id) const { return !by_lhs[id].empty(); }
+        /**
+         * @brief Check whether a symbol is a significant pattern nonterminal ("P<n>").
+         * @param id The symbol id.
+         * @return True for pattern nonterminals.
+         */
+        bool isPattern(unsigned int id) const;
+        /**
+         * @brief Get the id of the start symbol "S".
+         * @return The start symbol id, or npos if the grammar has no S rules.
+         */
+        unsigned int startSymbol() const { return symbolId("S"); }
+        /**
+         * @brief Get all rules in input order.
+         * @return Const reference to the rule list.
+         */
+        const std::vector<Rule>& rules() const { return the_rules; }
+        /**
+         * @brief Get the indices of the rules with a given left-hand side.
+         * @param lhs The left-hand side symbol id.
+         * @return Const reference to the rule indices.
+         */
+        const std::vector<unsigned int>& rulesFor(unsigned int lhs) const { return by_lhs[lhs]; }
+
+    private:
+        unsigned int intern(const std::string &name);
+
+        std::vector<std::string> names;
+        std::unordered_map<std::string, unsigned int> ids;
+        std::vector<Rule> the_rules;
+        std::vector<std::vector<unsigned int> > by_lhs;
+};
+
+#endif
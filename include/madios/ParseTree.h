@@ -11,6 +11,7 @@
 #define PARSE_TREE_H
 
 #include <iostream>
+#include <memory_resource>
 #include <vector>
 
 typedef std::pair<unsigned int, unsigned int> Connection;
@@ -92,7 +93,11 @@ template <class T>
 class ParseTree
 {
     public:
-        
+        /**
+        * @brief Node storage; the graph's trees live in its MappedStore in out-of-core mode.
+        */
+        typedef std::pmr::vector<ParseNode<T> > NodeList;
+
         /**
         * @brief Default constructor. Creates a tree with a single root node.
         */
@@ -104,9 +109,12 @@ class ParseTree
         /**
         * @brief Construct a tree from a vector of values, each as a direct child of the root.
         * @param values The values to add as children of the root.
+        * @param resource Memory resource for the nodes.
         */
-        ParseTree(const std::vector<T> &values)
+        ParseTree(const std::vector<T> &values, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : the_nodes(resource)
         {
+            the_nodes.reserve(values.size() + 1);
             the_nodes.push_back(ParseNode<T>());   // nodes[0] is always the root
             for(unsigned int i = 0; i < values.size(); i++)
             {
@@ -115,11 +123,25 @@ class ParseTree
             }
         }
 
+        /**
+        * @brief Copy a tree, allocating its nodes from a given memory resource.
+        * @param other The tree to copy.
+        * @param resource Memory resource for the nodes.
+        */
+        ParseTree(const ParseTree<T> &other, std::pmr::memory_resource *resource)
+        : the_leaves(other.the_leaves), the_nodes(other.the_nodes, resource)
+        {}
+
+        ParseTree(const ParseTree<T> &other) = default;
+        ParseTree(ParseTree<T> &&other) noexcept = default;
+        ParseTree<T>& operator=(const ParseTree<T> &other) = default;
+        ParseTree<T>& operator=(ParseTree<T> &&other) = default;
+
         /**
         * @brief Get the nodes of the tree.
-        * @return Const reference to the vector of nodes.
+        * @return Const reference to the list of nodes.
         */
-        const std::vector<ParseNode<T> >& nodes() const
+        const NodeList& nodes() const
         {
             return the_nodes;
         }
@@ -138,6 +160,16 @@ class ParseTree
                 the_nodes[the_nodes.back().the_children[i]].the_parent = Connection(the_nodes.size()-1, i);
         }
 
+        /**
+        * @brief Replace the value of every non-root node with mapping[value].
+        * @param mapping Lookup table indexed by the old value.
+        */
+        void relabel(const std::vector<T> &mapping)
+        {
+            for(unsigned int i = 1; i < the_nodes.size(); i++)
+                the_nodes[i].the_value = mapping[the_nodes[i].the_value];
+        }
+
         /**
         * @brief Attach another parse tree as a branch at a given node.
         * @param attachPoint The index of the node to attach to.
@@ -177,7 +209,7 @@ class ParseTree
 
     private:
         std::vector<unsigned int> the_leaves;
-        std::vector<ParseNode<T> > the_nodes;
+        NodeList the_nodes;
 };
 
 #endif
@@ -0,0 +1,74 @@
+/**
+ * @file PathSet.h
+ * @brief Declares the PathSet class, the set of search paths a node occurs on.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef PATHSET_H
+#define PATHSET_H
+
+#include "RDSNode.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @class PathSet
+ * @brief Set of path slots, stored as a sorted id list when sparse and as a bitset when dense.
+ *
+ * RDSGraph keeps one set per node, built from the node's occurrence list. Intersecting the sets of
+ * the nodes of a segment gives the only paths the segment can occur on, so occurrence scans can
+ * skip the other paths without reading them. A set switches to the bitset once a bit per path
+ * takes less memory than an id per member (more than 1 in 32 paths), so it never takes more than
+ * min(4 * size, pathCount / 8) bytes.
+ */
+class PathSet
+{
+    public:
+        /**
+         * @brief Rebuild the set from an occurrence list.
+         * @param occurrences Occurrences (path, position) of a node.
+         * @param pathCount Number of path slots in the graph.
+         */
+        void assign(const ConnectionList &occurrences, unsigned int pathCount);
+        /**
+         * @brief Check whether a path is in the set.
+         * @param path The path slot.
+         * @return True if the path is a member.
+         */
+        bool contains(unsigned int path) const
+        {
+            if(dense)
+                return (path >> 6) < words.size() && ((words[path >> 6] >> (path & 63)) & 1u);
+            return std::binary_search(ids.begin(), ids.end(), path);
+        }
+        /**
+         * @brief Get the number of paths in the set.
+         * @return The number of members.
+         */
+        std::size_t size() const { return count; }
+        /**
+         * @brief Check whether the set is stored as a bitset.
+         * @return True for the bitset form.
+         */
+        bool isDense() const { return dense; }
+        /**
+         * @brief Intersect sets, walking the smallest and probing the others.
+         * @param sets The sets (at least one); reordered by size.
+         * @param out Receives the paths in all sets, in increasing order.
+         */
+        static void intersect(std::pmr::vector<const PathSet*> &sets, std::pmr::vector<unsigned int> &out);
+
+    private:
+        std::vector<unsigned int> ids;        // sparse form: sorted members
+        std::vector<std::uint64_t> words;     // dense form: one bit per path slot
+        std::size_t count = 0;
+        bool dense = false;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file PatternEventLog.h
+ * @brief Declares the PatternEventLog class, a JSON Lines stream of patterns learned during distillation.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef PATTERNEVENTLOG_H
+#define PATTERNEVENTLOG_H
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One distillation event: a new SP or EC, or the end of an iteration or of the run.
+ */
+struct PatternEvent
+{
+    std::string type;                 ///< "SP", "EC", "iteration" or "end".
+    unsigned int id = 0;              ///< Node id of the new unit (SP/EC events).
+    std::string name;                 ///< Unit name as used in the grammar, e.g. "P28" (SP/EC events).
+    std::vector<std::string> members; ///< Names of the unit's elements (SP/EC events).
+    double leftPValue = 0.0;          ///< Left significance of the pattern that created the unit.
+    double rightPValue = 0.0;         ///< Right significance of the pattern that created the unit.
+    unsigned int occurrences = 0;     ///< Occurrences of the unit in the search paths when created.
+    unsigned int iteration = 0;       ///< Distillation iteration (0-based).
+    unsigned int patterns = 0;        ///< Number of SPs learned so far (iteration/end events).
+    unsigned int classes = 0;         ///< Number of ECs learned so far (iteration/end events).
+};
+
+/**
+ * @class PatternEventLog
+ * @brief Buffered JSON Lines writer for PatternEvents, running on a background thread.
+ *
+ * record() only appends the event to an in-memory queue; a writer thread serializes queued events
+ * one JSON object per line and flushes after every batch, so the file can be followed while
+ * distillation runs and holds every completed event if the run is interrupted.
+ */
+class PatternEventLog
+{
+    public:
+        /**
+         * @brief Open the log file and start the writer thread.
+         * @param filename Output file (truncated).
+         * @throws std::runtime_error if the file cannot be opened.
+         */
+        explicit PatternEventLog(const std::string &filename);
+        /**
+         * @brief Write all queued events, then stop the writer thread and close the file.
+         */
+        ~PatternEventLog();
+
+        PatternEventLog(const PatternEventLog&) = delete;
+        PatternEventLog& operator=(const PatternEventLog&) = delete;
+
+        /**
+         * @brief Queue an event for writing. Thread-safe and non-blocking apart from a short lock.
+         * @param event The event.
+         */
+        void record(PatternEvent event);
+        /**
+         * @brief Block until every event recorded so far has been written and flushed.
+         */
+        void flush();
+
+    private:
+        void run();
+
+        std::ofstream out;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable drained;
+        std::vector<PatternEvent> pending;
+        unsigned long long recorded = 0;
+        unsigned long long written = 0;
+        bool closing = false;
+        std::thread writer;
+};
+
+#endif
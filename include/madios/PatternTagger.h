@@ -0,0 +1,105 @@
+/**
+ * @file PatternTagger.h
+ * @brief Declares the PatternTagger class, which marks learned significant patterns in new text.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef PATTERNTAGGER_H
+#define PATTERNTAGGER_H
+
+#include "PCFG.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class PatternTagger
+ * @brief Aho-Corasick automaton over the terminal expansions of a grammar's significant patterns.
+ *
+ * Every SP is expanded to all the terminal strings it can derive, with ECs expanded to their
+ * alternatives, and the strings are compiled into a token-level Aho-Corasick automaton.
+ * Tagging a sentence is a single left-to-right pass followed by leftmost-longest selection of
+ * non-overlapping pattern spans. A pattern whose expansion set exceeds the cap is skipped.
+ */
+class PatternTagger
+{
+    public:
+        /**
+         * @brief A tagged span of tokens.
+         */
+        struct Span
+        {
+            unsigned int start;   ///< Index of the first token.
+            unsigned int length;  ///< Number of tokens.
+            unsigned int pattern; ///< PCFG symbol id of the pattern.
+        };
+
+        /**
+         * @brief Compile the significant patterns of a grammar.
+         * @param grammar The grammar (see PCFG).
+         * @param maxExpansions Maximum number of terminal strings per symbol before a pattern is skipped.
+         */
+        explicit PatternTagger(const PCFG &grammar, unsigned int maxExpansions = 4096);
+
+        /**
+         * @brief Find the maximal (leftmost-longest, non-overlapping) pattern spans in a sentence.
+         * @param tokens The sentence tokens.
+         * @return The spans, ordered by start position.
+         */
+        std::vector<Span> tag(const std::vector<std::string> &tokens) const;
+        /**
+         * @brief Tag one line of whitespace-separated text, appending "[P<n> tokens...]" markup to out.
+         * @param line The input line.
+         * @param out String the tagged line is appended to (without a trailing newline).
+         */
+        void tagLine(const std::string &line, std::string &out) const;
+        /**
+         * @brief Get the name of a pattern symbol.
+         * @param pattern PCFG symbol id of the pattern.
+         * @return The pattern name (e.g. "P28").
+         */
+        const std::string& patternName(unsigned int pattern) const { return names[pattern]; }
+        /**
+         * @brief Get the number of patterns compiled into the automaton.
+         * @return The number of compiled patterns.
+         */
+        unsigned int patternCount() const { return compiled_patterns; }
+        /**
+         * @brief Get the number of patterns skipped because of the expansion cap.
+         * @return The number of skipped patterns.
+         */
+        unsigned int skippedCount() const { return skipped_patterns; }
+        /**
+         * @brief Get the number of automaton states.
+         * @return The number of states.
+         */
+        unsigned int stateCount() const { return depth.size(); }
+
+    private:
+        unsigned int wordId(std::string_view word) const;
+        unsigned int next(unsigned int state, unsigned int word) const;
+        std::vector<Span> match(const std::vector<unsigned int> &words) const;
+
+        std::vector<std::string> names;
+        std::vector<std::string> words;
+        std::unordered_map<std::string_view, unsigned int> word_ids;
+
+        // automaton: root transitions are dense, other states use sorted child ranges
+        std::vector<unsigned int> root_next;
+        std::vector<unsigned int> child_begin;
+        std::vector<unsigned int> child_word;
+        std::vector<unsigned int> child_state;
+        std::vector<unsigned int> fail;
+        std::vector<unsigned int> dict;
+        std::vector<unsigned int> output;
+        std::vector<unsigned int> depth;
+
+        unsigned int compiled_patterns = 0;
+        unsigned int skipped_patterns = 0;
+};
+
+#endif
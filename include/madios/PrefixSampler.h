@@ -0,0 +1,101 @@
+/**
+ * @file PrefixSampler.h
+ * @brief Declares the PrefixSampler class, which samples completions of a token prefix from a frozen grammar.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef PREFIXSAMPLER_H
+#define PREFIXSAMPLER_H
+
+#include "FrozenGrammar.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @class PrefixSampler
+ * @brief Exact sampler for sentences that start with a given prefix, for autocomplete-style use.
+ *
+ * The constructor precomputes, for every nonterminal of the (acyclic) SP/EC grammar, the set of
+ * words its yield can start with (first-terminal table) and the set of words it can produce at all
+ * (reachability table), as bit rows over the vocabulary. For a prefix w1..wn, complete() computes
+ * the probability that each unit derives a string starting with a suffix of the prefix (the prefix
+ * probability), expanding only units whose tables are consistent with the remaining words. It then
+ * draws completions top-down in proportion to those probabilities: the units that cover the prefix
+ * are chosen by the tables, and everything after the prefix is sampled freely with the grammar's
+ * alias tables. The tables are built once per call and shared by all completions of that call, so
+ * asking for many completions at once is cheap.
+ *
+ * Completions follow the conditional distribution P(sentence | sentence starts with the prefix)
+ * of the grammar. All methods are const and keep their state on the stack, so one sampler can be
+ * shared between threads (each with its own random engine).
+ */
+class PrefixSampler
+{
+    public:
+        /**
+         * @brief Precompute the first-terminal and reachability tables of a grammar.
+         * @param grammar The grammar. It must not be recursive.
+         * @throws std::invalid_argument if grammar is null.
+         * @throws std::runtime_error if the grammar is recursive.
+         */
+        explicit PrefixSampler(std::shared_ptr<const FrozenGrammar> grammar);
+
+        /**
+         * @brief Compute the probability that a sampled sentence starts with the prefix.
+         * @param prefix The prefix tokens (may be empty).
+         * @return The prefix probability (0 for unknown words or impossible prefixes).
+         */
+        double prefixProbability(const std::vector<std::string> &prefix) const;
+        /**
+         * @brief Sample completions of a prefix.
+         * @param prefix The prefix tokens (may be empty).
+         * @param count Number of completions to draw.
+         * @param rng Random engine (not shared between threads).
+         * @param maxLength Maximum number of tokens in a completed sentence.
+         * @return The tokens that follow the prefix, one list per completion (a list is empty when the
+         *         prefix itself is the whole sentence). No completions if the prefix is impossible.
+         */
+        std::vector<std::vector<std::string> > complete(const std::vector<std::string> &prefix, unsigned int count, std::mt19937 &rng, unsigned int maxLength = 10000) const;
+
+        /**
+         * @brief Check whether the yield of a symbol can start with a word (first-terminal table).
+         * @param symbol The symbol id.
+         * @param word The word's symbol id.
+         * @return True if some derivation of symbol starts with word.
+         */
+        bool canStartWith(unsigned int symbol, unsigned int word) const;
+        /**
+         * @brief Check whether a symbol can produce a word anywhere in its yield (reachability table).
+         * @param symbol The symbol id.
+         * @param word The word's symbol id.
+         * @return True if some derivation of symbol contains word.
+         */
+        bool canReach(unsigned int symbol, unsigned int word) const;
+        /**
+         * @brief Get the grammar.
+         * @return The grammar.
+         */
+        const FrozenGrammar& grammar() const { return *the_grammar; }
+
+    private:
+        class Chart;
+
+        bool testBit(const std::vector<std::uint64_t> &table, unsigned int symbol, unsigned int word) const;
+
+        std::shared_ptr<const FrozenGrammar> the_grammar;
+        // dense indices: row of each nonterminal and column of each terminal (PCFG::npos otherwise)
+        std::vector<unsigned int> row_of;
+        std::vector<unsigned int> column_of;
+        unsigned int words_per_row = 0;
+        // bit rows over the terminal columns, one row per nonterminal
+        std::vector<std::uint64_t> first_table;
+        std::vector<std::uint64_t> reach_table;
+};
+
+#endif
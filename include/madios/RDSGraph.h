@@ -11,10 +11,24 @@
 #include "maths/special.h"
 #include "MiscUtils.h"
 #include "ParseTree.h"
-#include "madios/maths/tnt/array2d.h"
+#include "DistillWorkspace.h"
+#include "MappedStore.h"
+#include "PathSet.h"
+#include "PCFG.h"
+#include "ScratchArena.h"
+#include "SearchMemo.h"
 
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+
+class FrozenGrammar;
+class PatternEventLog;
+struct GraphEpoch;
 
 /**
  * @brief Check if both p-values in a SignificancePair are less than alpha.
@@ -32,6 +46,34 @@ bool isPatternSignificant(const SignificancePair &pvalues, double alpha);
  */
 bool operator<(const SignificancePair &a, const SignificancePair &b);
 
+/**
+ * @brief One context size of a distill() run (see ADIOSParams::contextSchedule).
+ */
+struct ContextStage
+{
+    unsigned int contextSize = 0;     ///< Context size of the stage.
+    unsigned int iterations = 0;      ///< Iterations until no new pattern was found, including the last.
+    double seconds = 0.0;             ///< Wall time of the stage.
+};
+
+/**
+ * @brief Metrics of one stage of RDSGraph::distillProgressive().
+ */
+struct ProgressiveStage
+{
+    unsigned int number = 0;          ///< Stage number, from 1.
+    bool final = false;               ///< True for the stage on the whole corpus.
+    bool distilled = true;            ///< False if the budget was spent and the final stage only reduced the corpus.
+    std::size_t sentences = 0;        ///< Sentences in the stage's sample.
+    unsigned int seededUnits = 0;     ///< Units carried over from the previous stage's grammar (see warmStart()).
+    unsigned int patterns = 0;        ///< SPs after the stage.
+    unsigned int classes = 0;         ///< ECs after the stage.
+    unsigned int heldOutTested = 0;   ///< Sentences outside the sample scored with the stage's grammar.
+    unsigned int heldOutParsed = 0;   ///< How many of them the grammar derives.
+    double seconds = 0.0;             ///< Wall time of the stage.
+    double elapsed = 0.0;             ///< Wall time since the first stage began.
+};
+
 /**
  * @class RDSGraph
  * @brief Implements the main graph structure for pattern discovery in the ADIOS algorithm.
@@ -52,6 +94,21 @@ class RDSGraph: public Stringable
          * @param sequences A vector of input sequences (each sequence is a vector of strings).
          */
         explicit RDSGraph(const std::vector<std::vector<std::string> > &sequences);
+        /**
+         * @brief Constructs an out-of-core RDSGraph: paths, occurrence lists and parse trees are
+         * allocated from a MappedStore, and distill() passes page hints along its scan order.
+         * @param sequences A vector of input sequences (each sequence is a vector of strings).
+         * @param store The backing store (shared with clones of this graph), or null for an in-memory graph.
+         */
+        RDSGraph(const std::vector<std::vector<std::string> > &sequences, std::shared_ptr<MappedStore> store);
+        /**
+         * @brief Constructs an out-of-core RDSGraph from a corpus stream, read one sequence at a time
+         * (see readSequence), so that the corpus is never held in memory.
+         * @param corpus The corpus stream.
+         * @param store The backing store (shared with clones of this graph), or null for an in-memory graph.
+         * @throws std::invalid_argument if the stream holds no sequence.
+         */
+        RDSGraph(std::istream &corpus, std::shared_ptr<MappedStore> store);
 
         // Copying is not allowed for RDSGraph due to unique_ptr members
         RDSGraph(const RDSGraph& other) = delete;
@@ -74,17 +131,109 @@ class RDSGraph: public Stringable
          * @return A vector of strings representing the generated sequence.
          */
         std::vector<std::string> generate(unsigned int node) const;
+        /**
+         * @brief Seed the graph with the SPs and ECs of an earlier grammar, before distillation.
+         *
+         * Every unit of the grammar that can be built from this corpus's words becomes a node, in
+         * dependency order: an SP needs all of its elements, an EC keeps the members that exist. The
+         * paths are then reduced with the SPs, innermost first, as if the SPs had been learned on this
+         * corpus, and distill() continues from that state.
+         * @param grammar A grammar in the convert2PCFG form (text or snapshot); its S rules are ignored.
+         * @return The number of SP and EC nodes created.
+         * @throws std::logic_error if the graph already has SPs or ECs.
+         * @throws std::runtime_error if the grammar is recursive.
+         */
+        unsigned int warmStart(const PCFG &grammar);
         /**
          * @brief Main distillation loop: iteratively finds and generalizes patterns until convergence.
+         *
+         * With a context schedule, the loop converges at each scheduled context size in turn and then
+         * at contextSize, each stage starting from the graph the previous one left; the iterations and
+         * time of each stage are kept (see getContextStages()).
          * @param params ADIOS algorithm parameters (eta, alpha, contextSize, overlapThreshold)
+         * @throws std::invalid_argument if the context schedule is not strictly increasing and below contextSize.
          */
         void distill(const ADIOSParams &params);
+        /**
+         * @brief Group the paths into components that cannot influence each other's patterns.
+         *
+         * Two paths are in the same component if they share a node, directly or through the
+         * members of an SP or EC; the * and # markers, which every path has, do not link paths.
+         * @return Indices into getPaths() of each component's paths in corpus order, components
+         * ordered by their first path.
+         */
+        std::vector<std::vector<unsigned int> > partition() const;
+        /**
+         * @brief Distill every component of partition() on its own, in parallel, and join the results.
+         *
+         * Each component becomes a graph of its own paths and nodes, distilled to convergence on one
+         * of the worker threads; the learned units are then appended to this graph component by
+         * component and the paths and parse trees replaced, so the result does not depend on the
+         * number of threads. Flows are normalised by the size of the whole corpus, as in distill(),
+         * but the result can still differ from distill() on the whole corpus: there the other
+         * components shrink as they are rewired, and the * and # occurrences of every path count.
+         * @param params ADIOS algorithm parameters
+         * @param threads Number of worker threads (at least 1)
+         * @return The number of components.
+         * @throws std::logic_error if an event log is attached (events carry per-component node ids).
+         * @throws std::invalid_argument if the context schedule is not strictly increasing and below contextSize.
+         */
+        unsigned int distillPartitioned(const ADIOSParams &params, unsigned int threads);
+        /**
+         * @brief Distill growing random samples of the corpus, each stage continuing from the last.
+         *
+         * The first stage distills initialSample sentences drawn at random. Each later stage draws
+         * twice as many sentences; the sample keeps the earlier sentences and adds new ones. The stage
+         * distills its sample after a warmStart() from the previous stage's grammar. The last stage
+         * does the same on this graph, i.e. the whole corpus. If budgetSeconds runs out between stages,
+         * the last stage only reduces the corpus with the units learned so far, without distilling.
+         * Stages are never interrupted, so the budget can be exceeded by up to one stage.
+         * After each stage, up to 200 sentences that the next stage would add are scored
+         * with the stage's grammar, as a measure of how well it generalizes.
+         * @param params ADIOS algorithm parameters
+         * @param initialSample Sentences in the first sample (at least 1)
+         * @param budgetSeconds Wall time after which no further sample is distilled (0: no limit)
+         * @param seed Seed of the sample order
+         * @param onStage Called after each stage with its metrics and its graph (this graph for the last stage)
+         * @return The number of stages.
+         * @throws std::logic_error if the graph already has SPs or ECs.
+         */
+        unsigned int distillProgressive(const ADIOSParams &params, std::size_t initialSample, double budgetSeconds, unsigned int seed,
+                                        const std::function<void(const ProgressiveStage &, const RDSGraph &)> &onStage = nullptr);
         /**
          * @brief Output the learned PCFG rules in a standard format.
          * Probabilities are normalized over all rules with the same LHS.
          * @param out Output stream to write PCFG rules.
          */
         void convert2PCFG(std::ostream &out) const;
+        /**
+         * @brief Get the learned grammar as a PCFG: the rules convert2PCFG writes, with unrounded probabilities.
+         * @return The grammar.
+         */
+        PCFG toPCFG() const;
+        /**
+         * @brief Freeze the current grammar into an immutable, compact object (see FrozenGrammar).
+         * Probabilities are estimated from the current parse trees; the graph itself is not modified,
+         * and the result does not refer back to it, so it can be shared by any number of threads.
+         * @return The frozen grammar.
+         */
+        std::shared_ptr<const FrozenGrammar> freeze() const;
+        /**
+         * @brief Get the latest published snapshot of the graph (see GraphEpoch).
+         *
+         * This is the one method that may be called from other threads while distill() runs: it
+         * only loads a pointer, and the epoch it returns stays valid and unchanged for as long as
+         * the caller holds it.
+         * @return The latest epoch, or null if none has been published.
+         */
+        std::shared_ptr<const GraphEpoch> snapshot() const;
+        /**
+         * @brief Publish the current nodes, paths and grammar as a new epoch.
+         * distill() calls this every ADIOSParams::publishInterval iterations and when it ends; call
+         * it from the thread that owns the graph, e.g. to show the state before distillation.
+         * @param final True if distillation has ended.
+         */
+        void publish(bool final = false);
         /**
          * @brief Returns a string representation of the RDSGraph (for debugging).
          * @return A string describing the graph structure.
@@ -117,6 +266,11 @@ class RDSGraph: public Stringable
          * @param q True to suppress output, false for verbose.
          */
         void setQuiet(bool q) { quiet = q; }
+        /**
+         * @brief Stream SP/EC creation and iteration events to a log while distilling.
+         * @param log The event log, or nullptr to stop logging. Clones do not inherit it.
+         */
+        void setEventLog(std::shared_ptr<PatternEventLog> log) { event_log = std::move(log); }
         /**
          * @brief Check if the graph is in quiet mode.
          * @return True if quiet, false otherwise.
@@ -132,11 +286,67 @@ class RDSGraph: public Stringable
          * @return The number of rewiring operations.
          */
         unsigned int getRewiringCount() const;
+        /**
+         * @brief Get the number of pattern searches checked against double precision (validate mode).
+         * @return The number of checked searches.
+         */
+        unsigned int getPrecisionChecks() const { return precision_checks; }
+        /**
+         * @brief Get the number of checked searches where single precision chose a different pattern.
+         * @return The number of mismatching decisions.
+         */
+        unsigned int getPrecisionMismatches() const { return precision_mismatches; }
+        /**
+         * @brief Get the number of significant-pattern searches run on a connection matrix.
+         * @return The number of searches run.
+         */
+        unsigned int getPatternSearches() const { return pattern_searches; }
+        /**
+         * @brief Get the number of pattern searches answered by the search memo instead of being run.
+         * @return The number of recalled searches.
+         */
+        unsigned int getRecalledSearches() const { return recalled_searches; }
+        /**
+         * @brief Get the number of pattern searches that used an approximated significance tail (see ADIOSParams::approximateAbove).
+         * @return The number of approximated searches.
+         */
+        unsigned int getApproximatedSearches() const { return approximated_searches; }
+        /**
+         * @brief Get the number of approximated searches whose decisions could differ from exact mode,
+         * because an approximated p-value lay within its error bound of alpha or another pattern's
+         * p-values lay within the error bounds of the best one's. Memo hits count as the search they recall.
+         * @return The number of uncertain searches.
+         */
+        unsigned int getUncertainSearches() const { return uncertain_searches; }
+        /**
+         * @brief Get the context sizes of the last distill() run, with their iterations and times.
+         *
+         * After distillPartitioned(), iterations are the most any component needed and seconds the
+         * wall time of the stage across all components.
+         * @return One entry per context size, in the order they ran.
+         */
+        const std::vector<ContextStage>& getContextStages() const { return context_stages; }
         /**
          * @brief Create a deep copy of this RDSGraph (for safe simulation/experimentation).
          * @return A unique_ptr to a new RDSGraph that is a deep copy of this one.
          */
         std::unique_ptr<RDSGraph> clone() const;
+        /**
+         * @brief Renumber nodes by frequency and regroup paths around shared frequent anchors.
+         *
+         * Only the storage layout changes: paths are still visited in corpus order, ties are still
+         * broken by discovery order, and node names keep their original ids through an id map.
+         */
+        void relayout();
+        /**
+         * @brief Undo relayout(), restoring discovery-order node ids and corpus-order paths.
+         */
+        void restoreLayout();
+        /**
+         * @brief Check whether the storage layout currently differs from the canonical one.
+         * @return True between relayout() and restoreLayout().
+         */
+        bool isRelaidOut() const { return !node_labels.empty(); }
 
 #ifdef MADIOS_TESTING
     public:
@@ -147,15 +357,25 @@ class RDSGraph: public Stringable
          * @return True if generalisation succeeded, false otherwise.
          */
         bool testGeneralise(const SearchPath &search_path, const ADIOSParams &params) {
+            search_memo.clear();
             return generalise(search_path, params);
         }
 #endif
 
     private:
+        /**
+         * @brief Backing store in out-of-core mode, else null (declared before the containers that allocate from it).
+         */
+        std::shared_ptr<MappedStore> store;
         /**
          * @brief The number of input sequences in the corpus.
          */
         unsigned int corpusSize;
+        /**
+         * @brief Tokens of the rest of the corpus, included in corpusSize when this graph is one
+         * component of a partitioned run, so that flows are normalised as in the whole graph.
+         */
+        unsigned int external_corpus_size = 0;
         /**
          * @brief The nodes in the graph.
          */
@@ -184,39 +404,159 @@ class RDSGraph: public Stringable
          * @brief Number of rewiring operations performed.
          */
         unsigned int rewiring_ops = 0;
+        /**
+         * @brief Original (discovery-order) id of each node; empty while the layout is canonical.
+         */
+        std::vector<unsigned int> node_labels;
+        /**
+         * @brief Node index of each original id; inverse of node_labels.
+         */
+        std::vector<unsigned int> node_order;
+        /**
+         * @brief Storage slot of each path in corpus order; empty while the layout is canonical.
+         */
+        std::vector<unsigned int> path_order;
+        /**
+         * @brief Corpus index of each path slot; inverse of path_order.
+         */
+        std::vector<unsigned int> path_ranks;
+        /**
+         * @brief Optional stream of distillation events.
+         */
+        std::shared_ptr<PatternEventLog> event_log;
+        /**
+         * @brief Latest published epoch (accessed with std::atomic_load/atomic_store) and the number of epochs.
+         */
+        std::shared_ptr<const GraphEpoch> published;
+        unsigned int epochs = 0;
+        /**
+         * @brief Iteration of the running distill() loop (0-based).
+         */
+        unsigned int current_iteration = 0;
+        /**
+         * @brief Iterations completed by the running or last distill() loop.
+         */
+        unsigned int completed_iterations = 0;
+        /**
+         * @brief Context sizes run by the last distill() (see ADIOSParams::contextSchedule).
+         */
+        std::vector<ContextStage> context_stages;
+        /**
+         * @brief Pattern searches validated against double precision, and how many disagreed.
+         */
+        unsigned int precision_checks = 0;
+        /**
+         * @brief Pattern searches run, and answered by the search memo.
+         */
+        unsigned int pattern_searches = 0;
+        unsigned int recalled_searches = 0;
+        unsigned int precision_mismatches = 0;
+        /**
+         * @brief Significance approximation policy of the running search (from its params), the
+         * largest error bound of its approximated tails, and the searches (memo hits included) that
+         * used an approximated tail or could have decided differently in exact mode.
+         */
+        unsigned int approximate_above = 0;
+        double approximation_error = 0.0;
+        double decision_alpha = 0.0;
+        mutable bool search_approximated = false;
+        mutable bool search_uncertain = false;
+        mutable double search_error = 0.0;
+        unsigned int approximated_searches = 0;
+        unsigned int uncertain_searches = 0;
+        /**
+         * @brief Arena for the temporaries of the search path being distilled; reset after each path.
+         */
+        ScratchArena scratch;
+        /**
+         * @brief Outcomes of earlier pattern searches, keyed by path content; cleared when a distill() run starts.
+         */
+        SearchMemo search_memo;
+        /**
+         * @brief Version of each node's occurrence set, bumped by updateAllConnections when it changes.
+         */
+        std::vector<unsigned int> node_versions;
+        /**
+         * @brief Paths each node occurs on, rebuilt by updateAllConnections when its occurrence set changes.
+         */
+        std::vector<PathSet> node_paths;
+        /**
+         * @brief Nodes whose occurrence lists are kept resident in out-of-core mode (see selectResidentNodes).
+         */
+        std::vector<char> resident_nodes;
+
+        // Layout id maps (identity while the layout is canonical)
+        unsigned int nodeLabel(unsigned int node) const { return node_labels.empty() ? node : node_labels[node]; }
+        unsigned int nodeAt(unsigned int label) const { return node_order.empty() ? label : node_order[label]; }
+        unsigned int pathAt(unsigned int corpus_index) const { return path_order.empty() ? corpus_index : path_order[corpus_index]; }
+        unsigned int pathRank(unsigned int slot) const { return path_ranks.empty() ? slot : path_ranks[slot]; }
+        unsigned int appendNode(std::unique_ptr<LexiconUnit> lexicon, LexiconTypes::LexiconEnum type);
+        std::unique_ptr<LexiconUnit> copyLexicon(unsigned int node, const std::vector<unsigned int> &mapping) const;
+        std::unique_ptr<RDSGraph> extractComponent(const std::vector<unsigned int> &component, std::vector<unsigned int> &global_of) const;
+        void joinComponent(const RDSGraph &part, const std::vector<unsigned int> &component, std::vector<unsigned int> &global_of);
+        std::pmr::memory_resource* storage() const;
+
+        // Out-of-core page hints (no-ops without a store)
+        void selectResidentNodes();
+        void adviseScan(unsigned int k);
+        void applyLayout(const std::vector<unsigned int> &new_index, const std::vector<unsigned int> &new_path_order);
+
+        // Event log helpers (no-ops without an event log)
+        void logUnitEvent(unsigned int node, const SignificancePair &pvalues, unsigned int occurrences) const;
+        void logProgressEvent(const std::string &type) const;
 
         // Internal graph construction and pattern discovery methods
         void buildInitialGraph(const std::vector<std::vector<std::string> > &sequences);
+        void addInitialPath(const std::vector<std::string> &sequence, std::unordered_map<std::string, unsigned int> &lexicon);
+        unsigned int instantiateUnit(const PCFG &grammar, unsigned int symbol, std::vector<unsigned int> &node_of, std::vector<unsigned char> &state);
+        unsigned int reducePaths(const std::vector<unsigned int> &patterns);
         bool distill(const SearchPath &search_path, const ADIOSParams &params);
         bool generalise(const SearchPath &search_path, const ADIOSParams &params);
 
         // Pattern generalization and bootstrapping
-        EquivalenceClass computeEquivalenceClass(const SearchPath &search_path, unsigned int slotIndex) const;
-        SearchPath bootstrap(std::vector<EquivalenceClass> &encountered_ecs, const SearchPath &search_path, double overlapThreshold) const;
+        EquivalenceClass computeEquivalenceClass(PathView search_path, unsigned int slotIndex, std::pmr::memory_resource *resource) const;
+        SearchPath bootstrap(std::pmr::vector<EquivalenceClass> &encountered_ecs, PathView search_path, double overlapThreshold) const;
 
         // Matrix computation and pattern search
         void computeConnectionMatrix(ConnectionMatrix &connections, const SearchPath &search_path) const;
-        void computeDescentsMatrix(TNT::Array2D<double> &flows, TNT::Array2D<double> &descents, const ConnectionMatrix &connections) const;
-        bool findSignificantPatterns(std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents, double eta, double alpha) const;
+        bool searchSignificantPatterns(std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const ADIOSParams &params);
+        bool searchSignificantPatternsIn(std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const ADIOSParams &params);
+        bool recallSearch(PathView search_path, std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues);
+        void rememberSearch(PathView search_path, const std::vector<Range> &patterns, const std::vector<SignificancePair> &pvalues);
+        template <typename Real>
+        void computeDescentsMatrix(ScratchMatrix<Real> &flows, ScratchMatrix<Real> &descents, const ConnectionMatrix &connections) const;
+        template <typename Real>
+        bool findSignificantPatterns(std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const ScratchMatrix<Real> &descents, double eta, double alpha) const;
 
         // Rewiring and update functions
         void updateAllConnections();
+        std::vector<Connection> pathNodes(const std::vector<unsigned int> &path_ids) const;
+        void updateConnections(std::vector<Connection> touched);
+        void updateParents();
         void rewire(const std::vector<Connection> &connections, unsigned int ec);
         void rewire(const std::vector<Connection> &connections, const EquivalenceClass &ec);
         void rewire(const std::vector<Connection> &connections, const SignificantPattern &sp);
         std::vector<Connection> getRewirableConnections(const ConnectionMatrix &connections, const Range &bestSP, double alpha) const;
-        double computeRightSignificance(const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const std::pair<unsigned int, unsigned int> &descentPoint, double eta) const;
-        double computeLeftSignificance(const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const std::pair<unsigned int, unsigned int> &descentPoint, double eta) const;
-        double findBestRightDescentColumn(unsigned int &bestColumn, TNT::Array2D<double> &pvalueCache, const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents, const Range &pattern, double eta) const;
-        double findBestLeftDescentColumn(unsigned int &bestColumn, TNT::Array2D<double> &pvalueCache, const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents, const Range &pattern, double eta) const;
+        template <typename Real>
+        double computeRightSignificance(const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const std::pair<unsigned int, unsigned int> &descentPoint, double eta) const;
+        double significanceTail(unsigned int descentOccurences, unsigned int patternOccurences, double p) const;
+        template <typename Real>
+        double computeLeftSignificance(const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const std::pair<unsigned int, unsigned int> &descentPoint, double eta) const;
+        template <typename Real>
+        double findBestRightDescentColumn(unsigned int &bestColumn, ScratchMatrix<double> &pvalueCache, const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const ScratchMatrix<Real> &descents, const Range &pattern, double eta) const;
+        template <typename Real>
+        double findBestLeftDescentColumn(unsigned int &bestColumn, ScratchMatrix<double> &pvalueCache, const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const ScratchMatrix<Real> &descents, const Range &pattern, double eta) const;
 
         // Auxiliary functions
-        std::vector<Connection> filterConnections(const std::vector<Connection> &init_cons, unsigned int start_offset, const SearchPath &search_path) const;
-        std::vector<Connection> getAllNodeConnections(unsigned int nodeIndex) const;
+        ConnectionList filterConnections(const ConnectionList &init_cons, unsigned int start_offset, PathView search_path) const;
+        bool candidatePaths(PathView segment, std::size_t occurrences, std::pmr::vector<unsigned int> &candidates) const;
+        ConnectionList getAllNodeConnections(unsigned int nodeIndex, std::pmr::memory_resource *resource) const;
         unsigned int findExistingEquivalenceClass(const EquivalenceClass &ec) const;
 
         // Counts the occurrences of each lexicon unit
         void estimateProbabilities();
+        std::vector<std::vector<unsigned int> > computeCounts() const;
+        PCFG buildPCFG(const std::vector<std::vector<unsigned int> > &node_counts) const;
 
         // Print functions
         std::string printSignificantPattern(const SignificantPattern &sp) const;
@@ -232,6 +572,6 @@ class RDSGraph: public Stringable
  * @param flows The flow matrix.
  * @param descents The descent matrix.
  */
-void printInfo(const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents);
+void printInfo(const ConnectionMatrix &connections, const ScratchMatrix<double> &flows, const ScratchMatrix<double> &descents);
 
 #endif
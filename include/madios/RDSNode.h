@@ -13,6 +13,9 @@
 #include "LexiconUnit.h"
 #include "ADIOSUtils.h"
 #include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
 
 /**
  * @typedef Connection
@@ -20,10 +23,58 @@
  */
 typedef std::pair<unsigned int, unsigned int> Connection;
 /**
- * @typedef ConnectionMatrix
- * @brief Matrix of connections for the ADIOS graph.
+ * @typedef ConnectionList
+ * @brief Occurrences (path, position) of a node or segment, allocated from a memory resource.
  */
-typedef TNT::Array2D<std::vector<Connection> > ConnectionMatrix;
+typedef std::pmr::vector<Connection> ConnectionList;
+/**
+ * @class ConnectionMatrix
+ * @brief Symmetric matrix of connection lists for one search path.
+ *
+ * Cell (i, j) and cell (j, i) are the same list, so only the lower triangle is stored. All lists
+ * are allocated from the matrix's memory resource (normally the per-path scratch arena), so
+ * assigning a list returned by filterConnections into a cell moves it without copying.
+ */
+class ConnectionMatrix
+{
+    public:
+        /**
+         * @brief Create an empty matrix.
+         * @param resource Memory resource for the cells and their lists.
+         */
+        explicit ConnectionMatrix(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : cells(resource) {}
+        /**
+         * @brief Clear the matrix and resize it to dim x dim empty lists.
+         * @param dim The number of rows and columns.
+         */
+        void reset(unsigned int dim)
+        {
+            cells.clear();
+            cells.resize(static_cast<std::size_t>(dim) * (dim + 1) / 2);
+            size = dim;
+        }
+        ConnectionList& operator()(unsigned int i, unsigned int j) { return cells[index(i, j)]; }
+        const ConnectionList& operator()(unsigned int i, unsigned int j) const { return cells[index(i, j)]; }
+        int dim1() const { return size; }
+        int dim2() const { return size; }
+        /**
+         * @brief Get the memory resource the lists are allocated from.
+         * @return The memory resource.
+         */
+        std::pmr::memory_resource* resource() const { return cells.get_allocator().resource(); }
+
+    private:
+        static std::size_t index(unsigned int i, unsigned int j)
+        {
+            if(i < j)
+                std::swap(i, j);
+            return static_cast<std::size_t>(i) * (i + 1) / 2 + j;
+        }
+
+        std::pmr::vector<ConnectionList> cells;
+        unsigned int size = 0;
+};
 /**
  * @typedef SignificancePair
  * @brief Pair of significance values (left, right).
@@ -53,13 +104,13 @@ class RDSNode
          */
         LexiconTypes::LexiconEnum type;
         /**
-         * @brief Outgoing connections from this node.
+         * @brief Occurrences (path, position) of this node, in corpus order.
          */
-        std::vector<Connection> connections;
+        ConnectionList connections;
         /**
          * @brief Parent connections to this node.
          */
-        std::vector<Connection> parents;
+        ConnectionList parents;
 
         /**
          * @brief Default constructor.
@@ -69,13 +120,26 @@ class RDSNode
          * @brief Construct from a lexicon unit and type.
          * @param lexicon Unique pointer to a lexicon unit.
          * @param type The type of the lexicon unit.
+         * @param resource Memory resource for the connection and parent lists.
          */
-        explicit RDSNode(std::unique_ptr<LexiconUnit> lexicon, LexiconTypes::LexiconEnum type);
+        explicit RDSNode(std::unique_ptr<LexiconUnit> lexicon, LexiconTypes::LexiconEnum type,
+                         std::pmr::memory_resource *resource = std::pmr::get_default_resource());
         /**
-         * @brief Copy constructor.
+         * @brief Copy constructor (the copy's lists use the default memory resource).
          * @param other The node to copy.
          */
         RDSNode(const RDSNode &other);
+        /**
+         * @brief Copy a node, allocating its lists from a given memory resource.
+         * @param other The node to copy.
+         * @param resource Memory resource for the connection and parent lists.
+         */
+        RDSNode(const RDSNode &other, std::pmr::memory_resource *resource);
+        /**
+         * @brief Move constructor (takes over the lexicon and connection buffers).
+         * @param other The node to move from.
+         */
+        RDSNode(RDSNode &&other) noexcept = default;
         /**
          * @brief Destructor.
          */
@@ -86,16 +150,22 @@ class RDSNode
          * @return Reference to this node.
          */
         RDSNode& operator=(const RDSNode &other);
+        /**
+         * @brief Move assignment operator (the lists keep this node's memory resource).
+         * @param other The node to move from.
+         * @return Reference to this node.
+         */
+        RDSNode& operator=(RDSNode &&other) noexcept = default;
         /**
          * @brief Add a connection to this node.
          * @param con The connection to add.
          */
         void addConnection(const Connection &con);
         /**
-         * @brief Get all outgoing connections.
-         * @return Const reference to the vector of connections.
+         * @brief Get all occurrences.
+         * @return Const reference to the list of connections.
          */
-        const std::vector<Connection>& getConnections() const;
+        const ConnectionList& getConnections() const;
         /**
          * @brief Set the outgoing connections.
          * @param connections The new connections vector.
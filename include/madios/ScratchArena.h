@@ -0,0 +1,92 @@
+/**
+ * @file ScratchArena.h
+ * @brief Declares the ScratchArena class, a resettable monotonic memory resource for per-path temporaries.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @class ScratchArena
+ * @brief Monotonic arena for the temporaries of one search path, reset after the path is done.
+ *
+ * Allocation bumps a pointer in a std::pmr::monotonic_buffer_resource and deallocation is a no-op.
+ * reset() frees everything at once. Memory the arena had to request from the heap since the last
+ * reset is folded into its reserved block, so once the reserve covers the largest path seen, the
+ * distillation loop stops calling the heap allocator for these temporaries.
+ */
+class ScratchArena: public std::pmr::memory_resource
+{
+    public:
+        /**
+         * @brief Create an empty arena; the reserve grows on demand.
+         * @param maxReserve Upper bound for the reserved block in bytes.
+         */
+        explicit ScratchArena(std::size_t maxReserve = std::size_t(256) << 20);
+
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+
+        /**
+         * @brief Free everything allocated since the last reset and grow the reserve to the high-water mark.
+         * Every container allocated from the arena must already be destroyed.
+         */
+        void reset();
+        /**
+         * @brief Get the size of the reserved block.
+         * @return The reserve in bytes.
+         */
+        std::size_t reserved() const { return reserve_size; }
+        /**
+         * @brief Get the number of heap allocations the arena made since the last reset.
+         * @return The number of allocations beyond the reserve.
+         */
+        std::size_t overflowCount() const { return overflow.count; }
+
+        /**
+         * @brief Resets an arena when it goes out of scope (declare it before the containers it serves).
+         */
+        class Scope
+        {
+            public:
+                explicit Scope(ScratchArena &arena): arena(arena) {}
+                ~Scope() { arena.reset(); }
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+            private:
+                ScratchArena &arena;
+        };
+
+    private:
+        // Heap fallback that records how much the arena needed beyond its reserve
+        class OverflowResource: public std::pmr::memory_resource
+        {
+            public:
+                std::size_t bytes = 0;
+                std::size_t count = 0;
+            private:
+                void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+                void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+                bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+        };
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override { return arena->allocate(bytes, alignment); }
+        void do_deallocate(void *, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+        std::size_t max_reserve;
+        std::size_t reserve_size = 0;
+        std::unique_ptr<std::byte[]> reserve;
+        OverflowResource overflow;
+        std::optional<std::pmr::monotonic_buffer_resource> arena;
+};
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file SearchMemo.h
+ * @brief Declares the SearchMemo class, a memo table of significant-pattern searches keyed by path content.
+ *
+ * Part of the ADIOS grammar induction project. See README for usage and structure.
+ */
+#pragma once
+
+#ifndef SEARCHMEMO_H
+#define SEARCHMEMO_H
+
+#include "RDSNode.h"
+#include "SearchPath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class SearchMemo
+ * @brief Remembers the significant patterns found on a node sequence, valid while the nodes it read are unchanged.
+ *
+ * The connection matrix of a search path, and so the outcome of the pattern search on it, depends
+ * only on the occurrence sets of the nodes it reads (the path's nodes and the members of its ECs)
+ * and on the corpus size. An entry stores the outcome together with the version of each of those
+ * nodes and the corpus size at the time of the search; a lookup succeeds only if all of them still
+ * match. Versions are kept by the caller, which bumps a node's version whenever its occurrence set
+ * changes. Identical paths, which are common after rewiring, then share one search.
+ *
+ * Entries are heap copies, so a capacity can bound their size: a store that would exceed it first
+ * clears the memo, whose old entries are the ones most likely to be stale.
+ */
+class SearchMemo
+{
+    public:
+        /**
+         * @brief Outcome of a pattern search.
+         */
+        struct Outcome
+        {
+            std::vector<Range> patterns;             ///< Significant patterns, best first.
+            std::vector<SignificancePair> pvalues;   ///< Their (left, right) p-values.
+            bool approximated = false;               ///< The search used an approximated tail.
+            bool uncertain = false;                  ///< Its decision could differ from exact mode.
+        };
+
+        /**
+         * @brief Look up a path.
+         * @param path The node sequence.
+         * @param versions Current version of every node.
+         * @param corpusSize Current corpus size.
+         * @return The stored outcome (valid until the next store or clear), or nullptr if there is none or it is stale.
+         */
+        const Outcome* find(PathView path, const std::vector<unsigned int> &versions, unsigned int corpusSize);
+        /**
+         * @brief Store the outcome of a search, replacing any entry for the same path.
+         * @param path The node sequence.
+         * @param dependencies The nodes whose occurrence sets the search read.
+         * @param versions Current version of every node.
+         * @param corpusSize Current corpus size.
+         * @param outcome The outcome.
+         */
+        void store(PathView path, const std::vector<unsigned int> &dependencies, const std::vector<unsigned int> &versions, unsigned int corpusSize, Outcome outcome);
+        /**
+         * @brief Remove every entry (needed when node ids change meaning or the search parameters change).
+         */
+        void clear();
+        /**
+         * @brief Bound the size of the entries; takes effect at the next store.
+         * @param bytes Largest estimated size of all entries (0: unbounded).
+         */
+        void setCapacity(std::size_t bytes) { capacity = bytes; }
+        /**
+         * @brief Get the estimated size of all entries.
+         * @return The size in bytes.
+         */
+        std::size_t bytes() const { return entry_bytes; }
+        /**
+         * @brief Get the number of times the memo was cleared to stay within its capacity.
+         * @return The number of overflows.
+         */
+        std::size_t overflows() const { return overflow_count; }
+        /**
+         * @brief Get the number of entries.
+         * @return The number of stored paths.
+         */
+        std::size_t size() const { return entry_count; }
+        /**
+         * @brief Get the number of successful lookups since construction.
+         * @return The number of hits.
+         */
+        std::size_t hits() const { return hit_count; }
+        /**
+         * @brief Get the number of failed lookups (missing or stale) since construction.
+         * @return The number of misses.
+         */
+        std::size_t misses() const { return miss_count; }
+
+    private:
+        struct Entry
+        {
+            std::vector<unsigned int> path;
+            std::vector<std::pair<unsigned int, unsigned int> > stamps;  // (node, version)
+            unsigned int corpus_size;
+            Outcome outcome;
+            std::size_t bytes;
+        };
+
+        Entry* lookup(PathView path, std::uint64_t key);
+        static std::size_t sizeOf(std::size_t pathLength, std::size_t dependencies, const Outcome &outcome);
+
+        std::unordered_map<std::uint64_t, std::vector<Entry> > buckets;
+        std::size_t entry_count = 0;
+        std::size_t entry_bytes = 0;
+        std::size_t capacity = 0;
+        std::size_t overflow_count = 0;
+        std::size_t hit_count = 0;
+        std::size_t miss_count = 0;
+};
+
+#endif
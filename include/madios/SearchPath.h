@@ -10,28 +10,138 @@
 #define SEARCHPATH_H
 
 #include "utils/Stringable.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <memory_resource>
 #include <sstream>
 #include <vector>
 
+/**
+ * @class PathView
+ * @brief Non-owning view of a contiguous run of node indices (a whole path or a subpath).
+ *
+ * A view is two words and copying it never allocates. It stays valid only while the viewed
+ * path is alive and not resized.
+ */
+class PathView
+{
+    public:
+        /**
+         * @brief Create an empty view.
+         */
+        PathView(): first(nullptr), length(0) {}
+        /**
+         * @brief View length node indices starting at data.
+         * @param data First node index.
+         * @param length Number of node indices.
+         */
+        PathView(const unsigned int *data, std::size_t length): first(data), length(length) {}
+        /**
+         * @brief View a whole path (implicit, so paths can be passed wherever a view is expected).
+         * @param path The path.
+         */
+        PathView(const std::vector<unsigned int> &path): first(path.data()), length(path.size()) {}
+        /**
+         * @brief View a whole path held with a polymorphic allocator (such as a SearchPath).
+         * @param path The path.
+         */
+        PathView(const std::pmr::vector<unsigned int> &path): first(path.data()), length(path.size()) {}
+
+        /**
+         * @brief Get a subview from start to finish (inclusive), like SearchPath::operator().
+         * @param start Start index.
+         * @param finish End index.
+         * @return The subview.
+         */
+        PathView operator()(unsigned int start, unsigned int finish) const
+        {
+            assert(start <= finish);
+            assert(finish < length);
+            return PathView(first + start, finish - start + 1);
+        }
+        unsigned int operator[](std::size_t i) const { return first[i]; }
+        const unsigned int* data() const { return first; }
+        const unsigned int* begin() const { return first; }
+        const unsigned int* end() const { return first + length; }
+        std::size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+        unsigned int front() const { return first[0]; }
+        unsigned int back() const { return first[length - 1]; }
+
+    private:
+        const unsigned int *first;
+        std::size_t length;
+};
+
 /**
  * @class SearchPath
  * @brief Manages search paths through the ADIOS graph for parsing or pattern finding.
  *
- * Inherits from Stringable and std::vector<unsigned int>.
+ * Inherits from Stringable and std::pmr::vector<unsigned int>. Paths use the default memory
+ * resource unless one is given; the graph's paths live in its MappedStore in out-of-core mode.
+ * Like any pmr container, a copy uses the default resource and an assignment keeps the target's.
+ *
+ * Every path carries a polynomial hash of its nodes, hash() = sum of mix(node_i) * B^i mod 2^64,
+ * which rewire(), set() and substitute() update from the changed segment and the shorter of the
+ * prefix and suffix instead of rehashing the whole path. Paths that differ in size or hash are
+ * unequal without comparing nodes, and SearchPathHash lets paths key hash sets and maps.
+ * Edits made through the vector interface bypass the hash: call rehash() after them. Debug builds
+ * check that the hash is current whenever hash(), set(), rewire() or substitute() uses it.
  */
-class SearchPath: public Stringable, public std::vector<unsigned int>
+class SearchPath: public Stringable, public std::pmr::vector<unsigned int>
 {
     public:
         /**
          * @brief Default constructor. Creates an empty search path.
          */
         SearchPath();
+        /**
+         * @brief Copy constructor (the copy uses the default memory resource).
+         * @param other The path to copy.
+         */
+        SearchPath(const SearchPath &other) = default;
+        /**
+         * @brief Move constructor (takes over the buffer and its memory resource).
+         * @param other The path to move from.
+         */
+        SearchPath(SearchPath &&other) noexcept;
+        /**
+         * @brief Copy a path into a given memory resource (the allocator-extended copy constructor).
+         * @param other The path to copy.
+         * @param alloc Allocator for the copy.
+         */
+        SearchPath(const SearchPath &other, const allocator_type &alloc);
+        /**
+         * @brief Move a path into a given memory resource (copies if the resources differ).
+         * @param other The path to move from.
+         * @param alloc Allocator for the result.
+         */
+        SearchPath(SearchPath &&other, const allocator_type &alloc);
+        SearchPath& operator=(const SearchPath &other) = default;
+        SearchPath& operator=(SearchPath &&other);
         /**
          * @brief Construct from a vector of node indices.
          * @param path Vector of node indices to initialize the path.
          */
         explicit SearchPath(const std::vector<unsigned int> &path);
+        /**
+         * @brief Construct from a vector of node indices that is no longer needed.
+         * @param path Vector of node indices (copied, as its allocator type differs).
+         */
+        explicit SearchPath(std::vector<unsigned int> &&path);
+        /**
+         * @brief Construct from a view of node indices (copies them).
+         * @param path The viewed node indices.
+         */
+        explicit SearchPath(PathView path);
+        /**
+         * @brief Construct from a view of node indices, allocating from a given memory resource.
+         * @param path The viewed node indices.
+         * @param alloc Allocator for the path.
+         */
+        SearchPath(PathView path, const allocator_type &alloc);
         /**
          * @brief Destructor.
          */
@@ -42,6 +152,38 @@ class SearchPath: public Stringable, public std::vector<unsigned int>
          * @return True if equal, false otherwise.
          */
         bool operator==(const SearchPath &other) const;
+        /**
+         * @brief Inequality operator.
+         * @param other The other SearchPath to compare.
+         * @return True if the paths differ.
+         */
+        bool operator!=(const SearchPath &other) const { return !(*this == other); }
+        /**
+         * @brief Get the hash of the path's nodes.
+         * @return The hash, equal to hashOf(*this).
+         */
+        std::uint64_t hash() const { assert(path_hash == hashOf(*this)); return path_hash; }
+        /**
+         * @brief Hash a node sequence the way SearchPath::hash() does.
+         * @param path The node sequence.
+         * @return Its hash.
+         */
+        static std::uint64_t hashOf(PathView path);
+        /**
+         * @brief Recompute the hash after edits made through the vector interface.
+         */
+        void rehash() { path_hash = hashOf(*this); }
+        /**
+         * @brief Replace one node, updating the hash.
+         * @param i Index of the node.
+         * @param node The new node.
+         */
+        void set(unsigned int i, unsigned int node);
+        /**
+         * @brief Replace every node n by mapping[n] (after the graph renumbers its nodes).
+         * @param mapping New index of each old node index.
+         */
+        void relabel(const std::vector<unsigned int> &mapping);
         /**
          * @brief Rewire a segment of the path to a new node.
          * @param start Start index.
@@ -56,19 +198,39 @@ class SearchPath: public Stringable, public std::vector<unsigned int>
          * @return Vector of node indices in the subpath.
          */
         std::vector<unsigned int> operator()(unsigned int start, unsigned int finish) const;
+        /**
+         * @brief View a subpath from start to finish (inclusive) without copying it.
+         * @param start Start index.
+         * @param finish End index.
+         * @return View of the subpath, valid while this path is unchanged.
+         */
+        PathView view(unsigned int start, unsigned int finish) const { return PathView(*this)(start, finish); }
         /**
          * @brief Substitute a segment of the path with a new segment.
          * @param start Start index.
          * @param finish End index.
          * @param segment The segment to insert.
-         * @return New vector with the substitution applied.
+         * @return New path with the substitution applied (its hash is derived from this one's).
          */
-        std::vector<unsigned int> substitute(unsigned int start, unsigned int finish, const std::vector<unsigned int> &segment) const;
+        SearchPath substitute(unsigned int start, unsigned int finish, PathView segment) const;
         /**
          * @brief Get a string representation of the search path.
          * @return String describing the path.
          */
         virtual std::string toString() const;
+
+    private:
+        std::uint64_t spliceHash(unsigned int start, unsigned int finish, PathView segment) const;
+
+        std::uint64_t path_hash = 0;
+};
+
+/**
+ * @brief Hash functor for keying unordered containers by SearchPath (or references to one).
+ */
+struct SearchPathHash
+{
+    std::size_t operator()(const SearchPath &path) const { return static_cast<std::size_t>(path.hash()); }
 };
 
 #endif
@@ -11,6 +11,7 @@
 #define SIGNIFICANTPATTERN_H
 
 #include "LexiconUnit.h"
+#include "SearchPath.h"
 #include <vector>
 #include <sstream>
 
@@ -33,6 +34,11 @@ class SignificantPattern: public LexiconUnit, public std::vector<unsigned int>
          * @param sequence Vector of unit indices to initialize the pattern.
          */
         explicit SignificantPattern(const std::vector<unsigned int> &sequence);
+        /**
+         * @brief Constructs a significant pattern from a view of unit indices (e.g. a subpath).
+         * @param sequence View of the unit indices to copy into the pattern.
+         */
+        explicit SignificantPattern(PathView sequence);
         /**
          * @brief Destructor.
          */
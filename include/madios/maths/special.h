@@ -83,6 +83,90 @@ double factln(unsigned int n);
  */
 double binom(unsigned int k, unsigned int n, double p);
 
+/**
+ * @brief Returns the regularized upper incomplete gamma function Q(a, x).
+ * @param a Shape (a > 0).
+ * @param x Argument (x >= 0).
+ * @return Q(a, x) = 1 - P(a, x).
+ */
+double gammq(double a, double x);
+/**
+ * @brief Returns the standard normal distribution function.
+ * @param x Input value.
+ * @return Phi(x).
+ */
+double normal_cdf(double x);
+/**
+ * @brief Returns the lower binomial tail P(X <= k), X ~ Bin(n, p), as the sum of its terms.
+ * @param k Largest number of successes.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @return The tail probability.
+ */
+double binom_cdf(unsigned int k, unsigned int n, double p);
+/**
+ * @brief Returns the continuity-corrected normal approximation of the lower binomial tail.
+ * Its absolute error is at most binom_normal_error(n, p) (Berry-Esseen).
+ * @param k Largest number of successes.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @return Phi((k + 0.5 - np) / sqrt(np(1-p))).
+ */
+double binom_cdf_normal(unsigned int k, unsigned int n, double p);
+/**
+ * @brief Returns the Poisson(np) approximation of the lower binomial tail.
+ * Its absolute error is at most binom_poisson_error(n, p) (Barbour-Hall).
+ * @param k Largest number of successes.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @return P(Y <= k), Y ~ Poisson(np).
+ */
+double binom_cdf_poisson(unsigned int k, unsigned int n, double p);
+/**
+ * @brief Returns the Berry-Esseen bound on the error of binom_cdf_normal.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @return 0.4748 (p^2 + q^2) / sqrt(npq), or infinity if npq is 0.
+ */
+double binom_normal_error(unsigned int n, double p);
+/**
+ * @brief Returns the Barbour-Hall bound on the error of binom_cdf_poisson.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @return (1 - exp(-np)) p.
+ */
+double binom_poisson_error(unsigned int n, double p);
+/**
+ * @brief Returns the lower binomial tail as the regularized incomplete beta function I_{1-p}(n - k, k + 1).
+ *
+ * The continued fraction takes O(sqrt(n)) steps instead of the k + 1 terms of binom_cdf. It has no
+ * modelling error: the bound covers rounding, about 1e-14 n log n relative to the smaller of the tail
+ * and its complement, so it stays tight for the tiny p-values that rank patterns.
+ * @param k Largest number of successes.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @param error Set to a bound on the absolute error (infinity, with the exact sum returned, if the fraction did not converge).
+ * @return The tail probability.
+ */
+double binom_cdf_beta(unsigned int k, unsigned int n, double p, double &error);
+/**
+ * @brief Returns the lower binomial tail P(X <= k) under an approximation policy.
+ *
+ * For n >= approximateAbove (0 disables the policy), the normal or Poisson approximation is used,
+ * whichever has the smaller error bound, if that bound is at most maxError. These O(1) forms only
+ * apply to large counts (the normal bound is 1e-3 at npq of about 2e5, the Poisson bound at p of
+ * about 1e-3). Otherwise binom_cdf_beta is used if its bound is at most maxError, which holds for any
+ * maxError above about 1e-14 n log n; otherwise the exact sum.
+ * @param k Largest number of successes.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ * @param approximateAbove Smallest n that may be approximated (0: always exact).
+ * @param maxError Largest accepted error bound.
+ * @param error Set to the error bound of the result (0 if it is exact).
+ * @return The tail probability.
+ */
+double binom_tail(unsigned int k, unsigned int n, double p, unsigned int approximateAbove, double maxError, double &error);
+
 /**
  * @brief Solves a cubic equation a*x^3 + b*x^2 + c*x + d = 0.
  * @param a Coefficient of x^3.
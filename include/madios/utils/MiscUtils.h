@@ -58,6 +58,14 @@ std::string trimSpaces(const std::string &s);
  * @return Vector of token sequences. Warns once if markers are missing.
  */
 std::vector<std::vector<std::string> > readSequencesFromFile(const std::string &filename);
+/**
+ * @brief Reads the next sequence from a stream, in the formats readSequencesFromFile accepts.
+ * Lets a corpus be consumed one sequence at a time instead of being held in memory.
+ * @param in The stream to read from.
+ * @param tokens Set to the tokens of the sequence, without the '*' and '#' markers.
+ * @return False if the stream holds no further sequence. Warns once if markers are missing.
+ */
+bool readSequence(std::istream &in, std::vector<std::string> &tokens);
 
 /**
  * @brief Converts a value to a string using stringstream.
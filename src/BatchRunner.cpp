@@ -0,0 +1,256 @@
+// File: BatchRunner.cpp
+// Purpose: Implements the BatchRunner class, which distills many corpora concurrently in one process.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Parse job manifests
+//   - Run jobs on a pool of worker threads, largest corpus first, each under its own memory budget
+//     and with its own log file
+//   - Report per-job status, size and timing, and the batch totals
+//
+// Design notes:
+//   - A job never shares mutable state with another: it owns its graph, and RDSGraph's scratch
+//     buffers (DistillWorkspace) are per thread
+//   - Any exception from a job is caught and recorded in its result; it never stops the pool
+
+#include "BatchRunner.h"
+#include "JobMemory.h"
+#include "MiscUtils.h"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "TimeFuncs.h"
+#include "madios/Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Utility: resolve a manifest path against the manifest's directory.
+string resolvePath(const string &path, const string &directory)
+{
+    if(directory.empty() || std::filesystem::path(path).is_absolute())
+        return path;
+    return (std::filesystem::path(directory) / path).string();
+}
+
+// Utility: size of a file in bytes, 0 if it cannot be read.
+std::uintmax_t fileSize(const string &path)
+{
+    std::error_code error;
+    std::uintmax_t size = std::filesystem::file_size(path, error);
+    return error ? 0 : size;
+}
+
+}  // namespace
+
+/**
+ * @brief Read a job manifest.
+ * @param in Stream to read from
+ * @param directory Directory for relative paths
+ * @return The jobs in manifest order
+ */
+vector<BatchRunner::Job> BatchRunner::readManifest(std::istream &in, const string &directory)
+{
+    vector<Job> jobs;
+    string line;
+    unsigned int number = 0;
+    while(std::getline(in, line))
+    {
+        number++;
+        std::istringstream fields(line);
+        string corpus;
+        if(!(fields >> corpus) || (corpus[0] == '#'))
+            continue;
+        auto fail = [&](const string &what) {
+            return std::runtime_error("BatchRunner::readManifest: line " + std::to_string(number) + ": " + what);
+        };
+        Job job;
+        job.corpus = resolvePath(corpus, directory);
+        string output;
+        double eta, alpha, coverage;
+        int context;
+        if(!(fields >> output >> eta >> alpha >> context >> coverage))
+            throw fail("expected 'corpus output eta alpha context_size coverage'");
+        if((eta <= 0.0) || (eta > 1.0) || (alpha <= 0.0) || (alpha > 1.0) || (context < 3) || (coverage <= 0.0) || (coverage > 1.0))
+            throw fail("parameter out of range");
+        job.output = resolvePath(output, directory);
+        job.params = ADIOSParams(eta, alpha, static_cast<unsigned int>(context), coverage);
+        string option;
+        while(fields >> option)
+        {
+            string::size_type equals = option.find('=');
+            string key = option.substr(0, equals);
+            string value = (equals == string::npos) ? "" : option.substr(equals + 1);
+            if((key == "format") && ((value == "pcfg") || (value == "snapshot")))
+                job.format = value;
+            else if((key == "memory-mb") && !value.empty() && (value.find_first_not_of("0123456789") == string::npos))
+                job.memoryLimit = static_cast<std::size_t>(std::stoull(value)) << 20;
+            else
+                throw fail("unknown option '" + option + "'");
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+/**
+ * @brief Get the name of a job status.
+ * @param status The status
+ * @return Its name in the report
+ */
+const char* BatchRunner::statusName(Status status)
+{
+    switch(status)
+    {
+        case Status::Succeeded: return "ok";
+        case Status::OutOfMemory: return "out-of-memory";
+        default: return "failed";
+    }
+}
+
+/**
+ * @brief Create a runner.
+ * @param threads Number of worker threads
+ * @param memoryLimit Default byte limit of each job (0: unlimited)
+ */
+BatchRunner::BatchRunner(unsigned int threads, std::size_t memoryLimit)
+: threads(std::max(1u, threads)), memory_limit(memoryLimit)
+{
+}
+
+/**
+ * @brief Run jobs concurrently, largest corpus first.
+ * @param jobs The jobs
+ * @return One result per job, in the order of jobs
+ */
+vector<BatchRunner::Result> BatchRunner::run(const vector<Job> &jobs) const
+{
+    vector<unsigned int> order(jobs.size());
+    vector<std::uintmax_t> sizes(jobs.size());
+    for(unsigned int i = 0; i < jobs.size(); i++)
+    {
+        order[i] = i;
+        sizes[i] = fileSize(jobs[i].corpus);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return sizes[a] > sizes[b]; });
+
+    vector<Result> results(jobs.size());
+    std::atomic<size_t> next_job(0);
+    auto worker = [&]() {
+        for(size_t k = next_job++; k < order.size(); k = next_job++)
+            results[order[k]] = runJob(jobs[order[k]]);
+    };
+    vector<std::thread> workers;
+    unsigned int pool = std::min<size_t>(threads, std::max<size_t>(1, jobs.size()));
+    for(unsigned int t = 1; t < pool; t++)
+        workers.emplace_back(worker);
+    worker();
+    for(auto &w : workers)
+        w.join();
+    return results;
+}
+
+/**
+ * @brief Write the per-job report and the totals.
+ * @param out Stream to write to
+ * @param jobs The jobs
+ * @param results Their results
+ * @param wallSeconds Wall time of the whole batch
+ */
+void BatchRunner::writeReport(std::ostream &out, const vector<Job> &jobs, const vector<Result> &results, double wallSeconds) const
+{
+    unsigned int counts[3] = {0, 0, 0};
+    double job_seconds = 0.0;
+    out << "# job\tcorpus\tstatus\tsequences\tpatterns\tseconds\tpeak_mb\tmessage\n";
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        counts[static_cast<int>(r.status)]++;
+        job_seconds += r.seconds;
+        out << i << "\t" << jobs[i].corpus << "\t" << statusName(r.status) << "\t" << r.sequences << "\t" << r.patterns << "\t"
+            << std::fixed << std::setprecision(3) << r.seconds << "\t" << std::setprecision(1) << (r.peakBytes / 1048576.0)
+            << std::defaultfloat << "\t" << r.message << "\n";
+    }
+    out << "# jobs " << results.size() << " ok " << counts[0] << " failed " << counts[1] << " out-of-memory " << counts[2] << "\n";
+    out << "# threads " << threads << " wall_seconds " << std::fixed << std::setprecision(3) << wallSeconds
+        << " job_seconds " << job_seconds << " parallelism " << std::setprecision(2) << ((wallSeconds > 0.0) ? job_seconds / wallSeconds : 0.0)
+        << std::defaultfloat << std::endl;
+}
+
+// BatchRunner::runJob
+// Distill one corpus on the calling thread, with the job's log file as this thread's log sink and
+// under the job's memory budget. The graph is destroyed before the budget closes, so the peak
+// covers the whole job.
+BatchRunner::Result BatchRunner::runJob(const Job &job) const
+{
+    Result result;
+    std::ofstream log(job.output + ".log");
+    madios::Logger::setThreadSink(log.is_open() ? &log : nullptr);
+    double start = getTime();
+    {
+        JobMemory budget((job.memoryLimit > 0) ? job.memoryLimit : memory_limit);
+        try
+        {
+            if(!log.is_open())
+                throw std::runtime_error("cannot open log file '" + job.output + ".log'");
+            if(!std::ifstream(job.corpus).good())
+                throw std::runtime_error("cannot open corpus '" + job.corpus + "'");
+            vector<vector<string> > sequences = readSequencesFromFile(job.corpus);
+            if(sequences.empty())
+                throw std::runtime_error("no sequences in corpus '" + job.corpus + "'");
+            result.sequences = sequences.size();
+
+            RDSGraph graph(sequences);
+            vector<vector<string> >().swap(sequences);
+            graph.setQuiet(true);
+            madios::Logger::info("BatchRunner: distilling " + job.corpus);
+            graph.distill(job.params);
+            result.patterns = graph.getPatternCount();
+
+            bool binary = (job.format == "snapshot");
+            std::ofstream out(job.output, binary ? std::ios::binary : std::ios::out);
+            if(out.is_open())
+            {
+                if(binary)
+                    graph.toPCFG().writeSnapshot(out);
+                else
+                    graph.convert2PCFG(out);
+            }
+            if(!out)
+                throw std::runtime_error("cannot write output file '" + job.output + "'");
+            result.status = Status::Succeeded;
+        }
+        catch(const std::bad_alloc &)
+        {
+            result.message = "out of memory";
+        }
+        catch(const std::exception &e)
+        {
+            result.message = e.what();
+        }
+        if(budget.exceeded())
+        {
+            result.status = Status::OutOfMemory;
+            result.message = "memory limit of " + std::to_string(((job.memoryLimit > 0) ? job.memoryLimit : memory_limit) >> 20) + " MB exceeded";
+        }
+        result.peakBytes = budget.peak();
+    }
+    result.seconds = getTime() - start;
+    if(result.status != Status::Succeeded)
+        madios::Logger::error("BatchRunner: " + job.corpus + ": " + result.message);
+    madios::Logger::setThreadSink(nullptr);
+    return result;
+}
@@ -0,0 +1,21 @@
+// File: DistillWorkspace.cpp
+// Purpose: Implements DistillWorkspace::local, the per-thread workspace for the flow/descent search.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Own one DistillWorkspace per thread for the lifetime of the thread
+//
+// Design notes:
+//   - Defined out of line so that the thread_local object has a single definition across the library
+
+#include "DistillWorkspace.h"
+
+/**
+ * @brief Get the workspace of the calling thread.
+ * @return The thread's workspace
+ */
+DistillWorkspace& DistillWorkspace::local()
+{
+    thread_local DistillWorkspace workspace;
+    return workspace;
+}
@@ -43,6 +43,18 @@ EquivalenceClass::EquivalenceClass(const std::vector<unsigned int> &units)
     madios::Logger::trace("EquivalenceClass constructed from vector, size: " + std::to_string(units.size()));
 }
 
+/**
+ * @brief Construct an equivalence class from a view of units.
+ * @param units View of node indices to include in the class
+ */
+EquivalenceClass::EquivalenceClass(PathView units)
+:vector<unsigned int>(units.begin(), units.end())
+{
+    if (units.empty()) {
+        throw std::invalid_argument("EquivalenceClass: input units view is empty");
+    }
+}
+
 /**
  * @brief Destructor. No special cleanup needed.
  */
@@ -0,0 +1,175 @@
+// File: FrozenGrammar.cpp
+// Purpose: Implements the FrozenGrammar class, an immutable snapshot of a learned grammar for concurrent readers.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Flatten the rules of a PCFG into tables grouped by left-hand side
+//   - Build a Walker alias table per nonterminal (Vose's construction)
+//   - Sample sentences iteratively and score them with the inside algorithm
+//
+// Design notes:
+//   - Symbol ids are the PCFG's own, so names and ids agree with InsideScorer and PatternTagger
+//   - All members are written only by the constructor; const methods keep their state on the stack
+
+#include "FrozenGrammar.h"
+#include "madios/Logger.h"
+
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Freeze a grammar into flat rule and alias tables.
+ * @param grammar The grammar
+ */
+FrozenGrammar::FrozenGrammar(const PCFG &grammar)
+: start(grammar.startSymbol()), scorer(grammar)
+{
+    madios::Logger::trace("Entering FrozenGrammar constructor");
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+    {
+        names.push_back(grammar.symbolName(id));
+        ids.emplace(names.back(), id);
+    }
+
+    rule_begin.assign(1, 0);
+    rhs_begin.assign(1, 0);
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+    {
+        for(unsigned int r : grammar.rulesFor(id))
+        {
+            const PCFG::Rule &rule = grammar.rules()[r];
+            rhs.insert(rhs.end(), rule.rhs.begin(), rule.rhs.end());
+            rhs_begin.push_back(rhs.size());
+            probabilities.push_back(rule.probability);
+        }
+        rule_begin.push_back(probabilities.size());
+    }
+
+    alias_keep.assign(probabilities.size(), 1.0);
+    alias_rule.resize(probabilities.size());
+    for(unsigned int id = 0; id < names.size(); id++)
+        buildAliasTable(rule_begin[id], rule_begin[id + 1]);
+    madios::Logger::trace("Exiting FrozenGrammar constructor");
+}
+
+/**
+ * @brief Sample a sentence from the start symbol.
+ * @param rng Random engine
+ * @param maxLength Maximum number of tokens
+ * @return The sentence tokens
+ */
+vector<string> FrozenGrammar::generate(std::mt19937 &rng, unsigned int maxLength) const
+{
+    vector<string> sentence;
+    expand(start, rng, sentence, maxLength);
+    return sentence;
+}
+
+/**
+ * @brief Sample the yield of a symbol and append it to a token list.
+ * @param symbol The symbol to expand
+ * @param rng Random engine
+ * @param sentence Tokens to append to
+ * @param maxLength Maximum number of tokens in sentence
+ */
+void FrozenGrammar::expand(unsigned int symbol, std::mt19937 &rng, vector<string> &sentence, unsigned int maxLength) const
+{
+    vector<unsigned int> pending(1, symbol);  // symbols still to expand, next one at the back
+    while(!pending.empty())
+    {
+        unsigned int next = pending.back();
+        pending.pop_back();
+        if(rule_begin[next] == rule_begin[next + 1])
+        {
+            sentence.push_back(names[next]);
+            continue;
+        }
+        unsigned int r = sampleRule(next, rng);
+        for(unsigned int k = rhs_begin[r + 1]; k > rhs_begin[r]; k--)
+            pending.push_back(rhs[k - 1]);
+        if(sentence.size() + pending.size() > maxLength)
+            throw std::runtime_error("FrozenGrammar::generate: sentence exceeds " + std::to_string(maxLength) + " tokens");
+    }
+}
+
+/**
+ * @brief Look up a symbol id by name.
+ * @param name The symbol name
+ * @return The symbol id, or PCFG::npos if unknown
+ */
+unsigned int FrozenGrammar::symbolId(const string &name) const
+{
+    auto found = ids.find(name);
+    return (found == ids.end()) ? PCFG::npos : found->second;
+}
+
+/**
+ * @brief Get the total probability of the rules lhs -> rhs.
+ * @param lhs The left-hand side symbol id
+ * @param right The right-hand side symbol ids
+ * @return The probability
+ */
+double FrozenGrammar::ruleProbability(unsigned int lhs, const vector<unsigned int> &right) const
+{
+    double total = 0.0;
+    for(unsigned int r = rule_begin[lhs]; r < rule_begin[lhs + 1]; r++)
+        if(vector<unsigned int>(rhs.begin() + rhs_begin[r], rhs.begin() + rhs_begin[r + 1]) == right)
+            total += probabilities[r];
+    return total;
+}
+
+// FrozenGrammar::buildAliasTable
+// Vose's alias method over rules [first, last). Rules are scaled so that their mean is 1; every
+// "small" rule is topped up by one "large" rule, which becomes its alias. If all probabilities
+// are zero the table stays uniform.
+void FrozenGrammar::buildAliasTable(unsigned int first, unsigned int last)
+{
+    unsigned int n = last - first;
+    double total = 0.0;
+    for(unsigned int r = first; r < last; r++)
+        total += probabilities[r];
+    for(unsigned int r = first; r < last; r++)
+        alias_rule[r] = r;
+    if((n == 0) || (total <= 0.0))
+        return;
+
+    vector<double> scaled(n);
+    vector<unsigned int> small, large;
+    for(unsigned int i = 0; i < n; i++)
+    {
+        scaled[i] = probabilities[first + i] * n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while(!small.empty() && !large.empty())
+    {
+        unsigned int s = small.back();
+        small.pop_back();
+        unsigned int l = large.back();
+        alias_keep[first + s] = scaled[s];
+        alias_rule[first + s] = first + l;
+        scaled[l] -= 1.0 - scaled[s];
+        if(scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // leftovers are 1 up to rounding error
+    for(unsigned int i : small)
+        alias_keep[first + i] = 1.0;
+    for(unsigned int i : large)
+        alias_keep[first + i] = 1.0;
+}
+
+// FrozenGrammar::sampleRule
+// Draw one rule of a nonterminal: a uniform column, then the column's rule or its alias.
+unsigned int FrozenGrammar::sampleRule(unsigned int symbol, std::mt19937 &rng) const
+{
+    unsigned int first = rule_begin[symbol];
+    std::uniform_int_distribution<unsigned int> column(first, rule_begin[symbol + 1] - 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    unsigned int r = column(rng);
+    return (coin(rng) < alias_keep[r]) ? r : alias_rule[r];
+}
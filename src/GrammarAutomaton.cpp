@@ -0,0 +1,253 @@
+// File: GrammarAutomaton.cpp
+// Purpose: Implements the GrammarAutomaton class, a minimized DFA that recognizes the language of a learned grammar.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Unfold the grammar DAG into an epsilon-free NFA
+//   - Determinize (subset construction) and minimize (Moore refinement)
+//   - Recognize sentences in one pass, or fall back to the chart parser
+//
+// Design notes:
+//   - NFA state 0 is the start and state 1 the only final state; every rule becomes a chain of states,
+//     so shared sub-patterns are copied once per use (this is what the state limit guards)
+//   - No symbol derives the empty string, so the DFA is trim and partial transitions mean "reject"
+//   - Rules with zero probability are ignored, as in InsideScorer
+
+#include "GrammarAutomaton.h"
+#include "RDSGraph.h"
+#include "madios/Logger.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Thrown while compiling when the grammar cannot (or should not) become an automaton
+struct CompileAbort
+{
+    string reason;
+};
+
+typedef vector<vector<std::pair<unsigned int, unsigned int> > > Transitions;  // per state: (word, target)
+
+// Unfolds grammar symbols between two NFA states
+class NfaBuilder
+{
+    public:
+        NfaBuilder(const PCFG &grammar, const vector<unsigned int> &word_of_symbol, unsigned int max_states)
+        : grammar(grammar), word_of_symbol(word_of_symbol), max_states(max_states),
+          on_stack(grammar.symbolCount(), false), nfa(2)
+        {}
+
+        void expand(unsigned int symbol, unsigned int from, unsigned int to)
+        {
+            if(!grammar.isNonterminal(symbol))
+            {
+                nfa[from].push_back(std::make_pair(word_of_symbol[symbol], to));
+                return;
+            }
+            if(on_stack[symbol])
+                throw CompileAbort{"grammar is recursive through " + grammar.symbolName(symbol)};
+            on_stack[symbol] = true;
+            for(unsigned int r : grammar.rulesFor(symbol))
+            {
+                const PCFG::Rule &rule = grammar.rules()[r];
+                if(rule.probability <= 0.0)
+                    continue;
+                unsigned int previous = from;
+                for(unsigned int k = 0; k < rule.rhs.size(); k++)
+                {
+                    unsigned int next = (k + 1 == rule.rhs.size()) ? to : addState();
+                    expand(rule.rhs[k], previous, next);
+                    previous = next;
+                }
+            }
+            on_stack[symbol] = false;
+        }
+
+        Transitions& states() { return nfa; }
+
+    private:
+        unsigned int addState()
+        {
+            if(nfa.size() >= max_states)
+                throw CompileAbort{"NFA exceeds " + std::to_string(max_states) + " states"};
+            nfa.emplace_back();
+            return nfa.size() - 1;
+        }
+
+        const PCFG &grammar;
+        const vector<unsigned int> &word_of_symbol;
+        unsigned int max_states;
+        vector<bool> on_stack;
+        Transitions nfa;
+};
+
+// Subset construction from NFA start state 0; final iff the subset contains NFA state 1
+void determinize(const Transitions &nfa, unsigned int max_states, Transitions &dfa, vector<bool> &final_states)
+{
+    std::map<vector<unsigned int>, unsigned int> ids;
+    vector<vector<unsigned int> > subsets(1, vector<unsigned int>(1, 0));
+    ids.emplace(subsets[0], 0);
+    for(unsigned int d = 0; d < subsets.size(); d++)
+    {
+        vector<std::pair<unsigned int, unsigned int> > moves;
+        for(unsigned int s : subsets[d])
+            moves.insert(moves.end(), nfa[s].begin(), nfa[s].end());
+        std::sort(moves.begin(), moves.end());
+        moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+
+        vector<std::pair<unsigned int, unsigned int> > edges;
+        for(size_t begin = 0; begin < moves.size(); )
+        {
+            size_t end = begin;
+            vector<unsigned int> target;
+            while((end < moves.size()) && (moves[end].first == moves[begin].first))
+                target.push_back(moves[end++].second);
+            auto found = ids.find(target);
+            if(found == ids.end())
+            {
+                if(subsets.size() >= max_states)
+                    throw CompileAbort{"DFA exceeds " + std::to_string(max_states) + " states"};
+                found = ids.emplace(target, subsets.size()).first;
+                subsets.push_back(target);
+            }
+            edges.push_back(std::make_pair(moves[begin].first, found->second));
+            begin = end;
+        }
+        dfa.push_back(edges);
+    }
+    final_states.assign(subsets.size(), false);
+    for(unsigned int d = 0; d < subsets.size(); d++)
+        final_states[d] = std::binary_search(subsets[d].begin(), subsets[d].end(), 1u);
+}
+
+// Moore partition refinement; classes are numbered in order of first state, so state 0 stays in class 0
+vector<unsigned int> minimize(const Transitions &dfa, const vector<bool> &final_states, unsigned int &num_classes)
+{
+    vector<unsigned int> block(dfa.size());
+    num_classes = 0;
+    while(true)
+    {
+        std::map<vector<unsigned int>, unsigned int> signatures;
+        vector<unsigned int> refined(dfa.size());
+        for(unsigned int s = 0; s < dfa.size(); s++)
+        {
+            vector<unsigned int> signature(1, (num_classes == 0) ? (final_states[s] ? 1u : 0u) : block[s]);
+            if(num_classes > 0)
+                for(const auto &edge : dfa[s])
+                {
+                    signature.push_back(edge.first);
+                    signature.push_back(block[edge.second]);
+                }
+            refined[s] = signatures.emplace(signature, signatures.size()).first->second;
+        }
+        bool stable = (signatures.size() == num_classes);
+        block.swap(refined);
+        num_classes = signatures.size();
+        if(stable)
+            return block;
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Compile a grammar into a minimized DFA, or prepare the chart-parser fallback.
+ * @param grammar The grammar
+ * @param maxStates Maximum number of NFA or DFA states
+ */
+GrammarAutomaton::GrammarAutomaton(const PCFG &grammar, unsigned int maxStates)
+{
+    madios::Logger::trace("Entering GrammarAutomaton constructor");
+    unsigned int start = grammar.startSymbol();
+    if(start == PCFG::npos)
+        throw std::invalid_argument("GrammarAutomaton: grammar has no start symbol S");
+
+    vector<unsigned int> word_of_symbol(grammar.symbolCount(), PCFG::npos);
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+        if(!grammar.isNonterminal(id))
+        {
+            word_of_symbol[id] = vocabulary.size();
+            vocabulary.emplace(grammar.symbolName(id), word_of_symbol[id]);
+        }
+
+    try {
+        NfaBuilder builder(grammar, word_of_symbol, maxStates);
+        builder.expand(start, 0, 1);
+        Transitions dfa;
+        vector<bool> final_states;
+        determinize(builder.states(), maxStates, dfa, final_states);
+        unsigned int num_classes = 0;
+        vector<unsigned int> block = minimize(dfa, final_states, num_classes);
+
+        // one representative per class, transitions already sorted by word
+        accepting.assign(num_classes, false);
+        vector<const vector<std::pair<unsigned int, unsigned int> >*> representative(num_classes, nullptr);
+        for(unsigned int s = 0; s < dfa.size(); s++)
+            if(representative[block[s]] == nullptr)
+            {
+                representative[block[s]] = &dfa[s];
+                accepting[block[s]] = final_states[s];
+            }
+        edge_begin.assign(1, 0);
+        for(unsigned int c = 0; c < num_classes; c++)
+        {
+            for(const auto &edge : *representative[c])
+            {
+                edge_word.push_back(edge.first);
+                edge_target.push_back(block[edge.second]);
+            }
+            edge_begin.push_back(edge_word.size());
+        }
+        madios::Logger::info("GrammarAutomaton: " + std::to_string(builder.states().size()) + " NFA states, " + std::to_string(dfa.size()) + " DFA states, " + std::to_string(num_classes) + " after minimization");
+    } catch (const CompileAbort &abort) {
+        edge_begin.clear();
+        edge_word.clear();
+        edge_target.clear();
+        accepting.clear();
+        fallback_reason = abort.reason;
+        fallback = std::make_shared<const InsideScorer>(grammar);
+        madios::Logger::warn("GrammarAutomaton: falling back to chart parsing (" + fallback_reason + ")");
+    }
+}
+
+/**
+ * @brief Compile the grammar that convert2PCFG describes for a learned graph.
+ * @param graph The distilled graph
+ * @param maxStates Maximum number of NFA or DFA states
+ * @return The automaton
+ */
+GrammarAutomaton GrammarAutomaton::fromGraph(const RDSGraph &graph, unsigned int maxStates)
+{
+    return GrammarAutomaton(PCFG::fromGraph(graph), maxStates);
+}
+
+/**
+ * @brief Check whether the grammar derives a sentence.
+ * @param sentence The sentence tokens
+ * @return True if the start symbol derives the sentence
+ */
+bool GrammarAutomaton::recognizes(const vector<string> &sentence) const
+{
+    if(fallback)
+        return fallback->score(sentence).status == InsideScorer::Status::Parsed;
+    unsigned int state = 0;
+    for(const auto &token : sentence)
+    {
+        auto word = vocabulary.find(token);
+        if(word == vocabulary.end())
+            return false;
+        auto first = edge_word.begin() + edge_begin[state];
+        auto last = edge_word.begin() + edge_begin[state + 1];
+        auto found = std::lower_bound(first, last, word->second);
+        if((found == last) || (*found != word->second))
+            return false;
+        state = edge_target[found - edge_word.begin()];
+    }
+    return accepting[state];
+}
@@ -0,0 +1,213 @@
+// File: GrammarIndex.cpp
+// Purpose: Implements the GrammarIndex class, an inverted index from words and units to the SPs and ECs that contain them.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Collect units and their elements from a PCFG or from an RDSGraph's nodes
+//   - Build child and parent CSR arrays (parents are the inverted index)
+//   - Answer containment and reachability queries by breadth-first search
+//
+// Design notes:
+//   - For graphs, parents come straight from RDSNode::parents; for PCFGs they are inverted from the rules
+//   - Both directions are deduplicated per unit, so a closure visits every edge once
+
+#include "GrammarIndex.h"
+#include "RDSGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Index a grammar in the convert2PCFG form.
+ * @param grammar The grammar
+ */
+GrammarIndex::GrammarIndex(const PCFG &grammar)
+{
+    unsigned int start = grammar.startSymbol();
+    vector<unsigned int> unit_of(grammar.symbolCount(), PCFG::npos);
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+        if(id != start)
+        {
+            unit_of[id] = names.size();
+            addUnit(grammar.symbolName(id), grammar.isPattern(id) ? Kind::Pattern : (grammar.isNonterminal(id) ? Kind::Class : Kind::Word));
+        }
+
+    vector<vector<unsigned int> > children(names.size());
+    for(const auto &rule : grammar.rules())
+        if(rule.lhs != start)
+        {
+            vector<unsigned int> &elements = children[unit_of[rule.lhs]];
+            for(unsigned int symbol : rule.rhs)
+                elements.push_back(unit_of[symbol]);
+        }
+    finish(children);
+}
+
+/**
+ * @brief Index a learned graph from its nodes' parent links.
+ * @param graph The distilled graph
+ * @return The index
+ */
+GrammarIndex GrammarIndex::fromGraph(const RDSGraph &graph)
+{
+    GrammarIndex index;
+    const vector<RDSNode> &nodes = graph.getNodes();
+    index.child_begin.assign(1, 0);
+    index.parent_begin.assign(1, 0);
+    for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+        Kind kind = Kind::Word;
+        if(nodes[i].type == LexiconTypes::SP)
+        {
+            kind = Kind::Pattern;
+            const auto *sp = static_cast<const SignificantPattern *>(nodes[i].lexicon.get());
+            index.child_ids.insert(index.child_ids.end(), sp->begin(), sp->end());
+        }
+        else if(nodes[i].type == LexiconTypes::EC)
+        {
+            kind = Kind::Class;
+            const auto *ec = static_cast<const EquivalenceClass *>(nodes[i].lexicon.get());
+            index.child_ids.insert(index.child_ids.end(), ec->begin(), ec->end());
+        }
+        index.addUnit(graph.getNodeName(i), kind);
+        index.child_begin.push_back(index.child_ids.size());
+
+        // RDSNode::parents holds one (unit, position) entry per occurrence of node i
+        size_t first = index.parent_ids.size();
+        for(const auto &parent : nodes[i].parents)
+            index.parent_ids.push_back(parent.first);
+        std::sort(index.parent_ids.begin() + first, index.parent_ids.end());
+        index.parent_ids.erase(std::unique(index.parent_ids.begin() + first, index.parent_ids.end()), index.parent_ids.end());
+        index.parent_begin.push_back(index.parent_ids.size());
+    }
+    return index;
+}
+
+/**
+ * @brief Look up a unit by name.
+ * @param name The unit name
+ * @return The unit id, or PCFG::npos if unknown
+ */
+unsigned int GrammarIndex::unitId(const string &name) const
+{
+    auto found = ids.find(name);
+    return (found == ids.end()) ? PCFG::npos : found->second;
+}
+
+/**
+ * @brief Find the SPs and ECs that contain a unit, directly or transitively.
+ * @param id The unit id
+ * @return The containing unit ids
+ */
+vector<unsigned int> GrammarIndex::containers(unsigned int id) const
+{
+    return closure(id, parent_begin, parent_ids);
+}
+
+/**
+ * @brief Find the SPs that contain a unit.
+ * @param id The unit id
+ * @param transitive Whether to include indirect containment
+ * @return The pattern ids
+ */
+vector<unsigned int> GrammarIndex::patternsContaining(unsigned int id, bool transitive) const
+{
+    PathView direct = parents(id);
+    return filter(transitive ? containers(id) : vector<unsigned int>(direct.begin(), direct.end()), Kind::Pattern);
+}
+
+/**
+ * @brief Find the ECs that contain a unit.
+ * @param id The unit id
+ * @param transitive Whether to include indirect containment
+ * @return The class ids
+ */
+vector<unsigned int> GrammarIndex::classesContaining(unsigned int id, bool transitive) const
+{
+    PathView direct = parents(id);
+    return filter(transitive ? containers(id) : vector<unsigned int>(direct.begin(), direct.end()), Kind::Class);
+}
+
+/**
+ * @brief Find every unit reachable below a unit.
+ * @param id The unit id
+ * @return The reachable unit ids
+ */
+vector<unsigned int> GrammarIndex::reachable(unsigned int id) const
+{
+    return closure(id, child_begin, child_ids);
+}
+
+// GrammarIndex::addUnit
+// Append a unit with no edges yet.
+void GrammarIndex::addUnit(const string &name, Kind kind)
+{
+    ids.emplace(name, names.size());
+    names.push_back(name);
+    kinds.push_back(kind);
+}
+
+// GrammarIndex::finish
+// Build the child CSR from per-unit element lists and invert it into the parent CSR.
+void GrammarIndex::finish(const vector<vector<unsigned int> > &children)
+{
+    child_begin.assign(1, 0);
+    vector<unsigned int> parent_count(names.size() + 1, 0);
+    for(unsigned int unit = 0; unit < children.size(); unit++)
+    {
+        child_ids.insert(child_ids.end(), children[unit].begin(), children[unit].end());
+        child_begin.push_back(child_ids.size());
+        vector<unsigned int> distinct(children[unit]);
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        for(unsigned int element : distinct)
+            parent_count[element + 1]++;
+    }
+    parent_begin.assign(names.size() + 1, 0);
+    for(unsigned int unit = 0; unit < names.size(); unit++)
+        parent_begin[unit + 1] = parent_begin[unit] + parent_count[unit + 1];
+    parent_ids.assign(parent_begin.back(), 0);
+    vector<unsigned int> fill(parent_begin.begin(), parent_begin.end() - 1);
+    vector<unsigned int> last_parent(names.size(), PCFG::npos);
+    for(unsigned int unit = 0; unit < children.size(); unit++)   // ascending, so each parent list ends up sorted
+        for(unsigned int element : children[unit])
+            if(last_parent[element] != unit)
+            {
+                last_parent[element] = unit;
+                parent_ids[fill[element]++] = unit;
+            }
+}
+
+// GrammarIndex::closure
+// Breadth-first search from a unit along one CSR direction; the start unit itself is excluded.
+vector<unsigned int> GrammarIndex::closure(unsigned int id, const vector<unsigned int> &begin, const vector<unsigned int> &edges) const
+{
+    if (id >= names.size()) {
+        throw std::out_of_range("GrammarIndex::closure: unit id out of range");
+    }
+    vector<bool> seen(names.size(), false);
+    vector<unsigned int> found;
+    seen[id] = true;
+    vector<unsigned int> queue(1, id);
+    for(size_t head = 0; head < queue.size(); head++)
+        for(unsigned int k = begin[queue[head]]; k < begin[queue[head] + 1]; k++)
+            if(!seen[edges[k]])
+            {
+                seen[edges[k]] = true;
+                queue.push_back(edges[k]);
+                found.push_back(edges[k]);
+            }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+// GrammarIndex::filter
+// Keep the units of one kind.
+vector<unsigned int> GrammarIndex::filter(vector<unsigned int> units, Kind wanted) const
+{
+    units.erase(std::remove_if(units.begin(), units.end(), [this, wanted](unsigned int unit) { return kinds[unit] != wanted; }), units.end());
+    return units;
+}
@@ -0,0 +1,228 @@
+// File: InsideScorer.cpp
+// Purpose: Implements the InsideScorer class, which computes sentence probabilities under a learned PCFG.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Binarize the grammar (shared right-branching intermediate symbols)
+//   - Order unary rules topologically and reject unary cycles
+//   - Run the inside algorithm in log space over a dense chart
+//
+// Design notes:
+//   - Symbol ids below PCFG::symbolCount() are the grammar's own; intermediates are appended after them
+//   - Terminals are their own preterminals: a word's length-1 span starts at log 1 for that word
+//   - Each span keeps a list of its active symbols so the binary pass only visits live cells
+
+#include "InsideScorer.h"
+#include "madios/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+const double minus_infinity = -std::numeric_limits<double>::infinity();
+
+// log(exp(a) + exp(b)) without leaving log space
+inline double logAdd(double a, double b)
+{
+    if(a == minus_infinity) return b;
+    if(b == minus_infinity) return a;
+    return (a > b) ? a + std::log1p(std::exp(b - a)) : b + std::log1p(std::exp(a - b));
+}
+
+}  // namespace
+
+/**
+ * @brief Binarize a grammar for scoring.
+ * @param grammar The grammar
+ */
+InsideScorer::InsideScorer(const PCFG &grammar)
+{
+    madios::Logger::trace("Entering InsideScorer constructor");
+    start_symbol = grammar.startSymbol();
+    if(start_symbol == PCFG::npos)
+        throw std::invalid_argument("InsideScorer: grammar has no start symbol S");
+
+    num_symbols = grammar.symbolCount();
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+        if(!grammar.isNonterminal(id))
+            terminals.emplace(grammar.symbolName(id), id);
+
+    // right-binarize: A -> X1 X2 ... Xn becomes A -> X1 @(X2..Xn), @(X2..Xn) -> X2 @(X3..Xn), ...
+    struct Binary { unsigned int parent, left, right; double logProbability; };
+    vector<Binary> binaries;
+    std::map<vector<unsigned int>, unsigned int> suffixes;
+    for(const auto &rule : grammar.rules())
+    {
+        if(rule.probability <= 0.0)
+            continue;
+        double log_probability = std::log(rule.probability);
+        if(rule.rhs.size() == 1)
+        {
+            unary_rules.push_back(UnaryRule{rule.lhs, rule.rhs[0], log_probability});
+            continue;
+        }
+        unsigned int parent = rule.lhs;
+        for(unsigned int k = 0; k + 2 < rule.rhs.size(); k++)
+        {
+            vector<unsigned int> suffix(rule.rhs.begin() + k + 1, rule.rhs.end());
+            auto found = suffixes.find(suffix);
+            bool is_new = (found == suffixes.end());
+            unsigned int right = is_new ? num_symbols++ : found->second;
+            if(is_new)
+                suffixes.emplace(suffix, right);
+            binaries.push_back(Binary{parent, rule.rhs[k], right, (k == 0) ? log_probability : 0.0});
+            if(!is_new)
+            {
+                parent = PCFG::npos;  // the rest of this suffix is already binarized
+                break;
+            }
+            parent = right;
+        }
+        if(parent != PCFG::npos)
+            binaries.push_back(Binary{parent, rule.rhs[rule.rhs.size() - 2], rule.rhs.back(), (rule.rhs.size() == 2) ? log_probability : 0.0});
+    }
+
+    // group binary rules by left child
+    binary_begin.assign(num_symbols + 1, 0);
+    for(const auto &b : binaries)
+        binary_begin[b.left + 1]++;
+    for(unsigned int s = 0; s < num_symbols; s++)
+        binary_begin[s + 1] += binary_begin[s];
+    binary_rules.resize(binaries.size());
+    vector<unsigned int> fill(binary_begin.begin(), binary_begin.end() - 1);
+    for(const auto &b : binaries)
+        binary_rules[fill[b.left]++] = BinaryRule{b.parent, b.right, b.logProbability};
+
+    // topological order of the unary graph (Kahn), children first
+    vector<unsigned int> pending(num_symbols, 0);
+    vector<vector<unsigned int> > parents_of(num_symbols);
+    for(const auto &u : unary_rules)
+    {
+        pending[u.parent]++;
+        parents_of[u.child].push_back(u.parent);
+    }
+    vector<unsigned int> rank(num_symbols, 0);
+    vector<unsigned int> ready;
+    for(unsigned int s = 0; s < num_symbols; s++)
+        if(pending[s] == 0)
+            ready.push_back(s);
+    unsigned int ranked = 0;
+    while(!ready.empty())
+    {
+        unsigned int s = ready.back();
+        ready.pop_back();
+        rank[s] = ranked++;
+        for(unsigned int parent : parents_of[s])
+            if(--pending[parent] == 0)
+                ready.push_back(parent);
+    }
+    if(ranked != num_symbols)
+        throw std::runtime_error("InsideScorer: grammar has a cycle of unary rules");
+    std::stable_sort(unary_rules.begin(), unary_rules.end(), [&rank](const UnaryRule &a, const UnaryRule &b) {
+        return rank[a.child] < rank[b.child];
+    });
+    madios::Logger::info("InsideScorer: " + std::to_string(binary_rules.size()) + " binary and " + std::to_string(unary_rules.size()) + " unary rules over " + std::to_string(num_symbols) + " symbols");
+}
+
+/**
+ * @brief Compute the log inside probability of a sentence under the start symbol.
+ * @param sentence The sentence tokens
+ * @return The log probability and parse status
+ */
+InsideScorer::Result InsideScorer::score(const vector<string> &sentence) const
+{
+    const unsigned int n = sentence.size();
+    if(n == 0)
+        return Result{minus_infinity, Status::Unparsed};
+    vector<unsigned int> words;
+    words.reserve(n);
+    for(const auto &token : sentence)
+    {
+        auto found = terminals.find(token);
+        if(found == terminals.end())
+            return Result{minus_infinity, Status::OutOfVocabulary};
+        words.push_back(found->second);
+    }
+
+    // span (i, i + length) lives at cell (length - 1) * n + i
+    vector<double> chart(static_cast<size_t>(n) * n * num_symbols, minus_infinity);
+    vector<vector<unsigned int> > active(static_cast<size_t>(n) * n);
+    auto cell = [&](unsigned int i, unsigned int length) { return static_cast<size_t>(length - 1) * n + i; };
+
+    for(unsigned int i = 0; i < n; i++)
+    {
+        size_t c = cell(i, 1);
+        chart[c * num_symbols + words[i]] = 0.0;
+        active[c].push_back(words[i]);
+        closeUnary(chart, active[c], c);
+    }
+    for(unsigned int length = 2; length <= n; length++)
+        for(unsigned int i = 0; i + length <= n; i++)
+        {
+            size_t c = cell(i, length);
+            double *target = &chart[c * num_symbols];
+            for(unsigned int split = 1; split < length; split++)
+            {
+                size_t left = cell(i, split);
+                const double *right_cell = &chart[cell(i + split, length - split) * num_symbols];
+                for(unsigned int b : active[left])
+                {
+                    double left_score = chart[left * num_symbols + b];
+                    for(unsigned int r = binary_begin[b]; r < binary_begin[b + 1]; r++)
+                    {
+                        const BinaryRule &rule = binary_rules[r];
+                        if(right_cell[rule.right] == minus_infinity)
+                            continue;
+                        if(target[rule.parent] == minus_infinity)
+                            active[c].push_back(rule.parent);
+                        target[rule.parent] = logAdd(target[rule.parent], left_score + right_cell[rule.right] + rule.logProbability);
+                    }
+                }
+            }
+            closeUnary(chart, active[c], c);
+        }
+
+    double log_probability = chart[cell(0, n) * num_symbols + start_symbol];
+    if(log_probability == minus_infinity)
+        return Result{minus_infinity, Status::Unparsed};
+    return Result{log_probability, Status::Parsed};
+}
+
+/**
+ * @brief Get the name of a status for reports.
+ * @param status The status
+ * @return "ok", "oov" or "unparsed"
+ */
+const char* InsideScorer::statusName(Status status)
+{
+    switch(status)
+    {
+        case Status::Parsed: return "ok";
+        case Status::OutOfVocabulary: return "oov";
+        default: return "unparsed";
+    }
+}
+
+// InsideScorer::closeUnary
+// Apply all unary rules to one chart cell, children before parents.
+void InsideScorer::closeUnary(vector<double> &chart, vector<unsigned int> &active, size_t c) const
+{
+    if(active.empty())
+        return;
+    double *scores = &chart[c * num_symbols];
+    for(const auto &rule : unary_rules)
+    {
+        if(scores[rule.child] == minus_infinity)
+            continue;
+        if(scores[rule.parent] == minus_infinity)
+            active.push_back(rule.parent);
+        scores[rule.parent] = logAdd(scores[rule.parent], scores[rule.child] + rule.logProbability);
+    }
+}
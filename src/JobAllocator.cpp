@@ -0,0 +1,89 @@
+// File: JobAllocator.cpp
+// Purpose: Replaces the global allocation functions so that allocations are charged to JobMemory budgets.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Replace the global operator new/delete (plain, array, nothrow and aligned forms) with
+//     malloc/free, charging block sizes to the current thread's budget
+//
+// Design notes:
+//   - Linked into the madios executable, not into madioslib, so that programs embedding the library
+//     keep their own allocator
+//   - Block sizes come from malloc_usable_size, so sized and unsized deletes are credited alike
+
+#include "JobMemory.h"
+
+#include <malloc.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Utility: allocate and charge a block; nullptr if malloc fails or the budget refuses it.
+void* allocate(std::size_t bytes, std::size_t alignment)
+{
+    if(bytes == 0)
+        bytes = 1;
+    void *p;
+    if(alignment > alignof(std::max_align_t))
+        p = aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+    else
+        p = std::malloc(bytes);
+    if((p != nullptr) && JobMemory::active() && !JobMemory::charge(malloc_usable_size(p)))
+    {
+        std::free(p);
+        return nullptr;
+    }
+    return p;
+}
+
+// Utility: allocate for a throwing operator new, calling the new-handler as the standard requires.
+void* allocateOrThrow(std::size_t bytes, std::size_t alignment)
+{
+    while(true)
+    {
+        void *p = allocate(bytes, alignment);
+        if(p != nullptr)
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        JobMemory *budget = JobMemory::current();
+        if((handler == nullptr) || (budget != nullptr && budget->exceeded()))
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+// Utility: credit and free a block.
+void release(void *p)
+{
+    if(p == nullptr)
+        return;
+    if(JobMemory::active())
+        JobMemory::credit(malloc_usable_size(p));
+    std::free(p);
+}
+
+}  // namespace
+
+void* operator new(std::size_t bytes) { return allocateOrThrow(bytes, 0); }
+void* operator new[](std::size_t bytes) { return allocateOrThrow(bytes, 0); }
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept { return allocate(bytes, 0); }
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept { return allocate(bytes, 0); }
+void* operator new(std::size_t bytes, std::align_val_t alignment) { return allocateOrThrow(bytes, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t bytes, std::align_val_t alignment) { return allocateOrThrow(bytes, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(bytes, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(bytes, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void *p) noexcept { release(p); }
+void operator delete[](void *p) noexcept { release(p); }
+void operator delete(void *p, std::size_t) noexcept { release(p); }
+void operator delete[](void *p, std::size_t) noexcept { release(p); }
+void operator delete(void *p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void *p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void *p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { release(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
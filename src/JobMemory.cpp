@@ -0,0 +1,105 @@
+// File: JobMemory.cpp
+// Purpose: Implements the JobMemory class, the allocation budget of a job and the threads it starts.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Keep the budget of the current thread in a thread-local pointer
+//   - Charge and credit blocks to it for the allocation functions in JobAllocator.cpp
+//
+// Design notes:
+//   - Counters are atomic, since the threads a job starts share its budget (JobMemory::Attach)
+//   - A thread without a budget pays one thread-local load per allocation
+
+#include "JobMemory.h"
+
+namespace {
+
+thread_local JobMemory *thread_budget = nullptr;
+
+}  // namespace
+
+/**
+ * @brief Open a budget on the current thread.
+ * @param limit Largest net number of bytes (0: unlimited)
+ */
+JobMemory::JobMemory(std::size_t limit)
+: limit(limit), previous(thread_budget)
+{
+    thread_budget = this;
+}
+
+/**
+ * @brief Close the budget and restore the thread's previous one.
+ */
+JobMemory::~JobMemory()
+{
+    thread_budget = previous;
+}
+
+/**
+ * @brief Charge the calling thread's allocations to a budget opened on another thread.
+ * @param budget The budget, or nullptr to leave the thread uncounted
+ */
+JobMemory::Attach::Attach(JobMemory *budget)
+: previous(thread_budget)
+{
+    thread_budget = budget;
+}
+
+/**
+ * @brief Detach the thread and restore its previous budget.
+ */
+JobMemory::Attach::~Attach()
+{
+    thread_budget = previous;
+}
+
+/**
+ * @brief Charge an allocation to the current thread's budget.
+ * @param bytes Size of the block
+ * @return False if the block must be refused
+ */
+bool JobMemory::charge(std::size_t bytes)
+{
+    JobMemory *budget = thread_budget;
+    if(budget == nullptr)
+        return true;
+    long long after = budget->net.fetch_add(static_cast<long long>(bytes)) + static_cast<long long>(bytes);
+    if((budget->limit > 0) && (after > static_cast<long long>(budget->limit)) && !budget->refused.exchange(true))
+    {
+        budget->net.fetch_sub(static_cast<long long>(bytes));
+        return false;
+    }
+    std::size_t peak = budget->peak_bytes.load();
+    while((after > static_cast<long long>(peak)) && !budget->peak_bytes.compare_exchange_weak(peak, static_cast<std::size_t>(after)))
+        ;
+    return true;
+}
+
+/**
+ * @brief Credit a freed block to the current thread's budget.
+ * @param bytes Size of the block
+ */
+void JobMemory::credit(std::size_t bytes)
+{
+    if(thread_budget != nullptr)
+        thread_budget->net.fetch_sub(static_cast<long long>(bytes));
+}
+
+/**
+ * @brief Get the budget the current thread charges.
+ * @return The budget, or nullptr if allocations are not counted
+ */
+JobMemory* JobMemory::current()
+{
+    return thread_budget;
+}
+
+/**
+ * @brief Check whether the current thread has a budget.
+ * @return True if allocations are being counted
+ */
+bool JobMemory::active()
+{
+    return thread_budget != nullptr;
+}
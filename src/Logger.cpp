@@ -10,6 +10,8 @@
 //   - Uses a static mutex for thread safety
 //   - All log output is timestamped and level-tagged
 //   - Log level can be set globally
+//   - A thread can redirect its messages to another stream (setThreadSink); threads it starts may
+//     share that stream, so every write holds the lock
 
 #include "madios/Logger.h"
 #include "madios/BasicSymbol.h"
@@ -21,6 +23,7 @@ namespace madios {
 
 Logger::Level Logger::currentLevel = Logger::Level::INFO;
 std::mutex Logger::logMutex;
+thread_local std::ostream* Logger::threadSink = nullptr;
 
 /**
  * @brief Set the global log level for Logger output.
@@ -30,6 +33,22 @@ void Logger::setLevel(Level level) {
     currentLevel = level;
 }
 
+/**
+ * @brief Redirect the calling thread's messages.
+ * @param sink Stream for this thread's messages, or nullptr for stderr
+ */
+void Logger::setThreadSink(std::ostream* sink) {
+    threadSink = sink;
+}
+
+/**
+ * @brief Get the calling thread's sink.
+ * @return The stream for this thread's messages, or nullptr for stderr
+ */
+std::ostream* Logger::getThreadSink() {
+    return threadSink;
+}
+
 /**
  * @brief Log a trace-level message (for detailed debugging).
  * @param msg The message to log
@@ -82,11 +101,12 @@ void Logger::log(Level level, const std::string& msg) {
     localtime_s(&tm_buf, &now_c);
     std::tm* tm = &tm_buf;
 #else
-    std::tm* tm = std::localtime(&now_c);
+    std::tm* tm = localtime_r(&now_c, &tm_buf);
 #endif
     char timebuf[20];
     std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", tm);
-    std::cerr << "[" << timebuf << "] [" << levelStr << "] " << msg << std::endl;
+    std::ostream& out = (threadSink != nullptr) ? *threadSink : std::cerr;
+    out << "[" << timebuf << "] [" << levelStr << "] " << msg << std::endl;
 }
 
 } // namespace madios
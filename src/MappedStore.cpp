@@ -0,0 +1,218 @@
+// File: MappedStore.cpp
+// Purpose: Implements the MappedStore class, a memory resource backed by memory-mapped files for out-of-core graphs.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Create, map and unmap the backing files
+//   - Serve power-of-two blocks from segments, with a free list per size class
+//   - Forward access hints to madvise for ranges the store owns
+//
+// Design notes:
+//   - Every file is unlinked right after it is created and its descriptor closed right after it is
+//     mapped, so the store holds no descriptors and leaves nothing behind
+//   - A free block stores the next free block of its class in its first word
+
+#include "MappedStore.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+// Smallest block handed out (holds the free-list link and keeps 16-byte alignment).
+const std::size_t min_block = 16;
+
+// Utility: round up to a multiple of a power of two.
+std::size_t roundUp(std::size_t value, std::size_t multiple)
+{
+    return (value + multiple - 1) & ~(multiple - 1);
+}
+
+}  // namespace
+
+/**
+ * @brief Create a store and map its first segment.
+ * @param directory Directory for the backing files
+ * @param residentBudget Bytes of hot occurrence lists to keep resident
+ * @param segmentSize Size of each segment in bytes
+ */
+MappedStore::MappedStore(const std::string &directory, std::size_t residentBudget, std::size_t segmentSize)
+: directory(directory), resident_budget(residentBudget)
+{
+    page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    segment_size = roundUp(std::max(segmentSize, 4 * page_size), page_size);
+    free_lists.assign(sizeClass(segment_size, 1) + 1, nullptr);
+    segment = mapFile(segment_size);
+    if(segment == nullptr)
+        throw std::runtime_error("MappedStore: cannot create a backing file in '" + directory + "'");
+}
+
+/**
+ * @brief Unmap every segment and large block.
+ */
+MappedStore::~MappedStore()
+{
+    for(const auto &mapping : mappings)
+        munmap(const_cast<char *>(mapping.first), mapping.second);
+}
+
+/**
+ * @brief Pass an access hint for a range of memory allocated from this store.
+ * @param data Start of the range
+ * @param bytes Length of the range
+ * @param access The expected use
+ */
+void MappedStore::advise(const void *data, std::size_t bytes, Access access) const
+{
+    if((bytes == 0) || !owns(data))
+        return;
+    std::size_t address = reinterpret_cast<std::size_t>(data);
+    if(access == Access::WillNeed)
+    {
+        // whole pages around the range
+        std::size_t first = address & ~(page_size - 1);
+        madvise(reinterpret_cast<void *>(first), roundUp(address + bytes, page_size) - first, MADV_WILLNEED);
+    }
+    else
+    {
+#ifdef MADV_COLD
+        // only pages entirely inside the range, so that neighbouring blocks are not cooled
+        std::size_t first = roundUp(address, page_size);
+        std::size_t last = (address + bytes) & ~(page_size - 1);
+        if(last > first)
+            madvise(reinterpret_cast<void *>(first), last - first, MADV_COLD);
+#endif
+    }
+}
+
+/**
+ * @brief Check whether a pointer lies in memory mapped by this store.
+ * @param data The pointer
+ * @return True if the store owns it
+ */
+bool MappedStore::owns(const void *data) const
+{
+    const char *p = static_cast<const char *>(data);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto mapping = mappings.upper_bound(p);
+    if(mapping == mappings.begin())
+        return false;
+    --mapping;
+    return p < mapping->first + mapping->second;
+}
+
+/**
+ * @brief Get the total size of all mappings.
+ * @return The mapped bytes
+ */
+std::size_t MappedStore::mappedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return mapped;
+}
+
+/**
+ * @brief Get the bytes in blocks currently allocated.
+ * @return The allocated bytes
+ */
+std::size_t MappedStore::allocatedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return allocated;
+}
+
+// MappedStore::do_allocate
+// Large blocks get their own mapping; others come from their class's free list or the current segment.
+void* MappedStore::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    unsigned int cls = sizeClass(bytes, alignment);
+    std::size_t block = std::size_t(1) << cls;
+    std::lock_guard<std::mutex> lock(mutex);
+    if(block > segment_size / 4)
+    {
+        char *p = mapFile(roundUp(block, page_size));
+        if(p == nullptr)
+            throw std::bad_alloc();
+        allocated += block;
+        return p;
+    }
+    if(free_lists[cls] != nullptr)
+    {
+        void *p = free_lists[cls];
+        free_lists[cls] = *static_cast<void **>(p);
+        allocated += block;
+        return p;
+    }
+    std::size_t offset = roundUp(used, std::min(block, page_size));
+    if(offset + block > segment_size)
+    {
+        char *fresh = mapFile(segment_size);
+        if(fresh == nullptr)
+            throw std::bad_alloc();
+        segment = fresh;
+        offset = 0;
+    }
+    used = offset + block;
+    allocated += block;
+    return segment + offset;
+}
+
+// MappedStore::do_deallocate
+// Unmap a large block, or push a block onto its class's free list.
+void MappedStore::do_deallocate(void *p, std::size_t bytes, std::size_t alignment)
+{
+    unsigned int cls = sizeClass(bytes, alignment);
+    std::size_t block = std::size_t(1) << cls;
+    std::lock_guard<std::mutex> lock(mutex);
+    allocated -= block;
+    if(block > segment_size / 4)
+    {
+        auto mapping = mappings.find(static_cast<const char *>(p));
+        if(mapping != mappings.end())
+        {
+            munmap(p, mapping->second);
+            mapped -= mapping->second;
+            mappings.erase(mapping);
+        }
+        return;
+    }
+    *static_cast<void **>(p) = free_lists[cls];
+    free_lists[cls] = p;
+}
+
+// MappedStore::mapFile
+// Create an unlinked file of the given size in the directory and map it shared; nullptr on failure.
+// Called with the mutex held (or from the constructor).
+char* MappedStore::mapFile(std::size_t bytes)
+{
+    std::string name = directory + "/madios-store-XXXXXX";
+    int fd = mkstemp(&name[0]);
+    if(fd < 0)
+        return nullptr;
+    unlink(name.c_str());
+    void *p = MAP_FAILED;
+    if(ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+        p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(p == MAP_FAILED)
+        return nullptr;
+    mappings[static_cast<const char *>(p)] = bytes;
+    mapped += bytes;
+    return static_cast<char *>(p);
+}
+
+// MappedStore::sizeClass
+// Index k of the smallest block 2^k that holds the request with its alignment.
+unsigned int MappedStore::sizeClass(std::size_t bytes, std::size_t alignment)
+{
+    std::size_t needed = std::max(std::max(bytes, alignment), min_block);
+    unsigned int cls = 0;
+    while((std::size_t(1) << cls) < needed)
+        cls++;
+    return cls;
+}
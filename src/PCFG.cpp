@@ -0,0 +1,264 @@
+// File: PCFG.cpp
+// Purpose: Implements the PCFG class, an in-memory form of the grammar written by RDSGraph::convert2PCFG.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Parse the "LHS -> RHS [probability]" text format
+//   - Intern symbols and index rules by left-hand side
+//   - Write and read the binary snapshot form
+//
+// Design notes:
+//   - Nonterminals are exactly the symbols that appear on a left-hand side
+//   - Malformed input is reported with a std::runtime_error naming the line
+//   - Snapshots use explicit little-endian encoding so they are portable between hosts
+
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "MiscUtils.h"
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+const unsigned int PCFG::npos = static_cast<unsigned int>(-1);
+const unsigned int PCFG::snapshotVersion = 1;
+
+static const char snapshot_magic[8] = {'M', 'A', 'D', 'I', 'O', 'S', 'G', '\n'};
+
+// Utility: Write an unsigned integer as 8 little-endian bytes
+static void writeWord(std::ostream &out, std::uint64_t value)
+{
+    char bytes[8];
+    for(int i = 0; i < 8; i++)
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.write(bytes, 8);
+}
+
+// Utility: Read an unsigned integer written by writeWord
+static std::uint64_t readWord(std::istream &in)
+{
+    unsigned char bytes[8];
+    if(!in.read(reinterpret_cast<char *>(bytes), 8))
+        throw std::runtime_error("PCFG::readSnapshot: truncated snapshot");
+    std::uint64_t value = 0;
+    for(int i = 7; i >= 0; i--)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+/**
+ * @brief Default constructor. Creates an empty grammar.
+ */
+PCFG::PCFG()
+{
+}
+
+/**
+ * @brief Parse a grammar in the convert2PCFG text format.
+ * @param in Input stream to read rules from
+ * @return The parsed grammar
+ */
+PCFG PCFG::read(std::istream &in)
+{
+    PCFG grammar;
+    string line;
+    unsigned int line_number = 0;
+    while(std::getline(in, line))
+    {
+        line_number++;
+        vector<string> tokens = tokenise(line);
+        if(tokens.empty())
+            continue;
+
+        // LHS -> RHS... [p]
+        const string &last = tokens.back();
+        if((tokens.size() < 4) || (tokens[1] != "->") || (last.size() < 3) || (last.front() != '[') || (last.back() != ']'))
+            throw std::runtime_error("PCFG::read: malformed rule on line " + std::to_string(line_number) + ": " + line);
+        double probability = 0.0;
+        try {
+            probability = std::stod(last.substr(1, last.size() - 2));
+        } catch (const std::exception &) {
+            throw std::runtime_error("PCFG::read: bad probability on line " + std::to_string(line_number) + ": " + line);
+        }
+        grammar.addRule(tokens[0], vector<string>(tokens.begin() + 2, tokens.end() - 1), probability);
+    }
+    return grammar;
+}
+
+/**
+ * @brief Write the grammar in the convert2PCFG text format, one rule per line in rule order.
+ * @param out Output stream
+ */
+void PCFG::write(std::ostream &out) const
+{
+    for(const auto &rule : the_rules)
+    {
+        out << names[rule.lhs] << " ->";
+        for(unsigned int symbol : rule.rhs)
+            out << " " << names[symbol];
+        out << " [" << rule.probability << "]" << std::endl;
+    }
+}
+
+/**
+ * @brief Write the grammar as a binary snapshot.
+ * @param out Output stream
+ */
+void PCFG::writeSnapshot(std::ostream &out) const
+{
+    out.write(snapshot_magic, sizeof(snapshot_magic));
+    writeWord(out, snapshotVersion);
+    writeWord(out, names.size());
+    for(const auto &name : names)
+    {
+        writeWord(out, name.size());
+        out.write(name.data(), name.size());
+    }
+    writeWord(out, the_rules.size());
+    for(const auto &rule : the_rules)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &rule.probability, sizeof(bits));
+        writeWord(out, rule.lhs);
+        writeWord(out, bits);
+        writeWord(out, rule.rhs.size());
+        for(unsigned int symbol : rule.rhs)
+            writeWord(out, symbol);
+    }
+}
+
+/**
+ * @brief Read a grammar written by writeSnapshot.
+ * @param in Input stream
+ * @return The grammar
+ */
+PCFG PCFG::readSnapshot(std::istream &in)
+{
+    char magic[sizeof(snapshot_magic)];
+    if(!in.read(magic, sizeof(magic)) || (std::memcmp(magic, snapshot_magic, sizeof(magic)) != 0))
+        throw std::runtime_error("PCFG::readSnapshot: not a grammar snapshot");
+    std::uint64_t version = readWord(in);
+    if(version != snapshotVersion)
+        throw std::runtime_error("PCFG::readSnapshot: unsupported snapshot version " + std::to_string(version));
+
+    PCFG grammar;
+    std::uint64_t symbol_count = readWord(in);
+    for(std::uint64_t id = 0; id < symbol_count; id++)
+    {
+        std::uint64_t length = readWord(in);
+        if(length > (std::uint64_t(1) << 24))
+            throw std::runtime_error("PCFG::readSnapshot: bad symbol name length");
+        string name(length, '\0');
+        if(!in.read(&name[0], name.size()))
+            throw std::runtime_error("PCFG::readSnapshot: truncated snapshot");
+        if(grammar.intern(name) != id)
+            throw std::runtime_error("PCFG::readSnapshot: duplicate symbol " + name);
+    }
+    std::uint64_t rule_count = readWord(in);
+    for(std::uint64_t r = 0; r < rule_count; r++)
+    {
+        Rule rule;
+        std::uint64_t lhs = readWord(in);
+        std::uint64_t bits = readWord(in);
+        std::uint64_t length = readWord(in);
+        if((lhs >= symbol_count) || (length == 0))
+            throw std::runtime_error("PCFG::readSnapshot: bad rule " + std::to_string(r));
+        rule.lhs = lhs;
+        std::memcpy(&rule.probability, &bits, sizeof(bits));
+        for(std::uint64_t k = 0; k < length; k++)
+        {
+            std::uint64_t symbol = readWord(in);
+            if(symbol >= symbol_count)
+                throw std::runtime_error("PCFG::readSnapshot: bad symbol in rule " + std::to_string(r));
+            rule.rhs.push_back(symbol);
+        }
+        grammar.by_lhs[rule.lhs].push_back(grammar.the_rules.size());
+        grammar.the_rules.push_back(rule);
+    }
+    return grammar;
+}
+
+/**
+ * @brief Read a grammar in text or snapshot form.
+ * @param in Input stream
+ * @return The grammar
+ */
+PCFG PCFG::load(std::istream &in)
+{
+    char magic[sizeof(snapshot_magic)];
+    std::streampos start = in.tellg();
+    bool is_snapshot = in.read(magic, sizeof(magic)) && (std::memcmp(magic, snapshot_magic, sizeof(magic)) == 0);
+    in.clear();
+    in.seekg(start);
+    return is_snapshot ? readSnapshot(in) : read(in);
+}
+
+/**
+ * @brief Build the grammar that convert2PCFG describes for a learned graph.
+ * @param graph The distilled graph
+ * @return The grammar
+ */
+PCFG PCFG::fromGraph(const RDSGraph &graph)
+{
+    return graph.toPCFG();
+}
+
+/**
+ * @brief Add a rule, interning its symbols.
+ * @param lhs Left-hand side symbol name
+ * @param rhs Right-hand side symbol names
+ * @param probability Rule probability
+ */
+void PCFG::addRule(const string &lhs, const vector<string> &rhs, double probability)
+{
+    if (rhs.empty()) {
+        throw std::invalid_argument("PCFG::addRule: empty right-hand side for " + lhs);
+    }
+    Rule rule;
+    rule.lhs = intern(lhs);
+    for(const auto &symbol : rhs)
+        rule.rhs.push_back(intern(symbol));
+    rule.probability = probability;
+    by_lhs[rule.lhs].push_back(the_rules.size());
+    the_rules.push_back(rule);
+}
+
+/**
+ * @brief Look up a symbol id by name.
+ * @param name The symbol name
+ * @return The symbol id, or npos if unknown
+ */
+unsigned int PCFG::symbolId(const string &name) const
+{
+    auto found = ids.find(name);
+    return (found == ids.end()) ? npos : found->second;
+}
+
+/**
+ * @brief Check whether a symbol is a significant pattern nonterminal.
+ * @param id The symbol id
+ * @return True if the symbol is a nonterminal named "P<n>"
+ */
+bool PCFG::isPattern(unsigned int id) const
+{
+    const string &name = names[id];
+    return isNonterminal(id) && (name.size() > 1) && (name[0] == 'P') && (name.find_first_not_of("0123456789", 1) == string::npos);
+}
+
+// PCFG::intern
+// Return the id of a symbol, adding it to the table if it is new.
+unsigned int PCFG::intern(const string &name)
+{
+    auto found = ids.find(name);
+    if(found != ids.end())
+        return found->second;
+    unsigned int id = names.size();
+    names.push_back(name);
+    by_lhs.push_back(vector<unsigned int>());
+    ids.emplace(name, id);
+    return id;
+}
@@ -0,0 +1,72 @@
+// File: PathSet.cpp
+// Purpose: Implements the PathSet class, the set of search paths a node occurs on.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Build the set from a node's occurrence list in the sparse or the dense form
+//   - Intersect the sets of the nodes of a segment
+//
+// Design notes:
+//   - Occurrence lists are in corpus order, which differs from slot order after a relayout, so the
+//     sparse form is sorted after collection
+//   - Intersection walks the smallest set and probes the others, so its cost follows the rarest node
+
+#include "PathSet.h"
+
+#include <algorithm>
+
+/**
+ * @brief Rebuild the set from an occurrence list.
+ * @param occurrences Occurrences (path, position) of a node
+ * @param pathCount Number of path slots in the graph
+ */
+void PathSet::assign(const ConnectionList &occurrences, unsigned int pathCount)
+{
+    ids.clear();
+    words.clear();
+    // occurrences on one path are adjacent
+    for(std::size_t i = 0; i < occurrences.size(); i++)
+        if((i == 0) || (occurrences[i].first != occurrences[i - 1].first))
+            ids.push_back(occurrences[i].first);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    count = ids.size();
+    dense = (count * 32 > pathCount);
+    if(dense)
+    {
+        words.assign((static_cast<std::size_t>(pathCount) + 63) / 64, 0);
+        for(unsigned int path : ids)
+            words[path >> 6] |= std::uint64_t(1) << (path & 63);
+        std::vector<unsigned int>().swap(ids);
+    }
+    else
+        ids.shrink_to_fit();
+}
+
+/**
+ * @brief Intersect sets, walking the smallest and probing the others.
+ * @param sets The sets (at least one); reordered by size
+ * @param out Receives the paths in all sets, in increasing order
+ */
+void PathSet::intersect(std::pmr::vector<const PathSet*> &sets, std::pmr::vector<unsigned int> &out)
+{
+    out.clear();
+    std::sort(sets.begin(), sets.end(), [](const PathSet *a, const PathSet *b) { return a->count < b->count; });
+    const PathSet &smallest = *sets[0];
+    auto keep = [&](unsigned int path) {
+        for(std::size_t s = 1; s < sets.size(); s++)
+            if(!sets[s]->contains(path))
+                return;
+        out.push_back(path);
+    };
+    if(!smallest.dense)
+    {
+        out.reserve(smallest.count);
+        for(unsigned int path : smallest.ids)
+            keep(path);
+        return;
+    }
+    for(std::size_t w = 0; w < smallest.words.size(); w++)
+        for(std::uint64_t bits = smallest.words[w]; bits != 0; bits &= bits - 1)
+            keep(static_cast<unsigned int>(w * 64 + __builtin_ctzll(bits)));
+}
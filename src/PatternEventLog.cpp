@@ -0,0 +1,105 @@
+// File: PatternEventLog.cpp
+// Purpose: Implements the PatternEventLog class, a JSON Lines stream of patterns learned during distillation.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Queue events from the distillation thread
+//   - Serialize and write them on a background thread, flushing after each batch
+//
+// Design notes:
+//   - The writer swaps the whole queue out under the lock, so record() never waits on file I/O
+//   - The destructor drains the queue before joining, so no recorded event is lost
+
+#include "PatternEventLog.h"
+#include "utils/json.hpp"
+
+#include <stdexcept>
+
+/**
+ * @brief Open the log file and start the writer thread.
+ * @param filename Output file
+ */
+PatternEventLog::PatternEventLog(const std::string &filename)
+: out(filename)
+{
+    if (!out.is_open()) {
+        throw std::runtime_error("PatternEventLog: cannot open " + filename);
+    }
+    writer = std::thread(&PatternEventLog::run, this);
+}
+
+/**
+ * @brief Write all queued events, then stop the writer thread.
+ */
+PatternEventLog::~PatternEventLog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+/**
+ * @brief Queue an event for writing.
+ * @param event The event
+ */
+void PatternEventLog::record(PatternEvent event)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(event));
+        recorded++;
+    }
+    wake.notify_one();
+}
+
+/**
+ * @brief Block until every event recorded so far has been written.
+ */
+void PatternEventLog::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned long long target = recorded;
+    drained.wait(lock, [this, target]() { return written >= target; });
+}
+
+// PatternEventLog::run
+// Writer thread: serialize queued events in batches until closed and drained.
+void PatternEventLog::run()
+{
+    std::vector<PatternEvent> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return closing || !pending.empty(); });
+            if (pending.empty() && closing)
+                break;
+            batch.swap(pending);
+        }
+        for (const auto &event : batch) {
+            nlohmann::json j;
+            j["event"] = event.type;
+            j["iteration"] = event.iteration;
+            if (event.type == "SP" || event.type == "EC") {
+                j["id"] = event.id;
+                j["name"] = event.name;
+                j["members"] = event.members;
+                j["p_values"] = {event.leftPValue, event.rightPValue};
+                j["occurrences"] = event.occurrences;
+            } else {
+                j["patterns"] = event.patterns;
+                j["classes"] = event.classes;
+            }
+            out << j.dump() << '\n';
+        }
+        out.flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            written += batch.size();
+        }
+        drained.notify_all();
+        batch.clear();
+    }
+}
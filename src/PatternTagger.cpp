@@ -0,0 +1,308 @@
+// File: PatternTagger.cpp
+// Purpose: Implements the PatternTagger class, which marks learned significant patterns in new text.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Expand every SP of a grammar into its terminal strings (ECs become alternative sets)
+//   - Compile the strings into a token-level Aho-Corasick automaton
+//   - Tag sentences with leftmost-longest, non-overlapping pattern spans
+//
+// Design notes:
+//   - Expansion sets are memoised per symbol and capped; over-cap (or recursive) patterns are skipped
+//   - When several patterns derive the same string, the one whose rule comes last in the grammar wins
+//   - Unknown tokens reset the automaton to the root, since no pattern can contain them
+
+#include "PatternTagger.h"
+#include "madios/Logger.h"
+
+#include <algorithm>
+#include <queue>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+
+const unsigned int none = static_cast<unsigned int>(-1);
+
+// Memoised, capped terminal expansions of grammar symbols (in word ids)
+class ExpansionTable
+{
+    public:
+        ExpansionTable(const PCFG &grammar, const vector<unsigned int> &word_of_symbol, unsigned int cap)
+        : grammar(grammar), word_of_symbol(word_of_symbol), cap(cap),
+          state(grammar.symbolCount(), 0), expansions(grammar.symbolCount())
+        {}
+
+        // returns nullptr if the symbol has more than cap expansions or is recursive
+        const vector<vector<unsigned int> >* expand(unsigned int symbol)
+        {
+            if(state[symbol] == 2) return &expansions[symbol];
+            if(state[symbol] != 0) return nullptr;  // 1 = in progress (recursion), 3 = overflow
+            state[symbol] = 1;
+            vector<vector<unsigned int> > &result = expansions[symbol];
+            if(!grammar.isNonterminal(symbol))
+                result.push_back(vector<unsigned int>(1, word_of_symbol[symbol]));
+            for(unsigned int r : grammar.rulesFor(symbol))
+            {
+                vector<vector<unsigned int> > product(1);
+                for(unsigned int child : grammar.rules()[r].rhs)
+                {
+                    const vector<vector<unsigned int> > *tails = expand(child);
+                    if((tails == nullptr) || (product.size() * tails->size() > cap))
+                        return overflow(symbol);
+                    vector<vector<unsigned int> > extended;
+                    extended.reserve(product.size() * tails->size());
+                    for(const auto &head : product)
+                        for(const auto &tail : *tails)
+                        {
+                            extended.push_back(head);
+                            extended.back().insert(extended.back().end(), tail.begin(), tail.end());
+                        }
+                    product.swap(extended);
+                }
+                result.insert(result.end(), product.begin(), product.end());
+                if(result.size() > cap)
+                    return overflow(symbol);
+            }
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+            state[symbol] = 2;
+            return &result;
+        }
+
+    private:
+        const vector<vector<unsigned int> >* overflow(unsigned int symbol)
+        {
+            expansions[symbol].clear();
+            state[symbol] = 3;
+            return nullptr;
+        }
+
+        const PCFG &grammar;
+        const vector<unsigned int> &word_of_symbol;
+        unsigned int cap;
+        vector<unsigned char> state;
+        vector<vector<vector<unsigned int> > > expansions;
+};
+
+}  // namespace
+
+/**
+ * @brief Compile the significant patterns of a grammar into an Aho-Corasick automaton.
+ * @param grammar The grammar
+ * @param maxExpansions Maximum number of terminal strings per symbol
+ */
+PatternTagger::PatternTagger(const PCFG &grammar, unsigned int maxExpansions)
+{
+    madios::Logger::trace("Entering PatternTagger constructor");
+    // vocabulary: the terminal symbols of the grammar
+    vector<unsigned int> word_of_symbol(grammar.symbolCount(), none);
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+    {
+        names.push_back(grammar.symbolName(id));
+        if(!grammar.isNonterminal(id))
+        {
+            word_of_symbol[id] = words.size();
+            words.push_back(grammar.symbolName(id));
+        }
+    }
+    for(unsigned int w = 0; w < words.size(); w++)  // words is complete, so the views stay valid
+        word_ids.emplace(string_view(words[w]), w);
+
+    // build the trie over all pattern expansions, in rule order
+    vector<vector<std::pair<unsigned int, unsigned int> > > children(1);
+    output.assign(1, none);
+    depth.assign(1, 0);
+    ExpansionTable table(grammar, word_of_symbol, maxExpansions);
+    vector<bool> seen(grammar.symbolCount(), false);
+    for(const auto &rule : grammar.rules())
+    {
+        if(!grammar.isPattern(rule.lhs) || seen[rule.lhs])
+            continue;
+        seen[rule.lhs] = true;
+        const vector<vector<unsigned int> > *expansions = table.expand(rule.lhs);
+        if(expansions == nullptr)
+        {
+            skipped_patterns++;
+            madios::Logger::warn("PatternTagger: skipping " + names[rule.lhs] + " (more than " + std::to_string(maxExpansions) + " expansions)");
+            continue;
+        }
+        compiled_patterns++;
+        for(const auto &expansion : *expansions)
+        {
+            unsigned int state = 0;
+            for(unsigned int word : expansion)
+            {
+                auto &kids = children[state];
+                auto found = std::find_if(kids.begin(), kids.end(), [word](const std::pair<unsigned int, unsigned int> &kid) { return kid.first == word; });
+                if(found != kids.end())
+                    state = found->second;
+                else
+                {
+                    unsigned int child = depth.size();
+                    kids.push_back(std::make_pair(word, child));
+                    children.push_back(vector<std::pair<unsigned int, unsigned int> >());
+                    output.push_back(none);
+                    depth.push_back(depth[state] + 1);
+                    state = child;
+                }
+            }
+            output[state] = rule.lhs;
+        }
+    }
+
+    // flatten the trie: dense root row, sorted child ranges elsewhere
+    unsigned int num_states = depth.size();
+    root_next.assign(words.size(), 0);
+    for(const auto &kid : children[0])
+        root_next[kid.first] = kid.second;
+    child_begin.assign(num_states + 1, 0);
+    for(unsigned int s = 0; s < num_states; s++)
+    {
+        std::sort(children[s].begin(), children[s].end());
+        child_begin[s + 1] = child_begin[s] + children[s].size();
+        for(const auto &kid : children[s])
+        {
+            child_word.push_back(kid.first);
+            child_state.push_back(kid.second);
+        }
+    }
+
+    // failure and dictionary links, breadth first
+    fail.assign(num_states, 0);
+    dict.assign(num_states, none);
+    std::queue<unsigned int> queue;
+    for(const auto &kid : children[0])
+        queue.push(kid.second);
+    while(!queue.empty())
+    {
+        unsigned int s = queue.front();
+        queue.pop();
+        for(const auto &kid : children[s])
+        {
+            unsigned int f = fail[s];
+            while((f != 0) && (next(f, kid.first) == 0))
+                f = fail[f];
+            unsigned int target = next(f, kid.first);
+            fail[kid.second] = (target == kid.second) ? 0 : target;
+            dict[kid.second] = (output[fail[kid.second]] != none) ? fail[kid.second] : dict[fail[kid.second]];
+            queue.push(kid.second);
+        }
+    }
+    madios::Logger::info("PatternTagger: " + std::to_string(compiled_patterns) + " patterns compiled into " + std::to_string(num_states) + " states, " + std::to_string(skipped_patterns) + " skipped");
+}
+
+/**
+ * @brief Find the maximal pattern spans in a sentence.
+ * @param tokens The sentence tokens
+ * @return Spans ordered by start position
+ */
+vector<PatternTagger::Span> PatternTagger::tag(const vector<string> &tokens) const
+{
+    vector<unsigned int> ids;
+    ids.reserve(tokens.size());
+    for(const auto &token : tokens)
+        ids.push_back(wordId(token));
+    return match(ids);
+}
+
+/**
+ * @brief Tag one line of text, appending the marked-up line to out.
+ * @param line The input line
+ * @param out Output string
+ */
+void PatternTagger::tagLine(const string &line, string &out) const
+{
+    vector<string_view> tokens;
+    vector<unsigned int> ids;
+    string_view rest(line);
+    while(true)
+    {
+        size_t begin = rest.find_first_not_of(" \t\r");
+        if(begin == string_view::npos) break;
+        size_t end = rest.find_first_of(" \t\r", begin);
+        tokens.push_back(rest.substr(begin, end - begin));
+        ids.push_back(wordId(tokens.back()));
+        if(end == string_view::npos) break;
+        rest.remove_prefix(end);
+    }
+
+    vector<Span> spans = match(ids);
+    size_t next_span = 0;
+    for(unsigned int i = 0; i < tokens.size(); i++)
+    {
+        if(i > 0) out.push_back(' ');
+        bool opens = (next_span < spans.size()) && (spans[next_span].start == i);
+        if(opens)
+        {
+            out.push_back('[');
+            out.append(names[spans[next_span].pattern]);
+            out.push_back(' ');
+        }
+        out.append(tokens[i].data(), tokens[i].size());
+        if((next_span < spans.size()) && (spans[next_span].start + spans[next_span].length - 1 == i))
+        {
+            out.push_back(']');
+            next_span++;
+        }
+    }
+}
+
+// PatternTagger::wordId
+// Map a token to its vocabulary id, or none for out-of-vocabulary tokens.
+unsigned int PatternTagger::wordId(string_view word) const
+{
+    auto found = word_ids.find(word);
+    return (found == word_ids.end()) ? none : found->second;
+}
+
+// PatternTagger::next
+// Goto function of the trie: the child of state on word, or 0 (root) if there is none.
+unsigned int PatternTagger::next(unsigned int state, unsigned int word) const
+{
+    if(state == 0)
+        return root_next[word];
+    auto first = child_word.begin() + child_begin[state];
+    auto last = child_word.begin() + child_begin[state + 1];
+    auto found = std::lower_bound(first, last, word);
+    if((found == last) || (*found != word))
+        return 0;
+    return child_state[found - child_word.begin()];
+}
+
+// PatternTagger::match
+// Run the automaton over a sentence and select leftmost-longest non-overlapping matches.
+vector<PatternTagger::Span> PatternTagger::match(const vector<unsigned int> &ids) const
+{
+    vector<Span> matches;
+    unsigned int state = 0;
+    for(unsigned int i = 0; i < ids.size(); i++)
+    {
+        unsigned int word = ids[i];
+        if(word == none)
+        {
+            state = 0;
+            continue;
+        }
+        while((state != 0) && (next(state, word) == 0))
+            state = fail[state];
+        state = next(state, word);
+        for(unsigned int s = (output[state] != none) ? state : dict[state]; s != none; s = dict[s])
+            matches.push_back(Span{i + 1 - depth[s], depth[s], output[s]});
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const Span &a, const Span &b) {
+        return (a.start < b.start) || ((a.start == b.start) && (a.length > b.length));
+    });
+    vector<Span> spans;
+    unsigned int covered = 0;
+    for(const auto &candidate : matches)
+        if(candidate.start >= covered)
+        {
+            spans.push_back(candidate);
+            covered = candidate.start + candidate.length;
+        }
+    return spans;
+}
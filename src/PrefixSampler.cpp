@@ -0,0 +1,348 @@
+// File: PrefixSampler.cpp
+// Purpose: Implements the PrefixSampler class, which samples completions of a token prefix from a frozen grammar.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Build first-terminal and reachability bit tables over the SP/EC DAG
+//   - Compute prefix probabilities, pruning units that cannot produce the remaining prefix words
+//   - Draw completions top-down, then sample the rest of the sentence freely
+//
+// Design notes:
+//   - inside(X, i) is a row over end positions j: the probability that X derives exactly words[i..j)
+//   - prefix(X, i) is the probability that X derives a string that starts with words[i..n) and
+//     produces the last prefix word itself; every derivation that starts with the prefix has exactly
+//     one such unit per level, so the candidates of a unit never double count
+//   - No unit derives the empty string, and the grammar is acyclic, so the recursions terminate
+//   - Rules with zero probability are ignored, as in InsideScorer
+
+#include "PrefixSampler.h"
+#include "madios/Logger.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+
+// Prefix tables for one prefix, filled on demand
+class PrefixSampler::Chart
+{
+    public:
+        Chart(const PrefixSampler &sampler, const vector<unsigned int> &words)
+        : sampler(sampler), grammar(sampler.grammar()), words(words), n(words.size()),
+          row_offset(grammar.symbolCount() * (n + 1), PCFG::npos), rows(n + 1, 0.0)  // offset 0 is the zero row
+        {}
+
+        // probability that symbol derives a string starting with words[i..n), with the last word its own
+        double prefix(unsigned int symbol, unsigned int i)
+        {
+            if(!grammar.isNonterminal(symbol))
+                return ((i + 1 == n) && (words[i] == symbol)) ? 1.0 : 0.0;
+            return choices(symbol, i).total;
+        }
+
+        // sample the tokens that follow the prefix; the prefix must have positive probability
+        void sample(std::mt19937 &rng, unsigned int maxLength, vector<string> &out)
+        {
+            vector<Candidate> frames;
+            unsigned int symbol = grammar.startSymbol();
+            unsigned int i = 0;
+            while(grammar.isNonterminal(symbol))
+            {
+                const Choices &c = choices(symbol, i);
+                std::uniform_real_distribution<double> draw(0.0, c.total);
+                size_t k = std::upper_bound(c.cumulative.begin(), c.cumulative.end(), draw(rng)) - c.cumulative.begin();
+                const Candidate &chosen = c.candidates[std::min(k, c.candidates.size() - 1)];
+                frames.push_back(chosen);
+                symbol = grammar.ruleRhs(chosen.rule)[chosen.slot];
+                i = chosen.position;
+            }
+            // the innermost unit finishes first, then the slots after each chosen one, outwards
+            for(auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+            {
+                PathView rhs = grammar.ruleRhs(frame->rule);
+                for(unsigned int l = frame->slot + 1; l < rhs.size(); l++)
+                    grammar.expand(rhs[l], rng, out, maxLength);
+            }
+        }
+
+    private:
+        // the prefix ends inside slot `slot` of `rule`, whose earlier slots derive words[i..position)
+        struct Candidate
+        {
+            unsigned int rule;
+            unsigned int slot;
+            unsigned int position;
+        };
+        struct Choices
+        {
+            double total = 0.0;
+            vector<Candidate> candidates;
+            vector<double> cumulative;
+        };
+
+        const Choices& choices(unsigned int symbol, unsigned int i)
+        {
+            size_t key = static_cast<size_t>(symbol) * n + i;
+            auto found = choice_table.find(key);
+            if(found != choice_table.end())
+                return found->second;
+
+            Choices c;
+            bool possible = sampler.canStartWith(symbol, words[i]);
+            for(unsigned int k = i + 1; possible && (k < n); k++)
+                possible = sampler.canReach(symbol, words[k]);
+            for(unsigned int r = grammar.rulesBegin(symbol); possible && (r < grammar.rulesEnd(symbol)); r++)
+            {
+                double p = grammar.probability(r);
+                if(p <= 0.0)
+                    continue;
+                PathView rhs = grammar.ruleRhs(r);
+                vector<double> f(n + 1, 0.0), g;
+                f[i] = 1.0;
+                for(unsigned int m = 0; m < rhs.size(); m++)
+                {
+                    bool open = false;  // some split leaves prefix words for this slot
+                    for(unsigned int pos = i; pos < n; pos++)
+                        if(f[pos] > 0.0)
+                        {
+                            open = true;
+                            double weight = p * f[pos] * prefix(rhs[m], pos);
+                            if(weight > 0.0)
+                            {
+                                c.candidates.push_back(Candidate{r, m, pos});
+                                c.total += weight;
+                                c.cumulative.push_back(c.total);
+                            }
+                        }
+                    if(!open || (m + 1 == rhs.size()))
+                        break;
+                    advance(rhs[m], f, g);
+                    f.swap(g);
+                }
+            }
+            return choice_table.emplace(key, std::move(c)).first->second;
+        }
+
+        // g[j] = sum over pos of f[pos] * P(symbol derives exactly words[pos..j))
+        void advance(unsigned int symbol, const vector<double> &f, vector<double> &g)
+        {
+            g.assign(n + 1, 0.0);
+            for(unsigned int pos = 0; pos < n; pos++)
+            {
+                if(f[pos] <= 0.0)
+                    continue;
+                if(!grammar.isNonterminal(symbol))
+                {
+                    if(words[pos] == symbol)
+                        g[pos + 1] += f[pos];
+                    continue;
+                }
+                unsigned int offset = inside(symbol, pos);
+                for(unsigned int j = pos + 1; j <= n; j++)
+                    g[j] += f[pos] * rows[offset + j];
+            }
+        }
+
+        // offset of the row inside(symbol, i) in rows
+        unsigned int inside(unsigned int symbol, unsigned int i)
+        {
+            unsigned int &cached = row_offset[static_cast<size_t>(symbol) * (n + 1) + i];
+            if(cached != PCFG::npos)
+                return cached;
+            vector<double> row(n + 1, 0.0);
+            bool any = false;
+            if((i < n) && sampler.canStartWith(symbol, words[i]))
+            {
+                vector<double> f, g;
+                for(unsigned int r = grammar.rulesBegin(symbol); r < grammar.rulesEnd(symbol); r++)
+                {
+                    double p = grammar.probability(r);
+                    if(p <= 0.0)
+                        continue;
+                    f.assign(n + 1, 0.0);
+                    f[i] = 1.0;
+                    for(unsigned int y : grammar.ruleRhs(r))
+                    {
+                        advance(y, f, g);
+                        f.swap(g);
+                    }
+                    for(unsigned int j = i + 1; j <= n; j++)
+                        if(f[j] > 0.0)
+                        {
+                            row[j] += p * f[j];
+                            any = true;
+                        }
+                }
+            }
+            cached = 0;  // row_offset never reallocates, so the reference is still valid
+            if(any)
+            {
+                cached = rows.size();
+                rows.insert(rows.end(), row.begin(), row.end());
+            }
+            return cached;
+        }
+
+        const PrefixSampler &sampler;
+        const FrozenGrammar &grammar;
+        vector<unsigned int> words;
+        unsigned int n;
+        vector<unsigned int> row_offset;
+        vector<double> rows;
+        std::unordered_map<size_t, Choices> choice_table;
+};
+
+/**
+ * @brief Precompute the first-terminal and reachability tables.
+ * @param grammar The grammar
+ */
+PrefixSampler::PrefixSampler(std::shared_ptr<const FrozenGrammar> grammar)
+: the_grammar(std::move(grammar))
+{
+    if (!the_grammar) {
+        throw std::invalid_argument("PrefixSampler: grammar is null");
+    }
+    madios::Logger::trace("Entering PrefixSampler constructor");
+    const FrozenGrammar &g = *the_grammar;
+    unsigned int num_rows = 0, num_columns = 0;
+    row_of.assign(g.symbolCount(), PCFG::npos);
+    column_of.assign(g.symbolCount(), PCFG::npos);
+    for(unsigned int id = 0; id < g.symbolCount(); id++)
+        if(g.isNonterminal(id))
+            row_of[id] = num_rows++;
+        else
+            column_of[id] = num_columns++;
+    words_per_row = (num_columns + 63) / 64;
+    first_table.assign(static_cast<size_t>(num_rows) * words_per_row, 0);
+    reach_table.assign(static_cast<size_t>(num_rows) * words_per_row, 0);
+
+    // fill the rows children first (depth-first post-order), rejecting cycles
+    vector<unsigned char> state(g.symbolCount(), 0);  // 0 new, 1 on the stack, 2 done
+    auto merge = [this](vector<std::uint64_t> &table, unsigned int row, unsigned int symbol, const vector<std::uint64_t> &source) {
+        std::uint64_t *target = &table[static_cast<size_t>(row) * words_per_row];
+        if(row_of[symbol] == PCFG::npos)
+            target[column_of[symbol] / 64] |= std::uint64_t(1) << (column_of[symbol] % 64);
+        else
+        {
+            const std::uint64_t *from = &source[static_cast<size_t>(row_of[symbol]) * words_per_row];
+            for(unsigned int w = 0; w < words_per_row; w++)
+                target[w] |= from[w];
+        }
+    };
+    std::function<void(unsigned int)> visit = [&](unsigned int symbol) {
+        state[symbol] = 1;
+        for(unsigned int r = g.rulesBegin(symbol); r < g.rulesEnd(symbol); r++)
+        {
+            PathView rhs = g.ruleRhs(r);
+            for(unsigned int y : rhs)
+            {
+                if(state[y] == 1)
+                    throw std::runtime_error("PrefixSampler: grammar is recursive through " + g.symbolName(y));
+                if((state[y] == 0) && g.isNonterminal(y))
+                    visit(y);
+                merge(reach_table, row_of[symbol], y, reach_table);
+            }
+            merge(first_table, row_of[symbol], rhs.front(), first_table);
+        }
+        state[symbol] = 2;
+    };
+    for(unsigned int id = 0; id < g.symbolCount(); id++)
+        if(g.isNonterminal(id) && (state[id] == 0))
+            visit(id);
+    madios::Logger::trace("Exiting PrefixSampler constructor");
+}
+
+/**
+ * @brief Compute the probability that a sampled sentence starts with the prefix.
+ * @param prefix The prefix tokens
+ * @return The prefix probability
+ */
+double PrefixSampler::prefixProbability(const vector<string> &prefix) const
+{
+    if(prefix.empty())
+        return 1.0;
+    vector<unsigned int> words;
+    for(const auto &token : prefix)
+    {
+        unsigned int id = the_grammar->symbolId(token);
+        if((id == PCFG::npos) || the_grammar->isNonterminal(id))
+            return 0.0;
+        words.push_back(id);
+    }
+    Chart chart(*this, words);
+    return chart.prefix(the_grammar->startSymbol(), 0);
+}
+
+/**
+ * @brief Sample completions of a prefix.
+ * @param prefix The prefix tokens
+ * @param count Number of completions
+ * @param rng Random engine
+ * @param maxLength Maximum number of tokens in a completed sentence
+ * @return The continuation tokens of each completion
+ */
+vector<vector<string> > PrefixSampler::complete(const vector<string> &prefix, unsigned int count, std::mt19937 &rng, unsigned int maxLength) const
+{
+    vector<vector<string> > completions;
+    unsigned int budget = (maxLength > prefix.size()) ? (maxLength - prefix.size()) : 0;
+    if(prefix.empty())
+    {
+        for(unsigned int k = 0; k < count; k++)
+            completions.push_back(the_grammar->generate(rng, budget));
+        return completions;
+    }
+    vector<unsigned int> words;
+    for(const auto &token : prefix)
+    {
+        unsigned int id = the_grammar->symbolId(token);
+        if((id == PCFG::npos) || the_grammar->isNonterminal(id))
+            return completions;
+        words.push_back(id);
+    }
+    Chart chart(*this, words);
+    if(chart.prefix(the_grammar->startSymbol(), 0) <= 0.0)
+        return completions;
+    completions.resize(count);
+    for(auto &completion : completions)
+        chart.sample(rng, budget, completion);
+    return completions;
+}
+
+/**
+ * @brief Check the first-terminal table.
+ * @param symbol The symbol id
+ * @param word The word's symbol id
+ * @return True if symbol can start with word
+ */
+bool PrefixSampler::canStartWith(unsigned int symbol, unsigned int word) const
+{
+    if(row_of[symbol] == PCFG::npos)
+        return symbol == word;
+    return testBit(first_table, symbol, word);
+}
+
+/**
+ * @brief Check the reachability table.
+ * @param symbol The symbol id
+ * @param word The word's symbol id
+ * @return True if symbol can produce word
+ */
+bool PrefixSampler::canReach(unsigned int symbol, unsigned int word) const
+{
+    if(row_of[symbol] == PCFG::npos)
+        return symbol == word;
+    return testBit(reach_table, symbol, word);
+}
+
+// PrefixSampler::testBit
+// Look up the bit of a word (terminal) in a nonterminal's row; nonterminal "words" are never set.
+bool PrefixSampler::testBit(const vector<std::uint64_t> &table, unsigned int symbol, unsigned int word) const
+{
+    unsigned int column = column_of[word];
+    if(column == PCFG::npos)
+        return false;
+    return (table[static_cast<size_t>(row_of[symbol]) * words_per_row + column / 64] >> (column % 64)) & 1;
+}
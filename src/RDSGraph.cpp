@@ -23,9 +23,13 @@
 // Add new variables here if naming is critical for refactor or LLM editing.
 
 #include "RDSGraph.h"
+#include "FrozenGrammar.h"
+#include "GraphEpoch.h"
+#include "InsideScorer.h"
+#include "JobMemory.h"
+#include "PatternEventLog.h"
 #include "logging.h"
 #include "utils/TimeFuncs.h"
-#include "madios/maths/tnt/array2d.h"
 #include "madios/Logger.h"
 #include "madios/BasicSymbol.h"
 #include <algorithm>
@@ -35,7 +39,19 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <functional>
 #include <memory>
+#include <numeric>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <random>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using std::min;
 using std::max;
@@ -60,6 +76,35 @@ bool operator<(const SignificancePair &a, const SignificancePair &b)
     return maxA < maxB;
 }
 
+// Utility: Compare a segment with a path window of the same length (four ids per SSE2 compare)
+inline bool segmentEquals(const unsigned int *segment, const unsigned int *window, unsigned int length)
+{
+    unsigned int j = 0;
+#ifdef __SSE2__
+    for(; j + 4 <= length; j += 4)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(segment + j));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(window + j));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xFFFF)
+            return false;
+    }
+#endif
+    for(; j < length; j++)
+        if(segment[j] != window[j])
+            return false;
+    return true;
+}
+
+// Utility: Hint that an address will be read soon (no-op where unsupported)
+inline void prefetchRead(const void *address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 1);
+#else
+    (void)address;
+#endif
+}
+
 // ===================== ADIOSParams =====================
 ADIOSParams::ADIOSParams(double eta, double alpha, unsigned int contextSize, double overlapThreshold)
 {
@@ -93,6 +138,58 @@ RDSGraph::RDSGraph(const std::vector<std::vector<std::string>> &sequences)
     buildInitialGraph(sequences);
 }
 
+/**
+ * @brief Constructs an out-of-core RDSGraph whose paths, occurrence lists and parse trees live in a MappedStore.
+ * @param sequences A vector of input sequences (each sequence is a vector of strings).
+ * @param store The backing store (shared with clones of this graph), or null for an in-memory graph.
+ */
+RDSGraph::RDSGraph(const std::vector<std::vector<std::string>> &sequences, std::shared_ptr<MappedStore> store)
+: store(std::move(store))
+{
+    if (sequences.empty()) {
+        throw std::invalid_argument("RDSGraph: input sequences vector is empty");
+    }
+    srand(getSeedFromTime());
+    buildInitialGraph(sequences);
+}
+
+/**
+ * @brief Constructs an out-of-core RDSGraph from a corpus stream, one sequence at a time.
+ * @param corpus The corpus stream (see readSequence).
+ * @param store The backing store (shared with clones of this graph), or null for an in-memory graph.
+ */
+RDSGraph::RDSGraph(std::istream &corpus, std::shared_ptr<MappedStore> store)
+: store(std::move(store))
+{
+    srand(getSeedFromTime());
+    // only the vocabulary is held in memory; each path goes to the store as it is read
+    std::unordered_map<string, unsigned int> lexicon;
+    vector<string> sequence;
+    while(readSequence(corpus, sequence))
+        addInitialPath(sequence, lexicon);
+    if (paths.empty()) {
+        throw std::invalid_argument("RDSGraph: the corpus stream holds no sequence");
+    }
+    updateAllConnections();
+}
+
+namespace {
+
+// Utility: the context sizes a distillation converges at in turn, the schedule's then contextSize.
+// Throws std::invalid_argument (with the caller's name) unless the schedule is strictly increasing
+// and below contextSize.
+vector<unsigned int> contextSizes(const ADIOSParams &params, const std::string &caller)
+{
+    vector<unsigned int> context_sizes(params.contextSchedule);
+    context_sizes.push_back(params.contextSize);
+    for(unsigned int s = 1; s < context_sizes.size(); s++)
+        if(context_sizes[s] <= context_sizes[s - 1])
+            throw std::invalid_argument(caller + ": contextSchedule must be strictly increasing and below contextSize");
+    return context_sizes;
+}
+
+}  // namespace
+
 /**
  * @brief Main distillation loop: iteratively finds and generalizes patterns until convergence.
  * Robust to empty/invalid parse trees and out-of-bounds access.
@@ -103,6 +200,8 @@ void RDSGraph::distill(const ADIOSParams &params)
     if (paths.empty()) {
         throw std::runtime_error("RDSGraph::distill: No paths available in the graph");
     }
+    // the schedule's context sizes, then contextSize itself, each run to convergence on the graph so far
+    vector<unsigned int> context_sizes = contextSizes(params, "RDSGraph::distill");
     madios::Logger::trace("Entering RDSGraph::distill");
     if (!quiet) {
         std::cout << "eta = " << params.eta << endl;
@@ -110,34 +209,69 @@ void RDSGraph::distill(const ADIOSParams &params)
         std::cout << "contextSize = " << params.contextSize << endl;
         std::cout << "overlapThreshold = " << params.overlapThreshold << endl;
     }
-    unsigned int iteration = 0;
-    while(true)
+    search_memo.clear();
+    // out of core, the memo's heap copies of paths must not outgrow the resident budget
+    search_memo.setCapacity(store ? store->residentBudget() : 0);
+    if (params.relayoutInterval > 0)
+        relayout();
+    completed_iterations = 0;
+    context_stages.clear();
+    for(unsigned int context_size : context_sizes)
     {
-        madios::Logger::trace("RDSGraph::distill iteration " + std::to_string(iteration));
-        bool foundPattern = false;
-        for(const auto& path : paths)
+        ADIOSParams stage_params = params;
+        stage_params.contextSize = context_size;
+        if(!context_stages.empty())
+            search_memo.clear();  // generalise() outcomes depend on the context size
+        double stage_start = getTime();
+        unsigned int iteration = completed_iterations;
+        unsigned int first_iteration = iteration;
+        while(true)
         {
-            madios::Logger::trace("RDSGraph::distill: working on Path of length " + std::to_string(path.size()));
-            if((params.contextSize < 3) || (path.size() < params.contextSize))
+            current_iteration = iteration;
+            madios::Logger::trace("RDSGraph::distill iteration " + std::to_string(iteration));
+            bool foundPattern = false;
+            selectResidentNodes();
+            for(unsigned int k = 0; k < paths.size(); k++)
             {
-                madios::Logger::trace("RDSGraph::distill: using distill(SearchPath) for path of length " + std::to_string(path.size()));
-                bool foundAnotherPattern = distill(path, params);
-                foundPattern = foundAnotherPattern || foundPattern;
+                adviseScan(k);
+                const SearchPath &path = paths[pathAt(k)];
+                madios::Logger::trace("RDSGraph::distill: working on Path of length " + std::to_string(path.size()));
+                if((stage_params.contextSize < 3) || (path.size() < stage_params.contextSize))
+                {
+                    madios::Logger::trace("RDSGraph::distill: using distill(SearchPath) for path of length " + std::to_string(path.size()));
+                    bool foundAnotherPattern = distill(path, stage_params);
+                    foundPattern = foundAnotherPattern || foundPattern;
+                }
+                else
+                {
+                    madios::Logger::trace("RDSGraph::distill: using generalise(SearchPath) for path of length " + std::to_string(path.size()));
+                    bool foundAnotherPattern = generalise(path, stage_params);
+                    foundPattern = foundAnotherPattern || foundPattern;
+                }
             }
-            else
-            {
-                madios::Logger::trace("RDSGraph::distill: using generalise(SearchPath) for path of length " + std::to_string(path.size()));
-                bool foundAnotherPattern = generalise(path, params);
-                foundPattern = foundAnotherPattern || foundPattern;
+            logProgressEvent("iteration");
+            completed_iterations = iteration + 1;
+            if(foundPattern && (params.publishInterval > 0) && ((iteration + 1) % params.publishInterval == 0))
+                publish();
+            if(!foundPattern) {
+                madios::Logger::trace("RDSGraph::distill: no new patterns found, breaking loop");
+                break;
             }
+            iteration++;
+            if ((params.relayoutInterval > 0) && (iteration % params.relayoutInterval == 0))
+                relayout();
         }
-        if(!foundPattern) {
-            madios::Logger::trace("RDSGraph::distill: no new patterns found, breaking loop");
-            break;
-        }
-        iteration++;
+        context_stages.push_back(ContextStage{context_size, completed_iterations - first_iteration, getTime() - stage_start});
+        if(context_sizes.size() > 1)
+            madios::Logger::info("RDSGraph::distill: context size " + std::to_string(context_size) + " converged after "
+                                 + std::to_string(context_stages.back().iterations) + " iterations in " + std::to_string(context_stages.back().seconds) + " s");
     }
+    restoreLayout();
+    madios::Logger::info("RDSGraph::distill: pattern search memo " + std::to_string(search_memo.hits()) + " hits, " + std::to_string(search_memo.misses()) + " misses, " + std::to_string(search_memo.overflows()) + " overflows");
     estimateProbabilities();
+    logProgressEvent("end");
+    if (params.publishInterval > 0)
+        publish(true);
     // Output node counts for debugging, with robust guards
     if (!quiet) std::cout << endl << endl << endl;
     for(const auto& countVec : counts)
@@ -179,58 +313,124 @@ void RDSGraph::convert2PCFG(ostream &out) const
         throw std::runtime_error("RDSGraph::convert2PCFG: No nodes in the graph");
     }
     madios::Logger::trace("Entering RDSGraph::convert2PCFG");
+    buildPCFG(counts).write(out);
+    madios::Logger::trace("Exiting RDSGraph::convert2PCFG");
+}
 
-    // Output the learned PCFG rules in standard format: LHS -> RHS [probability]
-    // Probabilities are normalized over all rules with the same LHS.
+/**
+ * @brief Get the learned grammar as a PCFG (the rules convert2PCFG writes, at full precision).
+ * @return The grammar.
+ */
+PCFG RDSGraph::toPCFG() const
+{
+    if (nodes.empty()) {
+        throw std::runtime_error("RDSGraph::toPCFG: No nodes in the graph");
+    }
+    return buildPCFG(counts);
+}
+
+/**
+ * @brief Freeze the current grammar into an immutable object that can be shared between threads.
+ * Probabilities are estimated from the current parse trees, so this also works during distillation.
+ * @return The frozen grammar.
+ */
+std::shared_ptr<const FrozenGrammar> RDSGraph::freeze() const
+{
+    if (nodes.empty()) {
+        throw std::runtime_error("RDSGraph::freeze: No nodes in the graph");
+    }
+    return std::make_shared<const FrozenGrammar>(buildPCFG(computeCounts()));
+}
+
+/**
+ * @brief Get the latest published snapshot of the graph; safe to call from any thread.
+ * @return The latest epoch, or null if none has been published
+ */
+std::shared_ptr<const GraphEpoch> RDSGraph::snapshot() const
+{
+    return std::atomic_load(&published);
+}
+
+/**
+ * @brief Publish the current nodes, paths and grammar as a new epoch.
+ * The epoch is built on the learner's thread and swapped in with one atomic store; the previous
+ * epoch is freed by whichever thread releases it last.
+ * @param final True if distillation has ended
+ */
+void RDSGraph::publish(bool final)
+{
+    if (nodes.empty()) {
+        throw std::runtime_error("RDSGraph::publish: No nodes in the graph");
+    }
+    auto epoch = std::make_shared<GraphEpoch>();
+    epoch->number = ++epochs;
+    epoch->iteration = completed_iterations;
+    epoch->final = final;
+    epoch->grammar = freeze();
+    epoch->names.resize(nodes.size());
+    for(unsigned int i = 0; i < nodes.size(); i++)
+        epoch->names[nodeLabel(i)] = printNodeName(i);
+    epoch->paths.resize(paths.size());
+    for(unsigned int k = 0; k < paths.size(); k++)
+    {
+        const SearchPath &path = paths[pathAt(k)];
+        epoch->paths[k].reserve(path.size());
+        for(unsigned int node : path)
+            epoch->paths[k].push_back(nodeLabel(node));
+    }
+    std::atomic_store(&published, std::shared_ptr<const GraphEpoch>(std::move(epoch)));
+}
+
+// RDSGraph::buildPCFG
+// Build the PCFG rules from node counts: EC and SP rules in node order, then S rules (one per
+// distinct path, without the start/end symbols) in lexicographic order of their symbol names.
+// Probabilities are normalized over all rules with the same LHS.
+PCFG RDSGraph::buildPCFG(const vector<vector<unsigned int> > &node_counts) const
+{
+    PCFG grammar;
     for(const auto& node : nodes)
     {
+        unsigned int index = &node - &nodes[0];
         if(node.type == LexiconTypes::EC)
         {
-            auto ec = static_cast<EquivalenceClass *>(node.lexicon.get()); // use auto
+            auto ec = static_cast<EquivalenceClass *>(node.lexicon.get());
             double total = 0.0;
             for(auto j = 0u; j < ec->size(); j++)
-                total += counts[&node - &nodes[0]][j];
+                total += node_counts[index][j];
             if (total == 0.0) total = 1.0; // avoid division by zero
-            for(auto j = 0u; j < ec->size(); j++) {
-                double prob = counts[&node - &nodes[0]][j] / total;
-                out << "E" << (&node - &nodes[0]) << " -> " << printNodeName((*ec)[j]) << " [" << prob << "]" << std::endl;
-            }
+            for(auto j = 0u; j < ec->size(); j++)
+                grammar.addRule(printNodeName(index), vector<string>(1, printNodeName((*ec)[j])), node_counts[index][j] / total);
         }
         else if(node.type == LexiconTypes::SP)
         {
-            auto sp = static_cast<SignificantPattern *>(node.lexicon.get()); // use auto
-            double total = counts[&node - &nodes[0]][0];
+            auto sp = static_cast<SignificantPattern *>(node.lexicon.get());
+            double total = node_counts[index][0];
             if (total == 0.0) total = 1.0;
-            double prob = counts[&node - &nodes[0]][0] / total;
-            out << "P" << &node - &nodes[0] << " ->";
+            vector<string> rhs;
             for(auto j = 0u; j < sp->size(); j++)
-                out << " " << printNodeName((*sp)[j]);
-            out << " [" << prob << "]" << std::endl;
+                rhs.push_back(printNodeName((*sp)[j]));
+            grammar.addRule(printNodeName(index), rhs, node_counts[index][0] / total);
         }
     }
-    // --- Normalize S rules ---
-    // Count occurrences of each unique S rule (RHS)
+    // Count occurrences of each unique S rule (RHS): group identical paths by hash, then name each distinct one once
+    std::unordered_map<std::reference_wrapper<const SearchPath>, int, SearchPathHash, std::equal_to<SearchPath> > path_counts;
+    for(const auto &path : paths)
+        path_counts[std::cref(path)]++;
     std::map<std::vector<std::string>, int> s_rule_counts;
     int total_s_rule_count = 0;
-    for(auto i = 0u; i < paths.size(); i++) {
+    for(const auto &entry : path_counts) {
+        const SearchPath &path = entry.first;
         std::vector<std::string> rhs;
-        for(auto j = 1u; j < paths[i].size()-1; j++)
-            rhs.push_back(printNodeName(paths[i][j]));
-        s_rule_counts[rhs]++;
-        total_s_rule_count++;
+        for(auto j = 1u; j < path.size()-1; j++)
+            rhs.push_back(printNodeName(path[j]));
+        s_rule_counts[rhs] += entry.second;
+        total_s_rule_count += entry.second;
     }
-    // Output S rules with normalized probabilities
     for(const auto& pair : s_rule_counts) {
-        const auto& rhs = pair.first;
-        int count = pair.second;
-        double prob = (total_s_rule_count > 0) ? (static_cast<double>(count) / total_s_rule_count) : 1.0;
-        out << "S ->";
-        for(const auto& sym : rhs)
-            out << " " << sym;
-        out << " [" << prob << "]" << std::endl;
+        double prob = (total_s_rule_count > 0) ? (static_cast<double>(pair.second) / total_s_rule_count) : 1.0;
+        grammar.addRule("S", pair.first, prob);
     }
-
-    madios::Logger::trace("Exiting RDSGraph::convert2PCFG");
+    return grammar;
 }
 
 // RDSGraph::generate
@@ -341,21 +541,32 @@ bool RDSGraph::distill(const SearchPath &search_path, const ADIOSParams &params)
         throw std::invalid_argument("RDSGraph::distill(SearchPath): search_path is empty");
     }
     madios::Logger::trace("RDSGraph::distill(SearchPath) called");
-    ConnectionMatrix connections;
-    TNT::Array2D<double> flows, descents;
-    computeConnectionMatrix(connections, search_path);
-    computeDescentsMatrix(flows, descents, connections);
     vector<Range> patterns;
     vector<SignificancePair> pvalues;
-    if(!findSignificantPatterns(patterns, pvalues, connections, flows, descents, params.eta, params.alpha)) {
+    bool recalled = recallSearch(search_path, patterns, pvalues);
+    if(recalled && patterns.empty()) {
+        madios::Logger::trace("RDSGraph::distill(SearchPath): no significant patterns (memoized)");
+        return false;
+    }
+    ScratchArena::Scope scratch_scope(scratch);
+    ConnectionMatrix connections(&scratch);
+    computeConnectionMatrix(connections, search_path);  // the rewire needs it even on a memo hit
+    bool found = !patterns.empty();
+    if(!recalled)
+    {
+        found = searchSignificantPatterns(patterns, pvalues, connections, params);
+        rememberSearch(search_path, patterns, pvalues);
+    }
+    if(!found) {
         madios::Logger::trace("RDSGraph::distill(SearchPath): no significant patterns found");
         return false;
     }
-    SignificantPattern bestPattern(search_path(patterns.front().first, patterns.front().second));
+    SignificantPattern bestPattern(search_path.view(patterns.front().first, patterns.front().second));
     madios::Logger::trace("RDSGraph::distill(SearchPath): best pattern found, range = [" + std::to_string(patterns.front().first) + ", " + std::to_string(patterns.front().second) + "]");
     vector<Connection> connectionsToRewire = getRewirableConnections(connections, patterns.front(), params.alpha);
     madios::Logger::trace("RDSGraph::distill(SearchPath): rewiring " + std::to_string(connectionsToRewire.size()) + " connections");
-    rewire(connectionsToRewire, SignificantPattern(bestPattern));
+    rewire(connectionsToRewire, bestPattern);
+    logUnitEvent(nodes.size() - 1, pvalues.front(), nodes.back().getConnections().size());
     if (!quiet) {
         std::cout << "BEST PATTERN!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << endl;
         std::cout << "RANGE = [" << patterns.front().first << " " << patterns.front().second << "]" << endl;
@@ -383,23 +594,26 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
     if (params.contextSize < 2) {
         throw std::invalid_argument("RDSGraph::generalise: contextSize must be >= 2");
     }
+    // all temporaries below live in the scratch arena, which is reset when this path is done
+    ScratchArena::Scope scratch_scope(scratch);
+
     // === BOOTSTRAPPING STAGE ===
     // Bootstrapping: find initial equivalence classes based on overlaps in the search path.
-    vector<Range> all_boosted_contexts;
-    vector<SearchPath> all_boosted_paths;
-    vector<vector<EquivalenceClass> > all_encountered_ecs;
+    std::pmr::vector<Range> all_boosted_contexts(&scratch);
+    std::pmr::vector<SearchPath> all_boosted_paths(&scratch);
+    std::pmr::vector<std::pmr::vector<EquivalenceClass> > all_encountered_ecs(&scratch);
 
     // initialise with just the search path with no bootstrapping
     all_boosted_contexts.push_back(Range(0, 0));
     all_boosted_paths.push_back(search_path);
-    all_encountered_ecs.push_back(vector<EquivalenceClass>(max(static_cast<unsigned int>(0), params.contextSize-2)));
+    all_encountered_ecs.emplace_back(max(static_cast<unsigned int>(0), params.contextSize-2));
 
     // get all boosted paths
     for(unsigned int i = 0; (i+params.contextSize-1) < search_path.size(); i++)
     {
         Range context(i, i+params.contextSize-1);
-        all_encountered_ecs.push_back(vector<EquivalenceClass>());
-        SearchPath boosted_part = bootstrap(all_encountered_ecs.back(), SearchPath(search_path(context.first, context.second)), params.overlapThreshold);
+        all_encountered_ecs.emplace_back();
+        SearchPath boosted_part = bootstrap(all_encountered_ecs.back(), search_path.view(context.first, context.second), params.overlapThreshold);
         SearchPath boosted_path(search_path.substitute(context.first, context.second, boosted_part));
         all_boosted_contexts.push_back(context);
         all_boosted_paths.push_back(boosted_path);
@@ -409,10 +623,11 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
 
     // === GENERALISATION STAGE ===
     // Generalisation: try all possible slots and create new generalised paths using ECs.
-    vector<unsigned int> general2boost;
-    vector<unsigned int> all_general_slots;
-    vector<SearchPath> all_general_paths;
-    vector<EquivalenceClass> all_general_ecs;
+    std::pmr::vector<unsigned int> general2boost(&scratch);
+    std::pmr::vector<unsigned int> all_general_slots(&scratch);
+    std::pmr::vector<SearchPath> all_general_paths(&scratch);
+    std::pmr::vector<EquivalenceClass> all_general_ecs(&scratch);
+    std::pmr::unordered_multimap<std::uint64_t, unsigned int> general_indices(&scratch);
 
     // initialise with just the search path with no generalisation
     general2boost.push_back(0);
@@ -425,18 +640,18 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
     {
         unsigned int context_start = all_boosted_contexts[i].first;
         unsigned int context_finish = all_boosted_contexts[i].second;
-        SearchPath boosted_part(all_boosted_paths[i](context_start, context_finish));
+        PathView boosted_part = all_boosted_paths[i].view(context_start, context_finish);
 
-        // try all the possible slots
-        unsigned int start_index = all_general_paths.size();
+        // try all the possible slots; general_indices finds earlier generalisations of this boosted path by hash
+        general_indices.clear();
         for(unsigned int j = 1; j < params.contextSize-1; j++)
         {
-            EquivalenceClass ec = computeEquivalenceClass(boosted_part, j);
+            EquivalenceClass ec = computeEquivalenceClass(boosted_part, j, &scratch);
 
             // Only generalize if the equivalence class has more than one element
             SearchPath general_path = all_boosted_paths[i];
             if(ec.size() > 1)
-                general_path[context_start+j] = findExistingEquivalenceClass(ec);
+                general_path.set(context_start+j, findExistingEquivalenceClass(ec));
 
             // Skip if the generalization is identical to the original path
             if(general_path == search_path)
@@ -444,13 +659,15 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
 
             // Skip if this generalization is already present
             bool repeated = false;
-            for(unsigned int k = start_index; k < all_general_paths.size(); k++)
-                if(general_path == all_general_paths[k])
+            auto candidates = general_indices.equal_range(general_path.hash());
+            for(auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+                if(general_path == all_general_paths[candidate->second])
                 {
                     repeated = true;
                     break;
                 }
             if(repeated) continue;
+            general_indices.emplace(general_path.hash(), all_general_paths.size());
 
             // Add the generalised path to the list to be tested
             general2boost.push_back(i);  // add the boosted path number corresponding to the general path
@@ -464,33 +681,33 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
     // === DISTILLATION STAGE ===
     // For each generalized path, simulate rewiring and look for significant patterns.
     // Only accept patterns that introduce new equivalence classes.
-    vector<Range> all_patterns;
-    vector<SignificancePair> all_pvalues;
-    vector<unsigned int> pattern2general;
+    std::pmr::vector<Range> all_patterns(&scratch);
+    std::pmr::vector<SignificancePair> all_pvalues(&scratch);
+    std::pmr::vector<unsigned int> pattern2general(&scratch);
 
     // Re-enable simulation using a temporary graph clone for new ECs
     for(unsigned int i = 0; i < all_general_paths.size(); i++)
     {
-        ConnectionMatrix connections;
+        ConnectionMatrix connections(&scratch);
         unsigned int slot_index = all_general_slots[i];
+        vector<Range> some_patterns;
+        vector<SignificancePair> some_pvalues;
         if(all_general_paths[i][slot_index] >= nodes.size()) // if a new EC is expected, simulate with a temp graph
         {
             // Use a temporary graph clone to simulate rewiring for new ECs
             auto temp_graph = this->clone();
-            temp_graph->rewire(vector<Connection>(), EquivalenceClass(all_general_ecs[i]));
+            temp_graph->rewire(vector<Connection>(), all_general_ecs[i]);
             temp_graph->computeConnectionMatrix(connections, all_general_paths[i]);
+            searchSignificantPatterns(some_patterns, some_pvalues, connections, params);
         }
-        else
+        else if(!recallSearch(all_general_paths[i], some_patterns, some_pvalues))
+        {
+            // compute flows and descents from the connection matrix and look for significant patterns
             computeConnectionMatrix(connections, all_general_paths[i]);
-
-        // compute flows and descents matrix from connection matrix
-        TNT::Array2D<double> flows, descents;
-        computeDescentsMatrix(flows, descents, connections);
-
-        // look for significant patterns
-        vector<Range> some_patterns;
-        vector<SignificancePair> some_pvalues;
-        if(!findSignificantPatterns(some_patterns, some_pvalues, connections, flows, descents, params.eta, params.alpha))
+            searchSignificantPatterns(some_patterns, some_pvalues, connections, params);
+            rememberSearch(all_general_paths[i], some_patterns, some_pvalues);
+        }
+        if(some_patterns.empty())
             continue;
 
         // add them to the list
@@ -548,21 +765,23 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
 
     unsigned int best_boosted_index = general2boost[best_general_index];
     Range best_context = all_boosted_contexts[best_boosted_index];
-    vector<EquivalenceClass> best_encountered_ecs = all_encountered_ecs[best_boosted_index];
+    const std::pmr::vector<EquivalenceClass> &best_encountered_ecs = all_encountered_ecs[best_boosted_index];
 
 
 
     // REWIRING STAGE
     if (!quiet) std::cerr << "STARTS REWIRING" << endl;
     unsigned int old_num_nodes = nodes.size();
+    vector<unsigned int> new_ecs;               // logged once the pattern holding them is rewired
     unsigned int search_start = max(best_pattern.first, best_context.first);
     unsigned int search_finish = min(best_pattern.second, best_context.second);
     for(unsigned int i = search_start; i <= search_finish; i++)
     {
         if(best_path[i] >= old_num_nodes)       // true if a new EC was discovered at the specific slot
         {
-            best_path[i] = nodes.size();
-            rewire(vector<Connection>(), EquivalenceClass(best_ec));
+            best_path.set(i, nodes.size());
+            rewire(vector<Connection>(), best_ec);
+            new_ecs.push_back(best_path[i]);
         }
         else if(best_path[i] != search_path[i]) // true if the part of the context was boosted from existing ECs
         {
@@ -574,8 +793,9 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
             if(overlap_ratio < 1.0)            // true if the overlap with existing EC is less than 1.0, only use the subset that overlaps with it
             {
                 if (!quiet) std::cerr << "NEW OVERLAP EC USED: E[" << printEquivalenceClass(overlap_ec) << "]" << endl;
-                best_path[i] = nodes.size();
-                rewire(vector<Connection>(), EquivalenceClass(overlap_ec));
+                best_path.set(i, nodes.size());
+                rewire(vector<Connection>(), overlap_ec);
+                new_ecs.push_back(best_path[i]);
             }
             else
             {
@@ -584,10 +804,14 @@ bool RDSGraph::generalise(const SearchPath &search_path, const ADIOSParams &para
             }
         }
     }
-    ConnectionMatrix best_connections;
+    ConnectionMatrix best_connections(&scratch);
     computeConnectionMatrix(best_connections, best_path);
     vector<Connection> best_pattern_connections = getRewirableConnections(best_connections, best_pattern, params.alpha);
-    rewire(best_pattern_connections, SignificantPattern(best_path(best_pattern.first, best_pattern.second)));
+    rewire(best_pattern_connections, SignificantPattern(best_path.view(best_pattern.first, best_pattern.second)));
+    // a new EC occurs in the paths only inside the new pattern, once per rewired occurrence
+    for(unsigned int ec : new_ecs)
+        logUnitEvent(ec, best_pvalues, best_pattern_connections.size());
+    logUnitEvent(nodes.size() - 1, best_pvalues, nodes.back().getConnections().size());
     if (!quiet) std::cerr << best_pattern_connections .size() << " occurences rewired" << endl;
     if (!quiet) std::cerr << "ENDS REWIRING" << endl;
 
@@ -627,47 +851,197 @@ void RDSGraph::buildInitialGraph(const vector<vector<string> > &sequences)
     if (sequences.empty()) {
         throw std::invalid_argument("RDSGraph::buildInitialGraph: input sequences vector is empty");
     }
-    //pad the temporary lexicon vector with empty element to acount for special start and end state
-    vector<string> lexicon;
-    lexicon.push_back("");
-    lexicon.push_back("");
+    std::unordered_map<string, unsigned int> lexicon;
+    for(unsigned int i = 0; i < sequences.size(); i++)
+        addInitialPath(sequences[i], lexicon);
+
+    updateAllConnections();
+}
 
+// RDSGraph::addInitialPath
+// Append the path and parse tree of one input sequence, creating a symbol node for each new word
+// (lexicon maps words to their nodes). The first call also creates the start and end nodes.
+// Connections are left to the caller.
+void RDSGraph::addInitialPath(const vector<string> &sequence, std::unordered_map<string, unsigned int> &lexicon)
+{
     //insert the special symbols
-    nodes.push_back(RDSNode(std::make_unique<StartSymbol>(), LexiconTypes::Start));
-    nodes.push_back(RDSNode(std::make_unique<EndSymbol>(), LexiconTypes::End));
-    for(unsigned int i = 0; i < sequences.size(); i++)
+    if(nodes.empty())
+    {
+        nodes.push_back(RDSNode(std::make_unique<StartSymbol>(), LexiconTypes::Start, storage()));
+        nodes.push_back(RDSNode(std::make_unique<EndSymbol>(), LexiconTypes::End, storage()));
+    }
+    vector<unsigned int> currentPath;
+
+    //insert start state
+    currentPath.push_back(0);
+
+    //create the main part of the graph
+    for(unsigned int j = 0; j < sequence.size(); j++)
     {
-        vector<unsigned int> currentPath;
+        auto found = lexicon.emplace(sequence[j], nodes.size());
+        if(found.second)
+            nodes.push_back(RDSNode(std::make_unique<BasicSymbol>(sequence[j]), LexiconTypes::Symbol, storage()));
+        currentPath.push_back(found.first->second);
+    }
+
+    //insert end state
+    currentPath.push_back(1);
+
+    paths.push_back(SearchPath(currentPath, storage()));
 
-        //insert start state
-        currentPath.push_back(0);
+    // create the initial parse tree
+    trees.push_back(ParseTree<unsigned int>(currentPath, storage()));
+}
+
+/**
+ * @brief Seed the graph with the SPs and ECs of an earlier grammar, before distillation.
+ * @param grammar The earlier grammar
+ * @return The number of SP and EC nodes created
+ */
+unsigned int RDSGraph::warmStart(const PCFG &grammar)
+{
+    for(const auto &node : nodes)
+        if((node.type == LexiconTypes::SP) || (node.type == LexiconTypes::EC))
+            throw std::logic_error("RDSGraph::warmStart: the graph already has learned units");
+    madios::Logger::trace("Entering RDSGraph::warmStart");
+
+    // words (and the * and # markers) map to the existing nodes of the same name
+    std::unordered_map<string, unsigned int> word_nodes;
+    for(unsigned int i = 0; i < nodes.size(); i++)
+        word_nodes.emplace(printNodeName(i), i);
+    vector<unsigned int> node_of(grammar.symbolCount(), PCFG::npos);
+    vector<unsigned char> state(grammar.symbolCount(), 0);
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+        if(!grammar.isNonterminal(id))
+        {
+            auto found = word_nodes.find(grammar.symbolName(id));
+            if(found != word_nodes.end())
+                node_of[id] = found->second;
+            state[id] = 2;
+        }
+    unsigned int start = grammar.startSymbol();
+    if(start != PCFG::npos)
+        state[start] = 2;
+
+    unsigned int first_new = nodes.size();
+    for(unsigned int id = 0; id < grammar.symbolCount(); id++)
+        instantiateUnit(grammar, id, node_of, state);
+    vector<unsigned int> patterns;
+    for(unsigned int i = first_new; i < nodes.size(); i++)
+        if(nodes[i].type == LexiconTypes::SP)
+            patterns.push_back(i);
+    unsigned int reductions = reducePaths(patterns);
+    madios::Logger::info("RDSGraph::warmStart: " + std::to_string(nodes.size() - first_new) + " units instantiated, " + std::to_string(reductions) + " path segments reduced");
+    madios::Logger::trace("Exiting RDSGraph::warmStart");
+    return nodes.size() - first_new;
+}
 
-        //create the main part of the graph
-        for(unsigned int j = 0; j < sequences[i].size(); j++)
+// RDSGraph::instantiateUnit
+// Create the node for a grammar symbol after the nodes of its elements (depth first) and return it,
+// or PCFG::npos if the symbol cannot be built from this corpus. state is 0 for unvisited symbols,
+// 1 while a symbol is being built and 2 once node_of holds its node.
+unsigned int RDSGraph::instantiateUnit(const PCFG &grammar, unsigned int symbol, vector<unsigned int> &node_of, vector<unsigned char> &state)
+{
+    if(state[symbol] == 2)
+        return node_of[symbol];
+    if(state[symbol] == 1)
+        throw std::runtime_error("RDSGraph::warmStart: the grammar is recursive at " + grammar.symbolName(symbol));
+    state[symbol] = 1;
+
+    unsigned int node = PCFG::npos;
+    if(grammar.isPattern(symbol))
+    {
+        vector<unsigned int> elements;
+        for(unsigned int element : grammar.rules()[grammar.rulesFor(symbol).front()].rhs)
         {
-            // Modernized: use std::find instead of manual loop
-            auto foundPosition = std::find(lexicon.begin(), lexicon.end(), sequences[i][j]);
-            if(foundPosition == lexicon.end())
+            unsigned int child = instantiateUnit(grammar, element, node_of, state);
+            if(child == PCFG::npos)
             {
-                lexicon.push_back(sequences[i][j]);
-                nodes.push_back(RDSNode(std::make_unique<BasicSymbol>(sequences[i][j]), LexiconTypes::Symbol));
-                currentPath.push_back(lexicon.size() - 1);
+                elements.clear();
+                break;
             }
-            else
-                currentPath.push_back(std::distance(lexicon.begin(), foundPosition)); //+2 offset for start and end states
+            elements.push_back(child);
         }
-
-        //insert end state
-        currentPath.push_back(1);
-
-        paths.push_back(SearchPath(currentPath));
+        if(!elements.empty())
+            node = appendNode(std::make_unique<SignificantPattern>(elements), LexiconTypes::SP);
+    }
+    else
+    {
+        vector<unsigned int> members;
+        for(unsigned int r : grammar.rulesFor(symbol))
+        {
+            const PCFG::Rule &rule = grammar.rules()[r];
+            if(rule.rhs.size() != 1)
+                continue;
+            unsigned int child = instantiateUnit(grammar, rule.rhs.front(), node_of, state);
+            if((child != PCFG::npos) && (std::find(members.begin(), members.end(), child) == members.end()))
+                members.push_back(child);
+        }
+        if(!members.empty())
+            node = appendNode(std::make_unique<EquivalenceClass>(members), LexiconTypes::EC);
     }
 
-    updateAllConnections();
+    state[symbol] = 2;
+    node_of[symbol] = node;
+    return node;
+}
 
-    // create initial parse trees
+// RDSGraph::reducePaths
+// Replace every occurrence of the given SPs (in creation order, so inner patterns first) in every
+// path, rewiring the parse trees as rewire() does; an EC element matches any of its members. Only
+// the SPs whose first element can match a token of the path are tried, and reducing a segment
+// queues the SPs that start with the new node. Returns the number of segments replaced.
+unsigned int RDSGraph::reducePaths(const vector<unsigned int> &patterns)
+{
+    vector<vector<unsigned int> > starting_with(nodes.size());
+    for(unsigned int rank = 0; rank < patterns.size(); rank++)
+    {
+        unsigned int first = static_cast<SignificantPattern *>(nodes[patterns[rank]].lexicon.get())->front();
+        starting_with[first].push_back(rank);
+        if(nodes[first].type == LexiconTypes::EC)
+            for(unsigned int member : *static_cast<EquivalenceClass *>(nodes[first].lexicon.get()))
+                starting_with[member].push_back(rank);
+    }
+    auto matches = [this](unsigned int element, unsigned int token) {
+        if(element == token)
+            return true;
+        if(nodes[element].type != LexiconTypes::EC)
+            return false;
+        const EquivalenceClass *ec = static_cast<EquivalenceClass *>(nodes[element].lexicon.get());
+        return std::find(ec->begin(), ec->end(), token) != ec->end();
+    };
+
+    unsigned int reductions = 0;
+    std::set<unsigned int> pending;
     for(unsigned int i = 0; i < paths.size(); i++)
-        trees.push_back(ParseTree<unsigned int>(paths[i]));
+    {
+        for(unsigned int token : paths[i])
+            pending.insert(starting_with[token].begin(), starting_with[token].end());
+        while(!pending.empty())
+        {
+            unsigned int node = patterns[*pending.begin()];
+            pending.erase(pending.begin());
+            const SignificantPattern &sp = *static_cast<SignificantPattern *>(nodes[node].lexicon.get());
+            unsigned int length = sp.size();
+            for(unsigned int pos = 0; pos + length <= paths[i].size(); pos++)
+            {
+                unsigned int k = 0;
+                while((k < length) && matches(sp[k], paths[i][pos + k]))
+                    k++;
+                if(k < length)
+                    continue;
+                for(k = 0; k < length; k++)
+                    if(paths[i][pos + k] != sp[k])
+                        trees[i].rewire(pos + k, pos + k, sp[k]);
+                trees[i].rewire(pos, pos + length - 1, node);
+                paths[i].rewire(pos, pos + length - 1, node);
+                pending.insert(starting_with[node].begin(), starting_with[node].end());
+                reductions++;
+            }
+        }
+    }
+    updateAllConnections();
+    return reductions;
 }
 
 // RDSGraph::computeConnectionMatrix
@@ -680,33 +1054,30 @@ void RDSGraph::computeConnectionMatrix(ConnectionMatrix &connections, const Sear
     }
     // calculate subpath distributions, symmetrical matrix
     unsigned dim = search_path.size();
-    connections = ConnectionMatrix(dim, dim);
+    connections.reset(dim);
     for(unsigned int i = 0; i < dim; i++)
     {
-        connections(i, i) = getAllNodeConnections(search_path[i]);
+        connections(i, i) = getAllNodeConnections(search_path[i], connections.resource());
 
-        // compute the column from the diagonal
+        // compute the column from the diagonal (the matrix stores (i, j) and (j, i) once)
         for(unsigned int j = i + 1; j < dim; j++)
-        {
-            connections(j, i) = filterConnections(connections(j - 1, i), j-i, SearchPath(search_path(j, j)));
-            connections(i, j) = connections(j, i);
-        }
+            connections(j, i) = filterConnections(connections(j - 1, i), j-i, search_path.view(j, j));
     }
 }
 
 // RDSGraph::computeEquivalenceClass
 // Compute the equivalence class for a given search path and slot index.
 // Defensive: checks slot index bounds and ensures valid equivalence class construction
-EquivalenceClass RDSGraph::computeEquivalenceClass(const SearchPath &search_path, unsigned int slotIndex) const
+EquivalenceClass RDSGraph::computeEquivalenceClass(PathView search_path, unsigned int slotIndex, std::pmr::memory_resource *resource) const
 {
     if (!(0 < slotIndex && slotIndex < (search_path.size()-1))) {
         throw std::out_of_range("RDSGraph::computeEquivalenceClass: slotIndex out of valid range");
     }
 
     // get the candidate connections
-    vector<Connection> equivalenceConnections = getAllNodeConnections(search_path[0]);
-    equivalenceConnections = filterConnections(equivalenceConnections, 0,           SearchPath(search_path(0, slotIndex-1)));
-    equivalenceConnections = filterConnections(equivalenceConnections, slotIndex+1, SearchPath(search_path(slotIndex+1, search_path.size()-1)));
+    ConnectionList equivalenceConnections = getAllNodeConnections(search_path[0], resource);
+    equivalenceConnections = filterConnections(equivalenceConnections, 0,           search_path(0, slotIndex-1));
+    equivalenceConnections = filterConnections(equivalenceConnections, slotIndex+1, search_path(slotIndex+1, search_path.size()-1));
 
     //build equivalence class
     EquivalenceClass ec;
@@ -725,10 +1096,10 @@ EquivalenceClass RDSGraph::computeEquivalenceClass(const SearchPath &search_path
 // RDSGraph::bootstrap
 // Bootstrap the search path by finding initial equivalence classes based on overlaps.
 // Defensive: handles empty or too short search paths, updates encountered_ecs in place
-SearchPath RDSGraph::bootstrap(vector<EquivalenceClass> &encountered_ecs, const SearchPath &search_path, double overlapThreshold) const
+SearchPath RDSGraph::bootstrap(std::pmr::vector<EquivalenceClass> &encountered_ecs, PathView search_path, double overlapThreshold) const
 {
-    // find all possible connections
-    vector<Connection> equivalenceConnections = filterConnections(getAllNodeConnections(search_path[0]), search_path.size()-1, SearchPath(search_path(search_path.size()-1, search_path.size()-1)));
+    // find all possible connections (temporaries share the arena of encountered_ecs)
+    ConnectionList equivalenceConnections = filterConnections(getAllNodeConnections(search_path[0], encountered_ecs.get_allocator().resource()), search_path.size()-1, search_path(search_path.size()-1, search_path.size()-1));
 
     // find potential ECs
     encountered_ecs.clear();
@@ -745,14 +1116,16 @@ SearchPath RDSGraph::bootstrap(vector<EquivalenceClass> &encountered_ecs, const
     }
 
     // init bootstrap data
-    vector<unsigned int> overlap_ecs = search_path(1, search_path.size()-2);
+    vector<unsigned int> overlap_ecs(search_path.begin()+1, search_path.end()-1);
     vector<double> overlap_ratios(search_path.size()-2, 0.0);
 
     // bootstrap search path
-    SearchPath bootstrap_path = search_path;
+    SearchPath bootstrap_path(search_path);
     for(unsigned int i = 0; i < encountered_ecs.size(); i++)
     {
-        for(unsigned int j = 0; j < nodes.size(); j++)
+        for(unsigned int label = 0; label < nodes.size(); label++)
+        {
+            unsigned int j = nodeAt(label);  // visit in discovery order so ties resolve as before
             if(nodes[j].type == LexiconTypes::EC)
             {
                 EquivalenceClass *ec = static_cast<EquivalenceClass *>(nodes[j].lexicon.get());
@@ -763,32 +1136,133 @@ SearchPath RDSGraph::bootstrap(vector<EquivalenceClass> &encountered_ecs, const
                     overlap_ratios[i] = overlap;
                 }
             }
-        bootstrap_path[i + 1] = overlap_ecs[i];
+        }
+        bootstrap_path.set(i + 1, overlap_ecs[i]);
     }
 
     return bootstrap_path;
 }
 
+// RDSGraph::searchSignificantPatterns
+// Compute flows and descents for a connection matrix and find its significant patterns, in the
+// precision and with the significance approximation policy selected by params; counts the search
+// as approximated or uncertain (see significanceTail), uncertain too if an approximation could change
+// which pattern is best. The matrices come from the calling
+// thread's DistillWorkspace. Validate mode searches in both precisions, counts searches whose
+// significant patterns (or best pattern) differ and keeps the double-precision result.
+// Binomial tails go far below the float range (1e-200 is common), so p-values are always summed and
+// cached in double; otherwise underflowed ties would change which pattern wins.
+bool RDSGraph::searchSignificantPatterns(vector<Range> &patterns, vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const ADIOSParams &params)
+{
+    approximate_above = params.approximateAbove;
+    approximation_error = params.approximationError;
+    decision_alpha = params.alpha;
+    search_approximated = false;
+    search_uncertain = false;
+    search_error = 0.0;
+    bool found = searchSignificantPatternsIn(patterns, pvalues, connections, params);
+    // the best pattern could change if another one's p-values lie within the error bounds of its own
+    for(unsigned int i = 1; search_approximated && (i < pvalues.size()); i++)
+        if(max(pvalues[i].first, pvalues[i].second) - max(pvalues[0].first, pvalues[0].second) <= 2.0 * search_error)
+            search_uncertain = true;
+    pattern_searches++;
+    approximated_searches += search_approximated;
+    uncertain_searches += search_uncertain;
+    return found;
+}
+
+// RDSGraph::searchSignificantPatternsIn
+// searchSignificantPatterns in the precision selected by params.
+bool RDSGraph::searchSignificantPatternsIn(vector<Range> &patterns, vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const ADIOSParams &params)
+{
+    DistillWorkspace &workspace = DistillWorkspace::local();
+    if(params.precision == StatsPrecision::Double)
+    {
+        DistillWorkspace::Descents<double> &matrices = workspace.descents<double>();
+        computeDescentsMatrix(matrices.flows, matrices.descents, connections);
+        return findSignificantPatterns(patterns, pvalues, connections, matrices.flows, matrices.descents, params.eta, params.alpha);
+    }
+
+    DistillWorkspace::Descents<float> &matrices = workspace.descents<float>();
+    computeDescentsMatrix(matrices.flows, matrices.descents, connections);
+    bool found = findSignificantPatterns(patterns, pvalues, connections, matrices.flows, matrices.descents, params.eta, params.alpha);
+    if(params.precision == StatsPrecision::Single)
+        return found;
+
+    vector<Range> double_patterns;
+    vector<SignificancePair> double_pvalues;
+    DistillWorkspace::Descents<double> &double_matrices = workspace.descents<double>();
+    computeDescentsMatrix(double_matrices.flows, double_matrices.descents, connections);
+    bool double_found = findSignificantPatterns(double_patterns, double_pvalues, connections, double_matrices.flows, double_matrices.descents, params.eta, params.alpha);
+    precision_checks++;
+    if((found != double_found) || (patterns != double_patterns))
+    {
+        precision_mismatches++;
+        madios::Logger::warn("RDSGraph: single and double precision disagree on the significant patterns of a search path");
+    }
+    patterns.swap(double_patterns);
+    pvalues.swap(double_pvalues);
+    return double_found;
+}
+
+// RDSGraph::recallSearch
+// Fetch the outcome of an earlier search on the same node sequence if none of the nodes it read
+// (the path's nodes and their EC members) has changed its occurrences since, and the corpus size
+// is the same. Returns false, leaving patterns and pvalues alone, if there is no valid entry. A hit
+// is counted here, approximated or uncertain as the search it recalls, so callers must not run
+// that search again.
+bool RDSGraph::recallSearch(PathView search_path, vector<Range> &patterns, vector<SignificancePair> &pvalues)
+{
+    const SearchMemo::Outcome *outcome = search_memo.find(search_path, node_versions, corpusSize);
+    if(outcome == nullptr)
+        return false;
+    patterns = outcome->patterns;
+    pvalues = outcome->pvalues;
+    recalled_searches++;
+    approximated_searches += outcome->approximated;
+    uncertain_searches += outcome->uncertain;
+    return true;
+}
+
+// RDSGraph::rememberSearch
+// Store the outcome of the last search with the versions of the nodes its connection matrix was
+// built from.
+void RDSGraph::rememberSearch(PathView search_path, const vector<Range> &patterns, const vector<SignificancePair> &pvalues)
+{
+    vector<unsigned int> dependencies(search_path.begin(), search_path.end());
+    for(unsigned int node : search_path)
+        if(nodes[node].type == LexiconTypes::EC)
+        {
+            const EquivalenceClass *ec = static_cast<EquivalenceClass *>(nodes[node].lexicon.get());
+            dependencies.insert(dependencies.end(), ec->begin(), ec->end());
+        }
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    search_memo.store(search_path, dependencies, node_versions, corpusSize, SearchMemo::Outcome{patterns, pvalues, search_approximated, search_uncertain});
+}
+
 // RDSGraph::computeDescentsMatrix
 // Compute the descents matrix (D_R and D_L) for the connection matrix.
 // Dimensionality: len(connections) x len(connections)
-// Defensive: handles empty connections matrices and updates descents in place
-void RDSGraph::computeDescentsMatrix(TNT::Array2D<double> &flows, TNT::Array2D<double> &descents, const ConnectionMatrix &connections) const
+// Defensive: handles empty connections matrices and updates descents in place; both matrices are
+// reset to dim x dim, reusing their storage
+template <typename Real>
+void RDSGraph::computeDescentsMatrix(ScratchMatrix<Real> &flows, ScratchMatrix<Real> &descents, const ConnectionMatrix &connections) const
 {
     // calculate P_R and P_L
     unsigned dim = connections.dim1();
-    flows = TNT::Array2D<double>(dim, dim, -1.0);
+    flows.reset(dim, Real(-1));
     for(unsigned int i = 0; i < dim; i++)
         for(unsigned int j = 0; j < dim; j++)
             if(i > j)
-                flows(i, j) = static_cast<double>(connections(i, j).size()) / connections(i-1, j).size();
+                flows(i, j) = static_cast<Real>(connections(i, j).size()) / connections(i-1, j).size();
             else if(i < j)
-                flows(i, j) = static_cast<double>(connections(i, j).size()) / connections(i+1, j).size();
+                flows(i, j) = static_cast<Real>(connections(i, j).size()) / connections(i+1, j).size();
             else
-                flows(i, j) = static_cast<double>(connections(i, j).size()) / corpusSize;
+                flows(i, j) = static_cast<Real>(connections(i, j).size()) / corpusSize;
 
     // calculate D_R and D_L
-    descents = TNT::Array2D<double>(dim, dim, -1.0);
+    descents.reset(dim, Real(-1));
     for(unsigned int i = 0; i < dim; i++)
         for(unsigned int j = 0; j < dim; j++)
             if(i > j)
@@ -796,14 +1270,15 @@ void RDSGraph::computeDescentsMatrix(TNT::Array2D<double> &flows, TNT::Array2D<d
             else if(i < j)
                 descents(i, j) = flows(i, j) / flows(i+1, j);
             else
-                descents(i, j) = 1.0;
+                descents(i, j) = Real(1);
 }
 
 // RDSGraph::findSignificantPatterns
 // Find significant patterns in the given connection, flows, and descents matrices.
 // Updates patterns and pvalues with the found patterns and their significance.
 // Returns true if any patterns were found, false otherwise.
-bool RDSGraph::findSignificantPatterns(std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents, double eta, double alpha) const
+template <typename Real>
+bool RDSGraph::findSignificantPatterns(std::vector<Range> &patterns, std::vector<SignificancePair> &pvalues, const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const ScratchMatrix<Real> &descents, double eta, double alpha) const
 {
     patterns.clear();
     pvalues.clear();
@@ -839,7 +1314,8 @@ bool RDSGraph::findSignificantPatterns(std::vector<Range> &patterns, std::vector
     //for(unsigned int i = 0; i < candidatePatterns.size(); i++)
     //    std::cout << "Candidate Pattern " << i << " = " << candidatePatterns[i].first << " " << candidatePatterns[i].second << endl;
 
-    TNT::Array2D<double> pvalueCache(pathLength, pathLength, 2.0);
+    ScratchMatrix<double> &pvalueCache = DistillWorkspace::local().pvalueCache;
+    pvalueCache.reset(pathLength, 2.0);
     for(unsigned int i = 0; i < candidatePatterns.size(); i++)
     {   //std::cout << "START+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << endl;
         //std::cout << "Testing pattern at [" << candidatePatterns[i].first << " -> " << candidatePatterns[i].second << "]" << endl;
@@ -885,9 +1361,9 @@ bool RDSGraph::findSignificantPatterns(std::vector<Range> &patterns, std::vector
 // Defensive: ensures valid pattern range and alpha threshold
 vector<Connection> RDSGraph::getRewirableConnections(const ConnectionMatrix &connections, const Range &bestSP, double alpha) const
 {
-    vector<Connection> validConnections = connections(bestSP.second, bestSP.first);
+    const ConnectionList &validConnections = connections(bestSP.second, bestSP.first);
 
-    return validConnections;
+    return vector<Connection>(validConnections.begin(), validConnections.end());
 }
 
 // RDSGraph::rewire
@@ -899,25 +1375,28 @@ void RDSGraph::rewire(const std::vector<Connection> &connections, unsigned int e
         throw std::invalid_argument("RDSGraph::rewire: ec index invalid or not an EC node");
     }
 
+    vector<unsigned int> changed_paths;
+    for(unsigned int i = 0; i < connections.size(); i++)
+        changed_paths.push_back(connections[i].first);
+    vector<Connection> touched = pathNodes(changed_paths);
     for(unsigned int i = 0; i < connections.size(); i++)
-        paths[connections[i].first][connections[i].second] = ec;
+        paths[connections[i].first].set(connections[i].second, ec);
 
-    updateAllConnections();
+    updateConnections(std::move(touched));
 }
 
 void RDSGraph::rewire(const vector<Connection> &connections, const EquivalenceClass &ec)
 {
-    nodes.push_back(RDSNode(std::make_unique<EquivalenceClass>(ec), LexiconTypes::EC));
-    rewire(connections, nodes.size() - 1);
+    rewire(connections, appendNode(std::make_unique<EquivalenceClass>(ec), LexiconTypes::EC));
 }
 
 void RDSGraph::rewire(const vector<Connection> &connections, const SignificantPattern &sp)
 {
-    nodes.push_back(RDSNode(std::make_unique<SignificantPattern>(sp), LexiconTypes::SP));
+    appendNode(std::make_unique<SignificantPattern>(sp), LexiconTypes::SP);
     const SignificantPattern &pattern = sp;
 
     if (connections.empty()) {
-        std::cerr << "[RDSGraph::rewire] Warning: empty connections vector." << std::endl;
+        madios::Logger::warn("RDSGraph::rewire: empty connections vector");
         return;
     }
     unsigned int pattern_size = pattern.size();
@@ -954,7 +1433,7 @@ void RDSGraph::rewire(const vector<Connection> &connections, const SignificantPa
 
     // validate the sorted connections
     if (sorted_connections.empty()) {
-        std::cerr << "[RDSGraph::rewire] Warning: sorted_connections is empty." << std::endl;
+        madios::Logger::warn("RDSGraph::rewire: sorted_connections is empty");
         return;
     }
     vector<Connection> valid_connections;
@@ -973,6 +1452,11 @@ void RDSGraph::rewire(const vector<Connection> &connections, const SignificantPa
         valid_connections.push_back(sorted_connections[i]);
     }
     if (!quiet) std::cout << valid_connections.size() << " valid_connections" << endl;
+    vector<unsigned int> changed_paths;
+    for(const auto &connection : valid_connections)
+        if(connection.first < paths.size())
+            changed_paths.push_back(connection.first);
+    vector<Connection> touched = pathNodes(changed_paths);
 
     // rewire the connections in reverse order to avoid problems with path changing size
     for(unsigned int i = valid_connections.size()-1; i < valid_connections.size(); i--)
@@ -981,11 +1465,11 @@ void RDSGraph::rewire(const vector<Connection> &connections, const SignificantPa
         unsigned int path_pos = valid_connections[i].second;
 
         if (path_index >= paths.size()) {
-            std::cerr << "[RDSGraph::rewire] Warning: path_index out of bounds (" << path_index << "/" << paths.size() << ")" << std::endl;
+            madios::Logger::warn("RDSGraph::rewire: path_index out of bounds (" + std::to_string(path_index) + "/" + std::to_string(paths.size()) + ")");
             continue;
         }
         if (path_pos + pattern_size - 1 >= paths[path_index].size()) {
-            std::cerr << "[RDSGraph::rewire] Warning: path_pos out of bounds (" << path_pos << "/" << paths[path_index].size() << ")" << std::endl;
+            madios::Logger::warn("RDSGraph::rewire: path_pos out of bounds (" + std::to_string(path_pos) + "/" + std::to_string(paths[path_index].size()) + ")");
             continue;
         }
         // rewiring the parse trees
@@ -999,30 +1483,125 @@ void RDSGraph::rewire(const vector<Connection> &connections, const SignificantPa
         paths[path_index].rewire(path_pos, path_pos+pattern_size-1, nodes.size()-1);
     }
 
-    updateAllConnections();
+    updateConnections(std::move(touched));
 }
 
 // RDSGraph::updateAllConnections
-// Update all connections and parent links in the graph after any modification.
+// Rebuild all connections and parent links in the graph after any modification.
 // Defensive: ensures consistent internal state
 void RDSGraph::updateAllConnections()
 {
+    // keep the old occurrence lists to find the nodes whose occurrences changed
+    vector<ConnectionList> previous;
+    previous.reserve(nodes.size());
     for(unsigned int i = 0; i < nodes.size(); i++)
     {
-        nodes[i].setConnections(vector<Connection>());
-        nodes[i].parents.clear();
+        previous.push_back(std::move(nodes[i].connections));
+        nodes[i].connections.clear();
     }
 
-    corpusSize = 0;
-    for(unsigned int i = 0; i < paths.size(); i++)
+    // occurrence lists are kept in corpus order whatever the storage layout
+    corpusSize = external_corpus_size;
+    for(unsigned int k = 0; k < paths.size(); k++)
     {
+        unsigned int i = pathAt(k);
         corpusSize += paths[i].size();
          for(unsigned int j = 0; j < paths[i].size(); j++)
              nodes[paths[i][j]].addConnection(Connection(i, j));
     }
-
+    node_versions.resize(nodes.size(), 0);
+    node_paths.resize(nodes.size());
     for(unsigned int i = 0; i < nodes.size(); i++)
+        if(nodes[i].connections != previous[i])
+        {
+            node_versions[i]++;
+            node_paths[i].assign(nodes[i].connections, paths.size());
+        }
+
+    updateParents();
+}
+
+// RDSGraph::pathNodes
+// The (node, path) pairs of the given paths. Taken before the paths change, they name the nodes
+// that can lose occurrences, which updateConnections needs besides the nodes on the new paths.
+vector<Connection> RDSGraph::pathNodes(const vector<unsigned int> &path_ids) const
+{
+    vector<Connection> touched;
+    for(unsigned int path : path_ids)
+        for(unsigned int node : paths[path])
+            touched.push_back(Connection(node, path));
+    return touched;
+}
+
+// RDSGraph::updateConnections
+// Update the connections after some paths changed, given their (node, path) pairs from before the
+// change (see pathNodes). Only the occurrences of those nodes on those paths are replaced, so the
+// cost follows the changed paths rather than the corpus. The result, including node versions and
+// the corpus size, is the same as updateAllConnections'.
+void RDSGraph::updateConnections(vector<Connection> touched)
+{
+    node_versions.resize(nodes.size(), 0);
+    node_paths.resize(nodes.size());
+    vector<unsigned int> changed_paths;
+    for(const auto &pair : touched)
+        changed_paths.push_back(pair.second);
+    std::sort(changed_paths.begin(), changed_paths.end());
+    changed_paths.erase(std::unique(changed_paths.begin(), changed_paths.end()), changed_paths.end());
+    vector<Connection> touched_now = pathNodes(changed_paths);
+    touched.insert(touched.end(), touched_now.begin(), touched_now.end());
+    // by node, then by path in corpus order, which is the order of an occurrence list
+    std::sort(touched.begin(), touched.end(), [this](const Connection &a, const Connection &b) {
+        return (a.first != b.first) ? (a.first < b.first) : (pathRank(a.second) < pathRank(b.second));
+    });
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    auto byRank = [this](const Connection &a, const Connection &b) { return pathRank(a.first) < pathRank(b.first); };
+    long long removed = 0, added = 0;
+    ConnectionList occurrences;
+    for(std::size_t t = 0; t < touched.size(); )
+    {
+        unsigned int node = touched[t].first;
+        ConnectionList &list = nodes[node].connections;
+        bool changed = false;
+        for(; (t < touched.size()) && (touched[t].first == node); t++)
+        {
+            unsigned int path = touched[t].second;
+            occurrences.clear();
+            for(unsigned int j = 0; j < paths[path].size(); j++)
+                if(paths[path][j] == node)
+                    occurrences.push_back(Connection(path, j));
+            auto range = std::equal_range(list.begin(), list.end(), Connection(path, 0), byRank);
+            std::size_t count = range.second - range.first;
+            removed += count;
+            added += occurrences.size();
+            if((count == occurrences.size()) && std::equal(occurrences.begin(), occurrences.end(), range.first))
+                continue;
+            changed = true;
+            if(count == occurrences.size())
+                std::copy(occurrences.begin(), occurrences.end(), range.first);
+            else
+                list.insert(list.erase(range.first, range.second), occurrences.begin(), occurrences.end());
+        }
+        if(changed)
+        {
+            node_versions[node]++;
+            node_paths[node].assign(list, paths.size());
+        }
+    }
+    corpusSize += added - removed;
+
+    updateParents();
+}
+
+// RDSGraph::updateParents
+// Rebuild the parent links from the SPs and ECs, in node label order.
+void RDSGraph::updateParents()
+{
+    for(auto &node : nodes)
+        node.parents.clear();
+    for(unsigned int label = 0; label < nodes.size(); label++)
     {
+        unsigned int i = nodeAt(label);
         if(nodes[i].type == LexiconTypes::SP)
         {
             SignificantPattern *sp = static_cast<SignificantPattern *>(nodes[i].lexicon.get());
@@ -1038,20 +1617,293 @@ void RDSGraph::updateAllConnections()
     }
 }
 
+// RDSGraph::appendNode
+// Append a new node and return its index. New nodes keep their own index as their label.
+unsigned int RDSGraph::appendNode(std::unique_ptr<LexiconUnit> lexicon, LexiconTypes::LexiconEnum type)
+{
+    nodes.push_back(RDSNode(std::move(lexicon), type, storage()));
+    unsigned int index = nodes.size() - 1;
+    if(!node_labels.empty())
+    {
+        node_labels.push_back(index);
+        node_order.push_back(index);
+    }
+    return index;
+}
+
+// RDSGraph::storage
+// Memory resource for paths, occurrence lists and parse trees: the store if out-of-core, else the heap.
+std::pmr::memory_resource* RDSGraph::storage() const
+{
+    if(store)
+        return store.get();
+    return std::pmr::get_default_resource();
+}
+
+// RDSGraph::selectResidentNodes
+// Out-of-core residency policy, applied at the start of each pass: the nodes with the most
+// occurrences, whose lists nearly every search reads, are kept resident up to the store's budget
+// (read in now and never advised cold); all other lists are cooled by adviseScan after use.
+void RDSGraph::selectResidentNodes()
+{
+    if(!store)
+        return;
+    vector<unsigned int> by_frequency(nodes.size());
+    std::iota(by_frequency.begin(), by_frequency.end(), 0);
+    std::stable_sort(by_frequency.begin(), by_frequency.end(), [this](unsigned int a, unsigned int b) {
+        return nodes[a].connections.size() > nodes[b].connections.size();
+    });
+    resident_nodes.assign(nodes.size(), 0);
+    std::size_t budget = store->residentBudget();
+    for(unsigned int node : by_frequency)
+    {
+        std::size_t bytes = nodes[node].connections.capacity() * sizeof(Connection);
+        if(bytes > budget)
+            continue;
+        budget -= bytes;
+        resident_nodes[node] = 1;
+        store->advise(nodes[node].connections.data(), bytes, MappedStore::Access::WillNeed);
+    }
+}
+
+// RDSGraph::adviseScan
+// Out-of-core page hints that follow the scan order, before path k (corpus order) is distilled:
+// the previous path and the lists only it used are advised cold, and the next path and its
+// lists are read ahead while path k is searched.
+void RDSGraph::adviseScan(unsigned int k)
+{
+    if(!store)
+        return;
+    auto resident = [this](unsigned int node) { return (node < resident_nodes.size()) && resident_nodes[node]; };
+    const SearchPath &current = paths[pathAt(k)];
+    const SearchPath *next = (k + 1 < paths.size()) ? &paths[pathAt(k + 1)] : nullptr;
+    if(k > 0)
+    {
+        const SearchPath &previous = paths[pathAt(k - 1)];
+        for(unsigned int node : previous)
+            if(!resident(node) && (std::find(current.begin(), current.end(), node) == current.end()) &&
+               ((next == nullptr) || (std::find(next->begin(), next->end(), node) == next->end())))
+                store->advise(nodes[node].connections.data(), nodes[node].connections.size() * sizeof(Connection), MappedStore::Access::Cold);
+        store->advise(previous.data(), previous.size() * sizeof(unsigned int), MappedStore::Access::Cold);
+    }
+    if(next != nullptr)
+    {
+        store->advise(next->data(), next->size() * sizeof(unsigned int), MappedStore::Access::WillNeed);
+        for(unsigned int node : *next)
+            if(!resident(node))
+                store->advise(nodes[node].connections.data(), nodes[node].connections.size() * sizeof(Connection), MappedStore::Access::WillNeed);
+    }
+}
+
+// RDSGraph::logUnitEvent
+// Record the creation of an SP or EC node, with the significance of the pattern that created it and
+// its occurrences in the search paths.
+void RDSGraph::logUnitEvent(unsigned int node, const SignificancePair &pvalues, unsigned int occurrences) const
+{
+    if(!event_log)
+        return;
+    PatternEvent event;
+    bool is_pattern = (nodes[node].type == LexiconTypes::SP);
+    event.type = is_pattern ? "SP" : "EC";
+    event.id = nodeLabel(node);
+    event.name = printNodeName(node);
+    const vector<unsigned int> &members = is_pattern
+        ? static_cast<const vector<unsigned int> &>(*static_cast<SignificantPattern *>(nodes[node].lexicon.get()))
+        : static_cast<const vector<unsigned int> &>(*static_cast<EquivalenceClass *>(nodes[node].lexicon.get()));
+    for(unsigned int member : members)
+        event.members.push_back(printNodeName(member));
+    event.leftPValue = pvalues.first;
+    event.rightPValue = pvalues.second;
+    event.occurrences = occurrences;
+    event.iteration = current_iteration;
+    event_log->record(std::move(event));
+}
+
+// RDSGraph::logProgressEvent
+// Record the end of an iteration ("iteration") or of the run ("end") with the number of units learned.
+void RDSGraph::logProgressEvent(const std::string &type) const
+{
+    if(!event_log)
+        return;
+    PatternEvent event;
+    event.type = type;
+    event.iteration = current_iteration;
+    for(const auto &node : nodes)
+    {
+        if(node.type == LexiconTypes::SP) event.patterns++;
+        else if(node.type == LexiconTypes::EC) event.classes++;
+    }
+    event_log->record(std::move(event));
+}
+
+// RDSGraph::relayout
+// Renumber nodes by occurrence count (hottest first) and store paths grouped by their two
+// hottest anchors, so that occurrence scans in filterConnections touch fewer cache lines and pages.
+// The start and end symbols keep ids 0 and 1.
+void RDSGraph::relayout()
+{
+    if((nodes.size() < 3) || paths.empty())
+        return;
+    madios::Logger::trace("Entering RDSGraph::relayout");
+
+    vector<unsigned int> ranked;
+    for(unsigned int label = 2; label < nodes.size(); label++)
+        ranked.push_back(nodeAt(label));
+    std::stable_sort(ranked.begin(), ranked.end(), [this](unsigned int a, unsigned int b) {
+        return nodes[a].connections.size() > nodes[b].connections.size();
+    });
+    vector<unsigned int> new_index(nodes.size());
+    new_index[0] = 0;
+    new_index[1] = 1;
+    for(unsigned int r = 0; r < ranked.size(); r++)
+        new_index[ranked[r]] = r + 2;
+
+    // sort key: (hottest anchor, second hottest anchor, corpus index)
+    vector<pair<pair<unsigned int, unsigned int>, unsigned int> > keys;
+    keys.reserve(paths.size());
+    for(unsigned int k = 0; k < paths.size(); k++)
+    {
+        unsigned int first = nodes.size(), second = nodes.size();
+        for(unsigned int node : paths[pathAt(k)])
+        {
+            unsigned int id = new_index[node];
+            if(id < 2) continue;
+            if(id < first) { second = first; first = id; }
+            else if((id > first) && (id < second)) second = id;
+        }
+        keys.push_back(std::make_pair(std::make_pair(first, second), k));
+    }
+    std::sort(keys.begin(), keys.end());
+    vector<unsigned int> new_path_order(paths.size());
+    for(unsigned int slot = 0; slot < keys.size(); slot++)
+        new_path_order[keys[slot].second] = slot;
+
+    applyLayout(new_index, new_path_order);
+    madios::Logger::trace("Exiting RDSGraph::relayout");
+}
+
+// RDSGraph::restoreLayout
+// Put nodes back at their discovery-order ids and paths back in corpus order.
+void RDSGraph::restoreLayout()
+{
+    if(!isRelaidOut())
+        return;
+    vector<unsigned int> new_path_order(paths.size());
+    for(unsigned int k = 0; k < paths.size(); k++)
+        new_path_order[k] = k;
+    applyLayout(vector<unsigned int>(node_labels), new_path_order);
+}
+
+// RDSGraph::applyLayout
+// Move node i to slot new_index[i] and the k-th corpus path to slot new_path_order[k], translating
+// every stored node id. Paths and occurrence lists are copied into fresh buffers in the new order.
+void RDSGraph::applyLayout(const vector<unsigned int> &new_index, const vector<unsigned int> &new_path_order)
+{
+    // nodes, paths and trees are move-constructed into place, so that they keep their memory resource
+    vector<unsigned int> old_index(nodes.size());
+    vector<unsigned int> new_labels(nodes.size());
+    bool canonical = true;
+    for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+        old_index[new_index[i]] = i;
+        new_labels[new_index[i]] = nodeLabel(i);
+        canonical = canonical && (new_index[i] == nodeLabel(i));
+    }
+    vector<RDSNode> new_nodes;
+    new_nodes.reserve(nodes.size());
+    for(unsigned int i = 0; i < nodes.size(); i++)
+        new_nodes.push_back(std::move(nodes[old_index[i]]));
+    nodes.swap(new_nodes);
+    for(auto &node : nodes)
+        if((node.type == LexiconTypes::SP) || (node.type == LexiconTypes::EC))
+        {
+            // SignificantPattern and EquivalenceClass are both unit vectors
+            std::vector<unsigned int> &units = (node.type == LexiconTypes::SP)
+                ? static_cast<std::vector<unsigned int> &>(*static_cast<SignificantPattern *>(node.lexicon.get()))
+                : static_cast<std::vector<unsigned int> &>(*static_cast<EquivalenceClass *>(node.lexicon.get()));
+            for(auto &unit : units)
+                unit = new_index[unit];
+        }
+    for(auto &sp : significant_patterns)
+        for(auto &unit : sp)
+            unit = new_index[unit];
+    if(counts.size() == nodes.size())
+    {
+        vector<vector<unsigned int> > new_counts(counts.size());
+        for(unsigned int i = 0; i < counts.size(); i++)
+            new_counts[new_index[i]].swap(counts[i]);
+        counts.swap(new_counts);
+    }
+    if(node_paths.size() == nodes.size())
+    {
+        // moved with their nodes; updateAllConnections rebuilds those whose path slots change
+        vector<PathSet> new_node_paths(node_paths.size());
+        for(unsigned int i = 0; i < node_paths.size(); i++)
+            new_node_paths[new_index[i]] = std::move(node_paths[i]);
+        node_paths.swap(new_node_paths);
+    }
+
+    vector<unsigned int> old_slot(paths.size());
+    for(unsigned int k = 0; k < paths.size(); k++)
+    {
+        old_slot[new_path_order[k]] = pathAt(k);
+        canonical = canonical && (new_path_order[k] == k);
+    }
+    vector<SearchPath> new_paths;
+    vector<ParseTree<unsigned int> > new_trees;
+    new_paths.reserve(paths.size());
+    new_trees.reserve(trees.size());
+    for(unsigned int slot = 0; slot < paths.size(); slot++)
+    {
+        new_paths.push_back(std::move(paths[old_slot[slot]]));
+        new_paths.back().relabel(new_index);
+        if(old_slot[slot] < trees.size())
+        {
+            new_trees.push_back(std::move(trees[old_slot[slot]]));
+            new_trees.back().relabel(new_index);
+        }
+    }
+    paths.swap(new_paths);
+    trees.swap(new_trees);
+    search_memo.clear();  // memo keys are node ids
+
+    if(canonical)
+    {
+        node_labels.clear();
+        node_order.clear();
+        path_order.clear();
+        path_ranks.clear();
+    }
+    else
+    {
+        node_labels.swap(new_labels);
+        node_order.assign(nodes.size(), 0);
+        for(unsigned int i = 0; i < nodes.size(); i++)
+            node_order[node_labels[i]] = i;
+        path_order = new_path_order;
+        path_ranks.assign(paths.size(), 0);
+        for(unsigned int k = 0; k < paths.size(); k++)
+            path_ranks[path_order[k]] = k;
+    }
+
+    updateAllConnections();
+    for(auto &node : nodes)
+        ConnectionList(node.connections, node.connections.get_allocator()).swap(node.connections);
+}
+
 // RDSGraph::computeRightSignificance
 // Compute the right significance for a given descent point using the connections and flows matrices.
 // Defensive: ensures valid row/column indices
-double RDSGraph::computeRightSignificance(const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const pair<unsigned int, unsigned int> &descentPoint, double eta) const
+template <typename Real>
+double RDSGraph::computeRightSignificance(const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const pair<unsigned int, unsigned int> &descentPoint, double eta) const
 {
     unsigned int row = descentPoint.first;
     unsigned int col = descentPoint.second;
     assert(row > col);
 
-    double significance = 0.0;
     unsigned int patternOccurences = connections(row - 1, col).size();
     unsigned int descentOccurences = connections(row, col).size();
-    for(unsigned int i = 0; i <= descentOccurences; i++)
-        significance += binom(i, patternOccurences, eta * flows(row - 1, col));
+    double significance = significanceTail(descentOccurences, patternOccurences, eta * flows(row - 1, col));
 
     return min(max(significance, 0.0), 1.0);
 }
@@ -1059,26 +1911,45 @@ double RDSGraph::computeRightSignificance(const ConnectionMatrix &connections, c
 // RDSGraph::computeLeftSignificance
 // Compute the left significance for a given descent point using the connections and flows matrices.
 // Defensive: ensures valid row/column indices
-double RDSGraph::computeLeftSignificance(const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const pair<unsigned int, unsigned int> &descentPoint, double eta) const
+template <typename Real>
+double RDSGraph::computeLeftSignificance(const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const pair<unsigned int, unsigned int> &descentPoint, double eta) const
 {
     unsigned int row = descentPoint.first;
     unsigned int col = descentPoint.second;
     assert(row < col);
 
-    double significance = 0.0;
     unsigned int patternOccurences = connections(row + 1, col).size();
     unsigned int descentOccurences = connections(row, col).size();
-    for(unsigned int i = 0; i <= descentOccurences; i++)
-        significance += binom(i, patternOccurences, eta * flows(row + 1, col));
+    double significance = significanceTail(descentOccurences, patternOccurences, eta * flows(row + 1, col));
 
-    return min(max(significance, 0.0), 1.0);;
+    return min(max(significance, 0.0), 1.0);
+}
+
+// RDSGraph::significanceTail
+// Binomial tail P(X <= descentOccurences), X ~ Bin(patternOccurences, p), exact or approximated under
+// the policy of the running search. An approximated tail within its error bound of alpha marks the
+// search as uncertain: its decision could differ from exact mode (searchSignificantPatterns also
+// checks the ranking against search_error).
+double RDSGraph::significanceTail(unsigned int descentOccurences, unsigned int patternOccurences, double p) const
+{
+    double error = 0.0;
+    double tail = binom_tail(descentOccurences, patternOccurences, p, approximate_above, approximation_error, error);
+    if(error > 0.0)
+    {
+        search_approximated = true;
+        search_error = max(search_error, error);
+        if(std::fabs(min(max(tail, 0.0), 1.0) - decision_alpha) <= error)
+            search_uncertain = true;
+    }
+    return tail;
 }
 
 // RDSGraph::findBestRightDescentColumn
 // Find the best right descent column for a given pattern and descent context.
 // Updates bestColumn with the column index of the best descent.
 // Defensive: ensures valid pattern and descent context
-double RDSGraph::findBestRightDescentColumn(unsigned int &bestColumn, TNT::Array2D<double> &pvalueCache, const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents, const Range &pattern, double eta) const
+template <typename Real>
+double RDSGraph::findBestRightDescentColumn(unsigned int &bestColumn, ScratchMatrix<double> &pvalueCache, const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const ScratchMatrix<Real> &descents, const Range &pattern, double eta) const
 {
     double pvalue = 2.0;
     pair<unsigned int, unsigned int> descentPoint(pattern.second + 1, bestColumn);
@@ -1103,7 +1974,8 @@ double RDSGraph::findBestRightDescentColumn(unsigned int &bestColumn, TNT::Array
 // Find the best left descent column for a given pattern and descent context.
 // Updates bestColumn with the column index of the best descent.
 // Defensive: ensures valid pattern and descent context
-double RDSGraph::findBestLeftDescentColumn(unsigned int &bestColumn, TNT::Array2D<double> &pvalueCache, const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents, const Range &pattern, double eta) const
+template <typename Real>
+double RDSGraph::findBestLeftDescentColumn(unsigned int &bestColumn, ScratchMatrix<double> &pvalueCache, const ConnectionMatrix &connections, const ScratchMatrix<Real> &flows, const ScratchMatrix<Real> &descents, const Range &pattern, double eta) const
 {
     double pvalue = 2.0;
     pair<unsigned int, unsigned int> descentPoint(pattern.first - 1, bestColumn);
@@ -1126,14 +1998,72 @@ double RDSGraph::findBestLeftDescentColumn(unsigned int &bestColumn, TNT::Array2
 
 // RDSGraph::filterConnections
 // Filter the initial connections based on the given search path and offset.
-// Returns a vector of connections that match the search path segment.
-vector<Connection> RDSGraph::filterConnections(const vector<Connection> &init_cons, unsigned int start_offset, const SearchPath &search_path) const
+// Returns the connections that match the search path segment, allocated like init_cons.
+ConnectionList RDSGraph::filterConnections(const ConnectionList &init_cons, unsigned int start_offset, PathView search_path) const
 {
-    vector<Connection> filtered_cons;
+    ConnectionList filtered_cons(init_cons.get_allocator());
+    bool has_ec = false;
+    for(unsigned int node : search_path)
+        if(nodes[node].type == LexiconTypes::EC)
+        {
+            has_ec = true;
+            break;
+        }
+
+    // paths without every plain node of the segment cannot match; skip them without reading them
+    std::pmr::vector<unsigned int> candidates(init_cons.get_allocator().resource());
+    bool prune = candidatePaths(search_path, init_cons.size(), candidates);
+    if(prune && candidates.empty())
+        return filtered_cons;
+    // occurrence lists are in corpus order, which is path order unless relaid out: walk the
+    // candidates with a cursor and restart with a binary search only when the order goes back
+    auto cursor = candidates.cbegin();
+    auto candidate = [&](unsigned int path) {
+        if(!prune)
+            return true;
+        if((cursor != candidates.cbegin()) && (*(cursor - 1) >= path))
+            cursor = std::lower_bound(candidates.cbegin(), cursor, path);
+        while((cursor != candidates.cend()) && (*cursor < path))
+            ++cursor;
+        return (cursor != candidates.cend()) && (*cursor == path);
+    };
+
+    // fast path: without EC slots a match is plain equality of ids, checked with vector compares
+    if(!has_ec)
+    {
+        const unsigned int *segment = search_path.data();
+        const unsigned int length = search_path.size();
+        for(unsigned int i = 0; i < init_cons.size(); i++)
+        {
+            if(prune)
+            {
+                if(!candidate(init_cons[i].first))
+                    continue;
+            }
+            else
+            {
+                if(i + 2 < init_cons.size())
+                    prefetchRead(&paths[init_cons[i+2].first]);
+                if(i + 1 < init_cons.size())
+                    prefetchRead(paths[init_cons[i+1].first].data() + init_cons[i+1].second + start_offset);
+            }
+
+            const SearchPath &cur_path = paths[init_cons[i].first];
+            unsigned int window_start = init_cons[i].second + start_offset;
+            if((window_start + length) > cur_path.size())
+                continue;
+            if(segmentEquals(segment, cur_path.data() + window_start, length))
+                filtered_cons.push_back(init_cons[i]);
+        }
+        return filtered_cons;
+    }
+
     for(unsigned int i = 0; i < init_cons.size(); i++)
     {
         unsigned int cur_path = init_cons[i].first;
         unsigned int cur_pos = init_cons[i].second;
+        if(!candidate(cur_path))
+            continue;
 
         // discard current connection because the path is not long enough to match the search path (segment)
         if((cur_pos+start_offset+search_path.size()) > paths[cur_path].size())
@@ -1163,15 +2093,39 @@ vector<Connection> RDSGraph::filterConnections(const vector<Connection> &init_co
     return filtered_cons;
 }
 
+// RDSGraph::candidatePaths
+// Intersect the path sets of the segment's plain (non-EC) nodes into candidates, if that can prune
+// a scan of the given number of occurrences: the list must be long and the rarest node must occur
+// on fewer paths than a quarter of it. Returns false, leaving candidates empty, if not worth it.
+bool RDSGraph::candidatePaths(PathView segment, std::size_t occurrences, std::pmr::vector<unsigned int> &candidates) const
+{
+    const std::size_t min_occurrences = 64;
+    if((occurrences < min_occurrences) || (node_paths.size() != nodes.size()))
+        return false;
+    std::pmr::vector<const PathSet*> sets(candidates.get_allocator().resource());
+    std::size_t rarest = occurrences;
+    for(unsigned int node : segment)
+        if(nodes[node].type != LexiconTypes::EC)
+        {
+            sets.push_back(&node_paths[node]);
+            rarest = min(rarest, node_paths[node].size());
+        }
+    if(sets.empty() || (rarest * 4 >= occurrences))
+        return false;
+    PathSet::intersect(sets, candidates);
+    return true;
+}
+
 // RDSGraph::getAllNodeConnections
 // Get all connections for a given node, including those from its equivalence class if applicable.
 // Defensive: ensures valid node index and handles empty connection sets
-vector<Connection> RDSGraph::getAllNodeConnections(unsigned int nodeIndex) const
+ConnectionList RDSGraph::getAllNodeConnections(unsigned int nodeIndex, std::pmr::memory_resource *resource) const
 {
     if (nodeIndex >= nodes.size()) {
         throw std::out_of_range("RDSGraph::getAllNodeConnections: nodeIndex out of bounds");
     }
-    vector<Connection> connections = nodes[nodeIndex].getConnections();
+    const ConnectionList &own = nodes[nodeIndex].getConnections();
+    ConnectionList connections(own.begin(), own.end(), resource);
 
     //get all connections belonging to the nodes in the equivalence class
     if(nodes[nodeIndex].type == LexiconTypes::EC)
@@ -1179,7 +2133,7 @@ vector<Connection> RDSGraph::getAllNodeConnections(unsigned int nodeIndex) const
         EquivalenceClass *ec = static_cast<EquivalenceClass *>(nodes[nodeIndex].lexicon.get());
         for(unsigned int i = 0; i < ec->size(); i++)
         {
-            vector<Connection> tempConnections = nodes[ec->at(i)].getConnections();
+            const ConnectionList &tempConnections = nodes[ec->at(i)].getConnections();
             connections.insert(connections.end(), tempConnections.begin(), tempConnections.end());
         }
     }
@@ -1192,40 +2146,50 @@ vector<Connection> RDSGraph::getAllNodeConnections(unsigned int nodeIndex) const
 // Returns the index of the found equivalence class, or nodes.size() if none found.
 unsigned int RDSGraph::findExistingEquivalenceClass(const EquivalenceClass &ec) const
 {
-    // look for the existing ec that is a subset of the given ec
-    for(unsigned int i = 0; i < nodes.size(); i++)
+    // look for the existing ec that is a subset of the given ec (first in discovery order)
+    for(unsigned int label = 0; label < nodes.size(); label++)
+    {
+        unsigned int i = nodeAt(label);
         if(nodes[i].type == LexiconTypes::EC)
         {
             EquivalenceClass *temp_ec = static_cast<EquivalenceClass *>(nodes[i].lexicon.get());
             if(ec.computeOverlapEC(*temp_ec).size() == temp_ec->size())
                 return i;
         }
+    }
 
     return nodes.size();
 }
 
 // RDSGraph::estimateProbabilities
 // Recompute the counts for all nodes based on the current parse trees.
-// Defensive: clears counts before filling, robust to out-of-bounds.
 void RDSGraph::estimateProbabilities()
 {
-    counts.clear();
+    counts = computeCounts();
+}
+
+// RDSGraph::computeCounts
+// Count how often each EC alternative (and every other unit) is used in the current parse trees.
+// Defensive: robust to out-of-bounds node values.
+vector<vector<unsigned int> > RDSGraph::computeCounts() const
+{
+    vector<vector<unsigned int> > node_counts;
     for(unsigned int i = 0; i < nodes.size(); i++)
         if(nodes[i].type == LexiconTypes::EC)
         {
             EquivalenceClass *ec = static_cast<EquivalenceClass *>(nodes[i].lexicon.get());
-            counts.push_back(vector<unsigned int>(ec->size(), 0));
+            node_counts.push_back(vector<unsigned int>(ec->size(), 0));
         }
         else
-            counts.push_back(vector<unsigned int>(1, 0));
+            node_counts.push_back(vector<unsigned int>(1, 0));
     for(unsigned int i = 0; i < trees.size(); i++)
     {
-        const vector<ParseNode<unsigned int> > &tree_nodes = trees[i].nodes();
+        const ParseTree<unsigned int>::NodeList &tree_nodes = trees[i].nodes();
         for(unsigned int j = 1; j < tree_nodes.size(); j++)
         {
             unsigned int node_index = tree_nodes[j].value();
             if(node_index >= nodes.size()) {
-                std::cerr << "[RDSGraph::estimateProbabilities] Warning: node_index out of bounds (" << node_index << "/" << nodes.size() << ")" << std::endl;
+                madios::Logger::warn("RDSGraph::computeCounts: node_index out of bounds (" + std::to_string(node_index) + "/" + std::to_string(nodes.size()) + ")");
                 continue;
             }
             if(nodes[node_index].type == LexiconTypes::EC)
@@ -1235,13 +2199,14 @@ void RDSGraph::estimateProbabilities()
                 unsigned int first_child_pos = tree_nodes[j].children().front();
                 unsigned int first_child_val = tree_nodes[first_child_pos].value();
                 for(unsigned int k = 0; k < ec->size(); k++)
-                    if(ec->at(k) == first_child_val && node_index < counts.size() && k < counts[node_index].size())
-                        counts[node_index][k]++;
+                    if(ec->at(k) == first_child_val && node_index < node_counts.size() && k < node_counts[node_index].size())
+                        node_counts[node_index][k]++;
             }
-            else if(node_index < counts.size() && 0 < counts[node_index].size())
-                counts[node_index][0]++;
+            else if(node_index < node_counts.size() && 0 < node_counts[node_index].size())
+                node_counts[node_index][0]++;
         }
     }
+    return node_counts;
 }
 
 // RDSGraph::printSignificantPattern
@@ -1255,9 +2220,9 @@ string RDSGraph::printSignificantPattern(const SignificantPattern &sp) const
         if (tempIndex >= nodes.size()) {
             sout << "[INVALID_INDEX:" << tempIndex << "]";
         } else if(nodes[tempIndex].type == LexiconTypes::EC) {
-            sout << "E" << tempIndex;
+            sout << "E" << nodeLabel(tempIndex);
         } else if(nodes[tempIndex].type == LexiconTypes::SP) {
-            sout << "P" << tempIndex;
+            sout << "P" << nodeLabel(tempIndex);
         } else if(nodes[tempIndex].type == LexiconTypes::Symbol) {
             BasicSymbol* sym = static_cast<BasicSymbol*>(nodes[tempIndex].lexicon.get());
             sout << sym->getSymbol();
@@ -1284,9 +2249,9 @@ string RDSGraph::printEquivalenceClass(const EquivalenceClass &ec) const
         if (tempIndex >= nodes.size()) {
             sout << "[INVALID_INDEX:" << tempIndex << "]";
         } else if(nodes[tempIndex].type == LexiconTypes::EC) {
-            sout << "E" << tempIndex;
+            sout << "E" << nodeLabel(tempIndex);
         } else if(nodes[tempIndex].type == LexiconTypes::SP) {
-            sout << "P" << tempIndex;
+            sout << "P" << nodeLabel(tempIndex);
         } else if(nodes[tempIndex].type == LexiconTypes::Symbol) {
             BasicSymbol* sym = static_cast<BasicSymbol*>(nodes[tempIndex].lexicon.get());
             sout << sym->getSymbol();
@@ -1353,9 +2318,9 @@ string RDSGraph::printPath(const SearchPath &path) const
         if (tempIndex >= nodes.size()) {
             sout << "[INVALID_INDEX:" << tempIndex << "]";
         } else if(nodes[tempIndex].type == LexiconTypes::EC) {
-            sout << "E" << tempIndex;
+            sout << "E" << nodeLabel(tempIndex);
         } else if(nodes[tempIndex].type == LexiconTypes::SP) {
-            sout << "P" << tempIndex;
+            sout << "P" << nodeLabel(tempIndex);
         } else if(nodes[tempIndex].type == LexiconTypes::Symbol) {
             BasicSymbol* sym = static_cast<BasicSymbol*>(nodes[tempIndex].lexicon.get());
             sout << sym->getSymbol();
@@ -1382,9 +2347,9 @@ std::string RDSGraph::printNodeName(unsigned int node) const
         return sout.str();
     }
     if(nodes[node].type == LexiconTypes::EC) {
-        sout << "E" << node;
+        sout << "E" << nodeLabel(node);
     } else if(nodes[node].type == LexiconTypes::SP) {
-        sout << "P" << node;
+        sout << "P" << nodeLabel(node);
     } else if(nodes[node].type == LexiconTypes::Symbol) {
         BasicSymbol* sym = static_cast<BasicSymbol*>(nodes[node].lexicon.get());
         sout << sym->getSymbol();
@@ -1399,7 +2364,7 @@ std::string RDSGraph::printNodeName(unsigned int node) const
 }
 
 // Utility: Print connections, flows, and descents matrices for debugging
-void printInfo(const ConnectionMatrix &connections, const TNT::Array2D<double> &flows, const TNT::Array2D<double> &descents)
+void printInfo(const ConnectionMatrix &connections, const ScratchMatrix<double> &flows, const ScratchMatrix<double> &descents)
 {
     std::cout << "Connections:" << std::endl;
     for(int i = 0; i < connections.dim1(); i++)
@@ -1457,23 +2422,460 @@ unsigned int RDSGraph::getRewiringCount() const {
 std::unique_ptr<RDSGraph> RDSGraph::clone() const {
     // Deep copy the RDSGraph, including all nodes, paths, and parse trees.
     auto new_graph = std::make_unique<RDSGraph>();
+    new_graph->store = store;
     new_graph->corpusSize = corpusSize;
+    new_graph->external_corpus_size = external_corpus_size;
     new_graph->quiet = quiet;
     new_graph->counts = counts;
+    new_graph->node_paths = node_paths;
     new_graph->significant_patterns = significant_patterns;
     new_graph->rewiring_ops = rewiring_ops;
+    new_graph->node_labels = node_labels;
+    new_graph->node_order = node_order;
+    new_graph->path_order = path_order;
+    new_graph->path_ranks = path_ranks;
 
-    // Deep copy nodes
+    // Deep copy nodes, paths and parse trees into the same storage as this graph
+    std::pmr::memory_resource *resource = storage();
     new_graph->nodes.reserve(nodes.size());
     for (const auto& node : nodes) {
-        new_graph->nodes.emplace_back(node); // RDSNode copy constructor does deep copy
+        new_graph->nodes.emplace_back(node, resource); // RDSNode copy constructor does deep copy
+    }
+    new_graph->paths.reserve(paths.size());
+    for (const auto& path : paths) {
+        new_graph->paths.emplace_back(path, SearchPath::allocator_type(resource));
+    }
+    new_graph->trees.reserve(trees.size());
+    for (const auto& tree : trees) {
+        new_graph->trees.emplace_back(tree, resource);
+    }
+
+    return new_graph;
+}
+
+// ===================== Partitioned distillation =====================
+
+/**
+ * @brief Group the paths into components that cannot influence each other's patterns.
+ * Nodes are merged with a union-find over the nodes of every path (without * and #) and the
+ * members of every SP and EC.
+ * @return Path indices of each component in corpus order, components ordered by their first path
+ */
+vector<vector<unsigned int> > RDSGraph::partition() const
+{
+    vector<unsigned int> parent(nodes.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](unsigned int x) {
+        while(parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    auto unite = [&](unsigned int a, unsigned int b) {
+        a = find(a);
+        b = find(b);
+        if(a != b)
+            parent[max(a, b)] = min(a, b);
+    };
+    auto links = [this](unsigned int node) {
+        return (nodes[node].type != LexiconTypes::Start) && (nodes[node].type != LexiconTypes::End);
+    };
+    auto first_link = [&](const SearchPath &path) {
+        auto found = std::find_if(path.begin(), path.end(), links);
+        return (found == path.end()) ? static_cast<unsigned int>(-1) : *found;
+    };
+
+    for(unsigned int i = 0; i < nodes.size(); i++)
+        if((nodes[i].type == LexiconTypes::SP) || (nodes[i].type == LexiconTypes::EC))
+        {
+            const vector<unsigned int> &units = (nodes[i].type == LexiconTypes::SP)
+                ? static_cast<const vector<unsigned int> &>(*static_cast<SignificantPattern *>(nodes[i].lexicon.get()))
+                : static_cast<const vector<unsigned int> &>(*static_cast<EquivalenceClass *>(nodes[i].lexicon.get()));
+            for(unsigned int unit : units)
+                unite(i, unit);
+        }
+    for(const auto &path : paths)
+    {
+        unsigned int first = first_link(path);
+        for(unsigned int node : path)
+            if(links(node))
+                unite(first, node);
     }
 
-    // Copy paths (vector<SearchPath> is copyable)
-    new_graph->paths = paths;
+    vector<vector<unsigned int> > components;
+    std::unordered_map<unsigned int, unsigned int> component_of;  // root node -> component
+    for(unsigned int k = 0; k < paths.size(); k++)
+    {
+        unsigned int slot = pathAt(k);
+        unsigned int first = first_link(paths[slot]);
+        if(first == static_cast<unsigned int>(-1))
+        {
+            components.push_back(vector<unsigned int>(1, slot));  // a path of markers only
+            continue;
+        }
+        auto inserted = component_of.emplace(find(first), components.size());
+        if(inserted.second)
+            components.emplace_back();
+        components[inserted.first->second].push_back(slot);
+    }
+    return components;
+}
 
-    // Copy parse trees (assume ParseTree<unsigned int> is copyable)
-    new_graph->trees = trees;
+/**
+ * @brief Distill every component on its own, in parallel, and join the results in component order.
+ * @param params ADIOS algorithm parameters
+ * @param threads Number of worker threads
+ * @return The number of components
+ */
+unsigned int RDSGraph::distillPartitioned(const ADIOSParams &params, unsigned int threads)
+{
+    if (paths.empty()) {
+        throw std::runtime_error("RDSGraph::distillPartitioned: No paths available in the graph");
+    }
+    if (event_log) {
+        throw std::logic_error("RDSGraph::distillPartitioned: events cannot be streamed from partitioned distillation");
+    }
+    vector<unsigned int> context_sizes = contextSizes(params, "RDSGraph::distillPartitioned");
+    restoreLayout();
+    vector<vector<unsigned int> > components = partition();
+    madios::Logger::info("RDSGraph::distillPartitioned: " + std::to_string(components.size()) + " components");
+    if(components.size() < 2)
+    {
+        distill(params);
+        return components.size();
+    }
 
-    return new_graph;
+    vector<vector<unsigned int> > global_of(components.size());
+    vector<std::unique_ptr<RDSGraph> > parts(components.size());
+    vector<unsigned int> order(components.size());
+    vector<std::size_t> sizes(components.size(), 0);
+    for(unsigned int c = 0; c < components.size(); c++)
+    {
+        parts[c] = extractComponent(components[c], global_of[c]);
+        order[c] = c;
+        for(unsigned int slot : components[c])
+            sizes[c] += paths[slot].size();
+    }
+    // largest components first, so that the last ones to finish are short
+    std::stable_sort(order.begin(), order.end(), [&sizes](unsigned int a, unsigned int b) { return sizes[a] > sizes[b]; });
+
+    ADIOSParams part_params = params;
+    part_params.publishInterval = 0;  // only the joined graph is published
+    part_params.contextSchedule.clear();
+    std::atomic<size_t> next_part(0);
+    vector<std::exception_ptr> errors(components.size());
+    JobMemory *budget = JobMemory::current();              // the pool charges the caller's budget
+    std::ostream *sink = madios::Logger::getThreadSink();  // and logs where the caller logs
+    auto worker = [&]() {
+        JobMemory::Attach attach(budget);
+        madios::Logger::setThreadSink(sink);
+        for(size_t k = next_part++; k < order.size(); k = next_part++)
+        {
+            try
+            {
+                parts[order[k]]->distill(part_params);
+            }
+            catch(...)
+            {
+                errors[order[k]] = std::current_exception();
+            }
+        }
+    };
+
+    // one parallel section per context size, so that each stage is timed on the wall clock
+    vector<unsigned int> part_iterations(components.size(), 0);
+    context_stages.clear();
+    for(unsigned int context_size : context_sizes)
+    {
+        part_params.contextSize = context_size;
+        next_part = 0;
+        double stage_start = getTime();
+        vector<std::thread> workers;
+        for(unsigned int t = 1; t < min<size_t>(max(1u, threads), components.size()); t++)
+            workers.emplace_back(worker);
+        worker();
+        for(auto &w : workers)
+            w.join();
+        for(const auto &error : errors)
+            if(error)
+                std::rethrow_exception(error);
+        ContextStage stage{context_size, 0, getTime() - stage_start};
+        for(unsigned int c = 0; c < components.size(); c++)
+        {
+            stage.iterations = max(stage.iterations, parts[c]->completed_iterations);
+            part_iterations[c] += parts[c]->completed_iterations;
+        }
+        context_stages.push_back(stage);
+    }
+
+    completed_iterations = 0;
+    for(unsigned int c = 0; c < components.size(); c++)
+    {
+        joinComponent(*parts[c], components[c], global_of[c]);
+        completed_iterations = max(completed_iterations, part_iterations[c]);
+    }
+    updateAllConnections();
+    search_memo.clear();
+    estimateProbabilities();
+    if(params.publishInterval > 0)
+        publish(true);
+    return components.size();
 }
+
+// RDSGraph::copyLexicon
+// Copy a node's lexicon unit, replacing the units of an SP or EC by mapping[unit].
+std::unique_ptr<LexiconUnit> RDSGraph::copyLexicon(unsigned int node, const vector<unsigned int> &mapping) const
+{
+    std::unique_ptr<LexiconUnit> copy(nodes[node].lexicon->makeCopy());
+    if((nodes[node].type == LexiconTypes::SP) || (nodes[node].type == LexiconTypes::EC))
+    {
+        vector<unsigned int> &units = (nodes[node].type == LexiconTypes::SP)
+            ? static_cast<vector<unsigned int> &>(*static_cast<SignificantPattern *>(copy.get()))
+            : static_cast<vector<unsigned int> &>(*static_cast<EquivalenceClass *>(copy.get()));
+        for(auto &unit : units)
+            unit = mapping[unit];
+    }
+    return copy;
+}
+
+// RDSGraph::extractComponent
+// Build a graph of a component's paths and parse trees with the nodes they use (the markers, the
+// nodes of the paths and, recursively, the units of their SPs and ECs), renumbered in their order
+// here. global_of receives the node of this graph for each node of the new one.
+std::unique_ptr<RDSGraph> RDSGraph::extractComponent(const vector<unsigned int> &component, vector<unsigned int> &global_of) const
+{
+    vector<char> needed(nodes.size(), 0);
+    vector<unsigned int> pending;
+    auto need = [&](unsigned int node) {
+        if(!needed[node])
+        {
+            needed[node] = 1;
+            pending.push_back(node);
+        }
+    };
+    for(unsigned int i = 0; i < nodes.size(); i++)
+        if((nodes[i].type == LexiconTypes::Start) || (nodes[i].type == LexiconTypes::End))
+            need(i);
+    for(unsigned int slot : component)
+        for(unsigned int node : paths[slot])
+            need(node);
+    while(!pending.empty())
+    {
+        unsigned int node = pending.back();
+        pending.pop_back();
+        if(nodes[node].type == LexiconTypes::SP)
+            for(unsigned int unit : *static_cast<SignificantPattern *>(nodes[node].lexicon.get()))
+                need(unit);
+        else if(nodes[node].type == LexiconTypes::EC)
+            for(unsigned int unit : *static_cast<EquivalenceClass *>(nodes[node].lexicon.get()))
+                need(unit);
+    }
+
+    vector<unsigned int> local_of(nodes.size(), static_cast<unsigned int>(-1));
+    global_of.clear();
+    for(unsigned int i = 0; i < nodes.size(); i++)
+        if(needed[i])
+        {
+            local_of[i] = global_of.size();
+            global_of.push_back(i);
+        }
+
+    auto part = std::make_unique<RDSGraph>();
+    part->store = store;
+    part->quiet = true;
+    std::pmr::memory_resource *resource = part->storage();
+    part->nodes.reserve(global_of.size());
+    for(unsigned int node : global_of)
+        part->nodes.push_back(RDSNode(copyLexicon(node, local_of), nodes[node].type, resource));
+    part->paths.reserve(component.size());
+    part->external_corpus_size = corpusSize;
+    for(unsigned int slot : component)
+    {
+        part->paths.emplace_back(paths[slot], SearchPath::allocator_type(resource));
+        part->paths.back().relabel(local_of);
+        if(slot < trees.size())
+        {
+            part->trees.emplace_back(trees[slot], resource);
+            part->trees.back().relabel(local_of);
+        }
+        part->external_corpus_size -= paths[slot].size();
+    }
+    part->updateAllConnections();
+    return part;
+}
+
+// RDSGraph::joinComponent
+// Append the units a component learned (in their order there) and replace its paths and parse trees
+// by the component's, renumbered. global_of maps the component's nodes to this graph's and is
+// extended with the appended units.
+void RDSGraph::joinComponent(const RDSGraph &part, const vector<unsigned int> &component, vector<unsigned int> &global_of)
+{
+    for(unsigned int local = global_of.size(); local < part.nodes.size(); local++)
+        global_of.push_back(appendNode(part.copyLexicon(local, global_of), part.nodes[local].type));
+    for(unsigned int i = 0; i < component.size(); i++)
+    {
+        SearchPath path(part.paths[i], SearchPath::allocator_type(storage()));
+        path.relabel(global_of);
+        paths[component[i]] = std::move(path);
+        if((i < part.trees.size()) && (component[i] < trees.size()))
+        {
+            ParseTree<unsigned int> tree(part.trees[i], storage());
+            tree.relabel(global_of);
+            trees[component[i]] = std::move(tree);
+        }
+    }
+    for(const auto &sp : part.significant_patterns)
+    {
+        significant_patterns.push_back(sp);
+        for(auto &unit : significant_patterns.back())
+            unit = global_of[unit];
+    }
+    rewiring_ops += part.rewiring_ops;
+    precision_checks += part.precision_checks;
+    precision_mismatches += part.precision_mismatches;
+    pattern_searches += part.pattern_searches;
+    recalled_searches += part.recalled_searches;
+    approximated_searches += part.approximated_searches;
+    uncertain_searches += part.uncertain_searches;
+}
+
+// ===================== Progressive distillation =====================
+
+namespace {
+
+// Utility: count the SP and EC nodes of a graph into a stage's metrics.
+void countUnits(const RDSGraph &graph, ProgressiveStage &stage)
+{
+    stage.patterns = 0;
+    stage.classes = 0;
+    for(const auto &node : graph.getNodes())
+        if(node.type == LexiconTypes::SP)
+            stage.patterns++;
+        else if(node.type == LexiconTypes::EC)
+            stage.classes++;
+}
+
+}  // namespace
+
+/**
+ * @brief Distill growing random samples of the corpus, each stage continuing from the last.
+ * @param params ADIOS algorithm parameters
+ * @param initialSample Sentences in the first sample
+ * @param budgetSeconds Wall time after which no further sample is distilled (0: no limit)
+ * @param seed Seed of the sample order
+ * @param onStage Called after each stage with its metrics and graph
+ * @return The number of stages
+ */
+unsigned int RDSGraph::distillProgressive(const ADIOSParams &params, std::size_t initialSample, double budgetSeconds, unsigned int seed,
+                                          const std::function<void(const ProgressiveStage &, const RDSGraph &)> &onStage)
+{
+    if (paths.empty()) {
+        throw std::runtime_error("RDSGraph::distillProgressive: No paths available in the graph");
+    }
+    if (initialSample == 0) {
+        throw std::invalid_argument("RDSGraph::distillProgressive: the initial sample must not be empty");
+    }
+    for(const auto &node : nodes)
+        if((node.type == LexiconTypes::SP) || (node.type == LexiconTypes::EC))
+            throw std::logic_error("RDSGraph::distillProgressive: the graph already has learned units");
+    restoreLayout();
+
+    // the corpus, read back from the paths without the * and # markers
+    vector<vector<string> > sentences(paths.size());
+    for(unsigned int k = 0; k < paths.size(); k++)
+        for(unsigned int node : paths[pathAt(k)])
+            if((nodes[node].type != LexiconTypes::Start) && (nodes[node].type != LexiconTypes::End))
+                sentences[k].push_back(printNodeName(node));
+    vector<unsigned int> order(sentences.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    const unsigned int held_out_limit = 200;
+    ADIOSParams stage_params = params;
+    stage_params.publishInterval = 0;  // only this graph is published
+    double start = getTime();
+    PCFG grammar;
+    bool have_grammar = false;
+    bool budget_spent = false;
+    unsigned int stages = 0;
+    for(std::size_t size = initialSample; size < sentences.size(); size *= 2)
+    {
+        double stage_start = getTime();
+        ProgressiveStage stage;
+        stage.number = ++stages;
+        stage.sentences = size;
+        // the sample in corpus order, so that a stage does not depend on the order of its draw
+        vector<unsigned int> drawn(order.begin(), order.begin() + size);
+        std::sort(drawn.begin(), drawn.end());
+        vector<vector<string> > sample;
+        sample.reserve(size);
+        for(unsigned int k : drawn)
+            sample.push_back(sentences[k]);
+        RDSGraph part(sample);
+        part.setQuiet(true);
+        if(have_grammar)
+            stage.seededUnits = part.warmStart(grammar);
+        part.distill(stage_params);
+        grammar = part.toPCFG();
+        have_grammar = true;
+        countUnits(part, stage);
+
+        try
+        {
+            InsideScorer scorer(grammar);
+            for(std::size_t k = size; (k < sentences.size()) && (k < 2 * size) && (stage.heldOutTested < held_out_limit); k++)
+            {
+                stage.heldOutTested++;
+                if(scorer.score(sentences[order[k]]).status == InsideScorer::Status::Parsed)
+                    stage.heldOutParsed++;
+            }
+        }
+        catch(const std::runtime_error &e)
+        {
+            madios::Logger::warn(string("RDSGraph::distillProgressive: held-out sentences not scored: ") + e.what());
+        }
+        stage.seconds = getTime() - stage_start;
+        stage.elapsed = getTime() - start;
+        madios::Logger::info("RDSGraph::distillProgressive: stage " + std::to_string(stage.number) + ", " + std::to_string(stage.sentences) + " sentences, "
+                             + std::to_string(stage.patterns) + " SPs, " + std::to_string(stage.classes) + " ECs");
+        if(onStage)
+            onStage(stage, part);
+        if((budgetSeconds > 0.0) && (stage.elapsed >= budgetSeconds))
+        {
+            budget_spent = true;
+            break;
+        }
+    }
+
+    double stage_start = getTime();
+    ProgressiveStage stage;
+    stage.number = ++stages;
+    stage.final = true;
+    stage.sentences = sentences.size();
+    if(have_grammar)
+        stage.seededUnits = warmStart(grammar);
+    if(budget_spent)
+    {
+        stage.distilled = false;
+        search_memo.clear();
+        estimateProbabilities();
+        if(params.publishInterval > 0)
+            publish(true);
+    }
+    else
+        distill(params);
+    countUnits(*this, stage);
+    stage.seconds = getTime() - stage_start;
+    stage.elapsed = getTime() - start;
+    madios::Logger::info("RDSGraph::distillProgressive: final stage, " + std::to_string(stage.sentences) + " sentences, "
+                         + std::to_string(stage.patterns) + " SPs, " + std::to_string(stage.classes) + " ECs" + (budget_spent ? " (budget spent, not distilled)" : ""));
+    if(onStage)
+        onStage(stage, *this);
+    return stages;
+}
+
+// ===================== Statistics pipeline instantiations =====================
+template void RDSGraph::computeDescentsMatrix<double>(ScratchMatrix<double> &, ScratchMatrix<double> &, const ConnectionMatrix &) const;
+template void RDSGraph::computeDescentsMatrix<float>(ScratchMatrix<float> &, ScratchMatrix<float> &, const ConnectionMatrix &) const;
+template bool RDSGraph::findSignificantPatterns<double>(std::vector<Range> &, std::vector<SignificancePair> &, const ConnectionMatrix &, const ScratchMatrix<double> &, const ScratchMatrix<double> &, double, double) const;
+template bool RDSGraph::findSignificantPatterns<float>(std::vector<Range> &, std::vector<SignificancePair> &, const ConnectionMatrix &, const ScratchMatrix<float> &, const ScratchMatrix<float> &, double, double) const;
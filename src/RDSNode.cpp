@@ -31,8 +31,10 @@ RDSNode::RDSNode()
  * @brief Construct a node with a given lexicon and type.
  * @param lexicon Pointer to a LexiconUnit (ownership is taken)
  * @param type Lexicon type (Symbol, EC, SP, etc.)
+ * @param resource Memory resource for the connection and parent lists
  */
-RDSNode::RDSNode(std::unique_ptr<LexiconUnit> lexicon, LexiconTypes::LexiconEnum type)
+RDSNode::RDSNode(std::unique_ptr<LexiconUnit> lexicon, LexiconTypes::LexiconEnum type, std::pmr::memory_resource *resource)
+: connections(resource), parents(resource)
 {
     if (!lexicon) {
         throw std::invalid_argument("RDSNode: lexicon pointer is null");
@@ -53,6 +55,17 @@ RDSNode::RDSNode(const RDSNode &other)
     parents = other.parents;
 }
 
+/**
+ * @brief Copy a node into a given memory resource.
+ * @param other Node to copy from
+ * @param resource Memory resource for the connection and parent lists
+ */
+RDSNode::RDSNode(const RDSNode &other, std::pmr::memory_resource *resource)
+: connections(resource), parents(resource)
+{
+    deepCopy(other);
+}
+
 /**
  * @brief Destructor. Deletes the owned LexiconUnit pointer.
  */
@@ -92,10 +105,10 @@ void RDSNode::addConnection(const Connection &con)
 }
 
 /**
- * @brief Get all connections from this node.
- * @return std::vector of connections
+ * @brief Get all occurrences of this node.
+ * @return List of connections
  */
-const std::vector<Connection>& RDSNode::getConnections() const
+const ConnectionList& RDSNode::getConnections() const
 {
     return connections;
 }
@@ -106,7 +119,7 @@ const std::vector<Connection>& RDSNode::getConnections() const
  */
 void RDSNode::setConnections(const std::vector<Connection> &connections)
 {
-    this->connections = connections;
+    this->connections.assign(connections.begin(), connections.end());
 }
 
 /**
@@ -0,0 +1,59 @@
+// File: ScratchArena.cpp
+// Purpose: Implements the ScratchArena class, a resettable monotonic memory resource for per-path temporaries.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Serve allocations from a monotonic buffer over a reserved block
+//   - Track heap overflow and grow the reserve on reset
+//
+// Design notes:
+//   - The monotonic resource is re-created on reset, because it cannot be pointed at a new buffer
+//   - Overflow blocks are owned by the monotonic resource and returned by its release()
+
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <new>
+
+/**
+ * @brief Create an empty arena.
+ * @param maxReserve Upper bound for the reserved block in bytes
+ */
+ScratchArena::ScratchArena(std::size_t maxReserve)
+: max_reserve(maxReserve)
+{
+    arena.emplace(&overflow);
+}
+
+/**
+ * @brief Free everything allocated since the last reset and grow the reserve to the high-water mark.
+ */
+void ScratchArena::reset()
+{
+    arena->release();
+    if(overflow.bytes > 0 && reserve_size < max_reserve)
+    {
+        reserve_size = std::min(max_reserve, reserve_size + overflow.bytes);
+        arena.reset();
+        reserve.reset(new std::byte[reserve_size]);
+        arena.emplace(reserve.get(), reserve_size, &overflow);
+    }
+    overflow.bytes = 0;
+    overflow.count = 0;
+}
+
+// ScratchArena::OverflowResource::do_allocate
+// Forward to the heap and count the request.
+void* ScratchArena::OverflowResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    this->bytes += bytes;
+    count++;
+    return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+// ScratchArena::OverflowResource::do_deallocate
+// Return a block to the heap.
+void ScratchArena::OverflowResource::do_deallocate(void *p, std::size_t bytes, std::size_t alignment)
+{
+    ::operator delete(p, bytes, std::align_val_t(alignment));
+}
@@ -0,0 +1,117 @@
+// File: SearchMemo.cpp
+// Purpose: Implements the SearchMemo class, a memo table of significant-pattern searches keyed by path content.
+// Part of the ADIOS grammar induction project. See README for usage and structure.
+//
+// Major responsibilities:
+//   - Hash node sequences and keep one entry per distinct sequence
+//   - Validate entries against node versions and the corpus size
+//
+// Design notes:
+//   - Buckets are keyed by SearchPath's 64-bit path hash and compare the full sequence, so lookups do not allocate
+//   - Stale entries are not evicted on lookup; store() overwrites them in place
+//   - Sizes are estimates (vector payloads plus a fixed overhead per entry); overflowing the capacity
+//     clears the whole memo, which keeps store() O(1) without tracking recency
+
+#include "SearchMemo.h"
+
+#include <algorithm>
+
+using std::vector;
+
+/**
+ * @brief Look up a path.
+ * @param path The node sequence
+ * @param versions Current version of every node
+ * @param corpusSize Current corpus size
+ * @return The stored outcome, or nullptr if missing or stale
+ */
+const SearchMemo::Outcome* SearchMemo::find(PathView path, const vector<unsigned int> &versions, unsigned int corpusSize)
+{
+    const Entry *entry = lookup(path, SearchPath::hashOf(path));
+    bool valid = (entry != nullptr) && (entry->corpus_size == corpusSize);
+    if(valid)
+        for(const auto &stamp : entry->stamps)
+            if((stamp.first >= versions.size()) || (versions[stamp.first] != stamp.second))
+            {
+                valid = false;
+                break;
+            }
+    if(!valid)
+    {
+        miss_count++;
+        return nullptr;
+    }
+    hit_count++;
+    return &entry->outcome;
+}
+
+/**
+ * @brief Store the outcome of a search.
+ * @param path The node sequence
+ * @param dependencies The nodes the search read
+ * @param versions Current version of every node
+ * @param corpusSize Current corpus size
+ * @param outcome The outcome
+ */
+void SearchMemo::store(PathView path, const vector<unsigned int> &dependencies, const vector<unsigned int> &versions, unsigned int corpusSize, Outcome outcome)
+{
+    std::size_t bytes = sizeOf(path.size(), dependencies.size(), outcome);
+    std::uint64_t key = SearchPath::hashOf(path);
+    Entry *entry = lookup(path, key);
+    // an overwrite frees the old entry's bytes
+    if((capacity > 0) && (entry_bytes - (entry ? entry->bytes : 0) + bytes > capacity))
+    {
+        clear();
+        overflow_count++;
+        entry = nullptr;
+    }
+    if(entry == nullptr)
+    {
+        vector<Entry> &bucket = buckets[key];
+        bucket.emplace_back();
+        entry = &bucket.back();
+        entry->path.assign(path.begin(), path.end());
+        entry_count++;
+    }
+    else
+        entry_bytes -= entry->bytes;
+    entry->bytes = bytes;
+    entry_bytes += bytes;
+    entry->stamps.clear();
+    for(unsigned int node : dependencies)
+        entry->stamps.emplace_back(node, versions[node]);
+    entry->corpus_size = corpusSize;
+    entry->outcome = std::move(outcome);
+}
+
+/**
+ * @brief Remove every entry.
+ */
+void SearchMemo::clear()
+{
+    buckets.clear();
+    entry_count = 0;
+    entry_bytes = 0;
+}
+
+// SearchMemo::sizeOf
+// Estimated size of an entry: its vectors' payloads plus the entry and its share of a bucket.
+std::size_t SearchMemo::sizeOf(std::size_t pathLength, std::size_t dependencies, const Outcome &outcome)
+{
+    return sizeof(Entry) + 64 + pathLength * sizeof(unsigned int)
+        + dependencies * sizeof(std::pair<unsigned int, unsigned int>)
+        + outcome.patterns.size() * sizeof(Range) + outcome.pvalues.size() * sizeof(SignificancePair);
+}
+
+// SearchMemo::lookup
+// Find the entry for a sequence in its bucket, or nullptr.
+SearchMemo::Entry* SearchMemo::lookup(PathView path, std::uint64_t key)
+{
+    auto bucket = buckets.find(key);
+    if(bucket == buckets.end())
+        return nullptr;
+    for(auto &entry : bucket->second)
+        if((entry.path.size() == path.size()) && std::equal(path.begin(), path.end(), entry.path.begin()))
+            return &entry;
+    return nullptr;
+}
@@ -8,13 +8,16 @@
 //   - Used for parsing, pattern finding, and generalization
 //
 // Design notes:
-//   - Inherits from std::vector<unsigned int>
+//   - Inherits from std::pmr::vector<unsigned int>, so the graph can place its paths in a MappedStore
+//   - The polynomial hash uses an odd base, which is invertible mod 2^64, so a suffix that shifts
+//     left by d positions is rescaled by B^-d
 //   - All methods are robust to empty and out-of-bounds input
 //   - Used throughout the ADIOS algorithm for search and pattern management
 
 #include "SearchPath.h"
 #include "madios/BasicSymbol.h"
 
+#include <algorithm>
 #include <cassert>
 
 using std::string;
@@ -23,6 +26,56 @@ using std::ostream;
 using std::ostringstream;
 using std::endl;
 
+namespace {
+
+// Base of the polynomial hash (odd, so invertible mod 2^64).
+const std::uint64_t hash_base = 0x9E3779B97F4A7C15ULL;
+
+// Utility: scramble a node id so that neighbouring ids give unrelated terms (splitmix64 finalizer).
+std::uint64_t mixNode(unsigned int node)
+{
+    std::uint64_t z = static_cast<std::uint64_t>(node) + 0x632BE59BD9B4E019ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Utility: base^exponent mod 2^64.
+std::uint64_t power(std::uint64_t base, std::uint64_t exponent)
+{
+    std::uint64_t result = 1;
+    for(; exponent > 0; exponent >>= 1, base *= base)
+        if(exponent & 1)
+            result *= base;
+    return result;
+}
+
+// Utility: inverse of an odd number mod 2^64 (Newton iteration, each step doubles the correct bits).
+std::uint64_t inverse(std::uint64_t odd)
+{
+    std::uint64_t x = odd;
+    for(int i = 0; i < 5; i++)
+        x *= 2 - odd * x;
+    return x;
+}
+
+const std::uint64_t hash_base_inverse = inverse(hash_base);
+
+// Utility: sum of mixNode(path[i]) * base^(offset + i).
+std::uint64_t hashTerms(PathView path, std::uint64_t offset)
+{
+    std::uint64_t h = 0;
+    std::uint64_t weight = power(hash_base, offset);
+    for(unsigned int node : path)
+    {
+        h += mixNode(node) * weight;
+        weight *= hash_base;
+    }
+    return h;
+}
+
+}  // namespace
+
 /**
  * @brief Default constructor. Initializes an empty search path.
  */
@@ -35,8 +88,80 @@ SearchPath::SearchPath()
  * @param path Vector of node indices
  */
 SearchPath::SearchPath(const std::vector<unsigned int> &path)
-:vector<unsigned int>(path)
+:std::pmr::vector<unsigned int>(path.begin(), path.end()), path_hash(hashOf(path))
+{
+}
+
+/**
+ * @brief Construct a search path from a vector of node indices that is no longer needed.
+ * @param path Vector of node indices (copied: its allocator differs from the path's)
+ */
+SearchPath::SearchPath(std::vector<unsigned int> &&path)
+:std::pmr::vector<unsigned int>(path.begin(), path.end()), path_hash(hashOf(path))
+{
+}
+
+/**
+ * @brief Construct a search path from a view of node indices.
+ * @param path The viewed node indices
+ */
+SearchPath::SearchPath(PathView path)
+:std::pmr::vector<unsigned int>(path.begin(), path.end()), path_hash(hashOf(path))
+{
+}
+
+/**
+ * @brief Construct a search path from a view of node indices, allocating from a given resource.
+ * @param path The viewed node indices
+ * @param alloc Allocator for the path
+ */
+SearchPath::SearchPath(PathView path, const allocator_type &alloc)
+:std::pmr::vector<unsigned int>(path.begin(), path.end(), alloc), path_hash(hashOf(path))
+{
+}
+
+/**
+ * @brief Copy a search path into a given memory resource.
+ * @param other Path to copy
+ * @param alloc Allocator for the copy
+ */
+SearchPath::SearchPath(const SearchPath &other, const allocator_type &alloc)
+:Stringable(other), std::pmr::vector<unsigned int>(other, alloc), path_hash(other.path_hash)
+{
+}
+
+/**
+ * @brief Move a search path into a given memory resource.
+ * @param other Path to move from (left with the hash of whatever it still holds)
+ * @param alloc Allocator for the result
+ */
+SearchPath::SearchPath(SearchPath &&other, const allocator_type &alloc)
+:Stringable(other), std::pmr::vector<unsigned int>(std::move(other), alloc), path_hash(other.path_hash)
+{
+    other.rehash();
+}
+
+/**
+ * @brief Move constructor.
+ * @param other Path to move from (left empty)
+ */
+SearchPath::SearchPath(SearchPath &&other) noexcept
+:Stringable(other), std::pmr::vector<unsigned int>(std::move(other)), path_hash(other.path_hash)
+{
+    other.path_hash = 0;
+}
+
+/**
+ * @brief Move assignment (keeps this path's memory resource).
+ * @param other Path to move from (left with the hash of whatever it still holds)
+ * @return This path
+ */
+SearchPath& SearchPath::operator=(SearchPath &&other)
 {
+    std::pmr::vector<unsigned int>::operator=(std::move(other));
+    path_hash = other.path_hash;
+    other.rehash();
+    return *this;
 }
 
 /**
@@ -53,14 +178,44 @@ SearchPath::~SearchPath()
  */
 bool SearchPath::operator==(const SearchPath &other) const
 {
-    if(size() != other.size())
+    if((size() != other.size()) || (path_hash != other.path_hash))
         return false;
 
-    for(unsigned int i = 0; i < size(); i++)
-        if(at(i) != other[i])
-            return false;
+    return std::equal(begin(), end(), other.begin());
+}
 
-    return true;
+/**
+ * @brief Hash a node sequence.
+ * @param path The node sequence
+ * @return Sum of mix(node_i) * B^i mod 2^64
+ */
+std::uint64_t SearchPath::hashOf(PathView path)
+{
+    return hashTerms(path, 0);
+}
+
+/**
+ * @brief Replace one node, updating the hash.
+ * @param i Index of the node
+ * @param node The new node
+ */
+void SearchPath::set(unsigned int i, unsigned int node)
+{
+    assert(i < size());
+    assert(path_hash == hashOf(*this));   // catches vector-interface edits not followed by rehash()
+    path_hash += (mixNode(node) - mixNode((*this)[i])) * power(hash_base, i);
+    (*this)[i] = node;
+}
+
+/**
+ * @brief Replace every node by its new index.
+ * @param mapping New index of each old node index
+ */
+void SearchPath::relabel(const std::vector<unsigned int> &mapping)
+{
+    for(auto &node : *this)
+        node = mapping[node];
+    rehash();
 }
 
 /**
@@ -71,6 +226,7 @@ bool SearchPath::operator==(const SearchPath &other) const
  */
 void SearchPath::rewire(unsigned int start, unsigned int finish, unsigned int node)
 {
+    path_hash = spliceHash(start, finish, PathView(&node, 1));
     erase( begin()+start, begin()+finish+1);
     insert(begin()+start, node);
 }
@@ -93,21 +249,44 @@ vector<unsigned int> SearchPath::operator()(unsigned int start, unsigned int fin
  * @brief Substitute a segment of the path with a new sequence of nodes.
  * @param start Start index of the segment to replace
  * @param finish End index of the segment to replace
- * @param segment Vector of new node indices to insert
+ * @param segment New node indices to insert
  * @return A new SearchPath with the substituted segment
  */
-vector<unsigned int> SearchPath::substitute(unsigned int start, unsigned int finish, const vector<unsigned int> &segment) const
+SearchPath SearchPath::substitute(unsigned int start, unsigned int finish, PathView segment) const
 {
     assert(start <= finish);
     assert(finish < size());
 
-    vector<unsigned int> new_path(begin(), begin()+start);
+    SearchPath new_path;
+    new_path.reserve(size() - (finish - start + 1) + segment.size());
+    new_path.insert(new_path.end(), begin(), begin()+start);
     new_path.insert(new_path.end(), segment.begin(), segment.end());
     new_path.insert(new_path.end(), begin()+finish+1, end());
+    new_path.path_hash = spliceHash(start, finish, segment);
 
     return new_path;
 }
 
+// SearchPath::spliceHash
+// Hash of the path with nodes start..finish replaced by segment: the replaced terms are swapped for
+// the segment's and the suffix is rescaled by B^(new length - old length). The suffix sum is read
+// directly or derived from the prefix sum, whichever is shorter.
+std::uint64_t SearchPath::spliceHash(unsigned int start, unsigned int finish, PathView segment) const
+{
+    assert(path_hash == hashOf(*this));
+    PathView all(*this);
+    std::uint64_t removed = hashTerms(all(start, finish), start);
+    std::uint64_t suffix;
+    if(size() - finish - 1 <= start)
+        suffix = (finish + 1 < size()) ? hashTerms(all(finish + 1, size() - 1), finish + 1) : 0;
+    else
+        suffix = path_hash - removed - ((start > 0) ? hashTerms(all(0, start - 1), 0) : 0);
+    std::uint64_t replaced = finish - start + 1;
+    std::uint64_t shift = (segment.size() >= replaced) ? power(hash_base, segment.size() - replaced)
+                                                       : power(hash_base_inverse, replaced - segment.size());
+    return path_hash - removed - suffix + hashTerms(segment, start) + suffix * shift;
+}
+
 /**
  * @brief Convert the search path to a string representation.
  * @return String representation of the search path
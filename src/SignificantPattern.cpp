@@ -45,6 +45,18 @@ SignificantPattern::SignificantPattern(const std::vector<unsigned int> &sequence
         push_back(sequence[i]);
 }
 
+/**
+ * @brief Construct a significant pattern from a view of node indices.
+ * @param sequence View of node indices
+ */
+SignificantPattern::SignificantPattern(PathView sequence)
+:vector<unsigned int>(sequence.begin(), sequence.end())
+{
+    if (sequence.empty()) {
+        throw std::invalid_argument("SignificantPattern: input sequence view is empty");
+    }
+}
+
 /**
  * @brief Destructor. No special cleanup needed.
  */
@@ -5,12 +5,25 @@
  * This file contains the main() function and the CLI logic for running the ADIOS grammar induction algorithm.
  * It handles argument parsing, input/output, error handling, and program flow.
  *
- * Usage: ./madios <input> <eta> <alpha> <context_size> <coverage> [--format <format>] [number_of_new_sequences]
+ * Usage: ./madios <input> <eta> <alpha> <context_size> <coverage> [--format <format>] [--warm-start <grammar>] [--out-of-core <dir>] [--partition [--threads N]] [--progressive N [--budget S]] [--context-schedule 2,3,...] [number_of_new_sequences]
+ *        ./madios tag --grammar <grammar.pcfg> [-o <output>] < text
+ *        ./madios score --grammar <grammar.pcfg> [--threads N] [-o <output>] <sentences>
+ *        ./madios complete --grammar <grammar.pcfg> [-n N] [--seed S] <prefix tokens...>
+ *        ./madios query --grammar <grammar.pcfg> <patterns|classes|containers|reachable> <unit> [--direct]
+ *        ./madios batch [--threads N] [--memory-mb M] [--report <file>] <manifest>
  *
  * For more details, see the README and documentation for the ADIOS algorithm.
  */
 
 #include "MiscUtils.h"
+#include "BatchRunner.h"
+#include "FrozenGrammar.h"
+#include "GrammarIndex.h"
+#include "InsideScorer.h"
+#include "PatternEventLog.h"
+#include "PatternTagger.h"
+#include "PCFG.h"
+#include "PrefixSampler.h"
 #include "RDSGraph.h"
 #include "special.h"
 #include "TimeFuncs.h"
@@ -27,6 +40,14 @@
 #include <string>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
 #include <sys/resource.h>
 
 using std::vector;
@@ -38,6 +59,329 @@ using std::ios;
 using std::cout;
 using std::endl;
 
+/**
+ * @brief Run the "tag" subcommand: mark learned patterns in text read from stdin.
+ *
+ * Loads a grammar written with --format pcfg, compiles its significant patterns into a
+ * PatternTagger and streams stdin line by line, writing each line with pattern spans
+ * bracketed as "[P<n> tokens...]".
+ *
+ * @param argc Number of subcommand arguments (argv[0] is "tag")
+ * @param argv Subcommand argument strings
+ * @return int Exit code (0 for success, nonzero for error)
+ */
+int run_tag(int argc, char *argv[])
+{
+    CLI::App app{"madios tag: mark learned significant patterns in text read from stdin\n\n"
+        "Usage: ./madios tag --grammar grammar.pcfg [options] < input.txt\n"};
+    std::string grammar_filename;
+    std::string output_filename;
+    unsigned int max_expansions = 4096;
+    app.add_option("-g,--grammar", grammar_filename, "Grammar file written with --format pcfg (required)")->required();
+    app.add_option("-o,--output", output_filename, "Output file (default: stdout)");
+    app.add_option("--max-expansions", max_expansions, "Skip patterns with more terminal expansions than this (default: 4096)");
+    CLI11_PARSE(app, argc, argv);
+
+    std::ifstream grammar_file(grammar_filename);
+    if (!grammar_file.good()) {
+        std::cerr << "[main] Error: Cannot open grammar file '" << grammar_filename << "'." << std::endl;
+        return 2;
+    }
+    PCFG grammar;
+    try {
+        grammar = PCFG::read(grammar_file);
+    } catch (const std::exception &e) {
+        std::cerr << "[main] Error: " << e.what() << std::endl;
+        return 3;
+    }
+    PatternTagger tagger(grammar, max_expansions);
+
+    std::ostream* out = &std::cout;
+    std::ofstream outfile;
+    if (!output_filename.empty()) {
+        outfile.open(output_filename);
+        if (!outfile.is_open()) {
+            std::cerr << "[main] Error: Cannot open output file '" << output_filename << "'." << std::endl;
+            return 5;
+        }
+        out = &outfile;
+    }
+    std::ios::sync_with_stdio(false);
+    std::string line;
+    std::string tagged;
+    while (std::getline(std::cin, line)) {
+        tagged.clear();
+        tagger.tagLine(line, tagged);
+        tagged.push_back('\n');
+        out->write(tagged.data(), tagged.size());
+    }
+    out->flush();
+    return 0;
+}
+
+/**
+ * @brief Run the "score" subcommand: held-out log-likelihood of a sentence file under a grammar.
+ *
+ * Sentences are scored in parallel with the inside algorithm (see InsideScorer). One line per
+ * sentence is written in input order ("index tokens log_prob status", tab separated), followed by
+ * aggregate lines starting with '#'. Perplexity is per token over the parsed sentences.
+ *
+ * @param argc Number of subcommand arguments (argv[0] is "score")
+ * @param argv Subcommand argument strings
+ * @return int Exit code (0 for success, nonzero for error)
+ */
+int run_score(int argc, char *argv[])
+{
+    CLI::App app{"madios score: held-out log-likelihood and perplexity under a learned grammar\n\n"
+        "Usage: ./madios score --grammar grammar.pcfg [options] sentences.txt\n"};
+    std::string grammar_filename;
+    std::string input_filename;
+    std::string output_filename;
+    unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+    app.add_option("input", input_filename, "Sentence file, one sentence per line (required)")->required();
+    app.add_option("-g,--grammar", grammar_filename, "Grammar file written with --format pcfg (required)")->required();
+    app.add_option("-o,--output", output_filename, "Output file (default: stdout)");
+    app.add_option("--threads", num_threads, "Number of scoring threads (default: hardware concurrency)");
+    CLI11_PARSE(app, argc, argv);
+
+    std::ifstream grammar_file(grammar_filename);
+    if (!grammar_file.good()) {
+        std::cerr << "[main] Error: Cannot open grammar file '" << grammar_filename << "'." << std::endl;
+        return 2;
+    }
+    if (!std::ifstream(input_filename).good()) {
+        std::cerr << "[main] Error: Cannot open input file '" << input_filename << "'." << std::endl;
+        return 2;
+    }
+    std::unique_ptr<InsideScorer> scorer;
+    try {
+        scorer.reset(new InsideScorer(PCFG::read(grammar_file)));
+    } catch (const std::exception &e) {
+        std::cerr << "[main] Error: " << e.what() << std::endl;
+        return 3;
+    }
+    vector<vector<string> > sentences = readSequencesFromFile(input_filename);
+
+    vector<InsideScorer::Result> results(sentences.size());
+    std::atomic<size_t> next_sentence(0);
+    auto worker = [&]() {
+        for (size_t i = next_sentence++; i < sentences.size(); i = next_sentence++)
+            results[i] = scorer->score(sentences[i]);
+    };
+    vector<std::thread> workers;
+    for (unsigned int t = 1; t < std::max(1u, num_threads); ++t)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &w : workers)
+        w.join();
+
+    std::ostream* out = &std::cout;
+    std::ofstream outfile;
+    if (!output_filename.empty()) {
+        outfile.open(output_filename);
+        if (!outfile.is_open()) {
+            std::cerr << "[main] Error: Cannot open output file '" << output_filename << "'." << std::endl;
+            return 5;
+        }
+        out = &outfile;
+    }
+    double log_likelihood = 0.0;
+    size_t parsed = 0, oov = 0, parsed_tokens = 0;
+    (*out) << std::setprecision(10);
+    for (size_t i = 0; i < sentences.size(); ++i) {
+        const InsideScorer::Result &r = results[i];
+        (*out) << i << "\t" << sentences[i].size() << "\t" << r.logProbability << "\t" << InsideScorer::statusName(r.status) << "\n";
+        if (r.status == InsideScorer::Status::Parsed) {
+            parsed++;
+            parsed_tokens += sentences[i].size();
+            log_likelihood += r.logProbability;
+        } else if (r.status == InsideScorer::Status::OutOfVocabulary) {
+            oov++;
+        }
+    }
+    (*out) << "# sentences " << sentences.size() << " parsed " << parsed << " oov " << oov << " unparsed " << (sentences.size() - parsed - oov) << "\n";
+    (*out) << "# log_likelihood " << log_likelihood << " tokens " << parsed_tokens << "\n";
+    (*out) << "# perplexity " << ((parsed_tokens > 0) ? std::exp(-log_likelihood / parsed_tokens) : std::numeric_limits<double>::infinity()) << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Run the "complete" subcommand: sample completions of a prefix under a learned grammar.
+ *
+ * Loads a grammar written with --format pcfg and prints sampled sentences that start with the
+ * prefix, one per line, followed by a "# prefix_probability" line.
+ *
+ * @param argc Number of subcommand arguments (argv[0] is "complete")
+ * @param argv Subcommand argument strings
+ * @return int Exit code (0 for success, nonzero for error)
+ */
+int run_complete(int argc, char *argv[])
+{
+    CLI::App app{"madios complete: sample completions of a prefix under a learned grammar\n\n"
+        "Usage: ./madios complete --grammar grammar.pcfg [options] prefix tokens...\n"};
+    std::string grammar_filename;
+    vector<string> prefix;
+    unsigned int count = 10;
+    unsigned int seed = 1;
+    app.add_option("prefix", prefix, "Prefix tokens (none: sample whole sentences)");
+    app.add_option("-g,--grammar", grammar_filename, "Grammar file written with --format pcfg (required)")->required();
+    app.add_option("-n,--count", count, "Number of completions (default: 10)");
+    app.add_option("--seed", seed, "Random seed (default: 1)");
+    CLI11_PARSE(app, argc, argv);
+
+    std::ifstream grammar_file(grammar_filename);
+    if (!grammar_file.good()) {
+        std::cerr << "[main] Error: Cannot open grammar file '" << grammar_filename << "'." << std::endl;
+        return 2;
+    }
+    std::unique_ptr<PrefixSampler> sampler;
+    try {
+        sampler.reset(new PrefixSampler(std::make_shared<const FrozenGrammar>(PCFG::read(grammar_file))));
+    } catch (const std::exception &e) {
+        std::cerr << "[main] Error: " << e.what() << std::endl;
+        return 3;
+    }
+    std::mt19937 rng(seed);
+    for (const auto &completion : sampler->complete(prefix, count, rng)) {
+        vector<string> sentence(prefix);
+        sentence.insert(sentence.end(), completion.begin(), completion.end());
+        for (size_t i = 0; i < sentence.size(); ++i)
+            std::cout << (i ? " " : "") << sentence[i];
+        std::cout << "\n";
+    }
+    std::cout << "# prefix_probability " << std::setprecision(10) << sampler->prefixProbability(prefix) << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Run the "query" subcommand: look up the units of a learned grammar that contain or are reachable from a unit.
+ *
+ * Loads a grammar written with --format pcfg into a GrammarIndex and prints one unit name per
+ * line: the SPs ("patterns"), ECs ("classes") or both ("containers") that contain the unit, or
+ * the rules of every unit reachable from it ("reachable", one "X -> elements" line per unit).
+ *
+ * @param argc Number of subcommand arguments (argv[0] is "query")
+ * @param argv Subcommand argument strings
+ * @return int Exit code (0 for success, nonzero for error)
+ */
+int run_query(int argc, char *argv[])
+{
+    CLI::App app{"madios query: inverted index queries over a learned grammar\n\n"
+        "Usage: ./madios query --grammar grammar.pcfg <patterns|classes|containers|reachable> unit\n"};
+    std::string grammar_filename;
+    std::string mode;
+    std::string unit_name;
+    bool direct = false;
+    app.add_option("mode", mode, "patterns, classes, containers or reachable")->required()
+        ->check(CLI::IsMember({"patterns", "classes", "containers", "reachable"}));
+    app.add_option("unit", unit_name, "Word or unit name, e.g. P12")->required();
+    app.add_option("-g,--grammar", grammar_filename, "Grammar file written with --format pcfg (required)")->required();
+    app.add_flag("--direct", direct, "Only units that contain the unit directly (patterns and classes)");
+    CLI11_PARSE(app, argc, argv);
+
+    std::ifstream grammar_file(grammar_filename);
+    if (!grammar_file.good()) {
+        std::cerr << "[main] Error: Cannot open grammar file '" << grammar_filename << "'." << std::endl;
+        return 2;
+    }
+    std::unique_ptr<GrammarIndex> index;
+    try {
+        index.reset(new GrammarIndex(PCFG::read(grammar_file)));
+    } catch (const std::exception &e) {
+        std::cerr << "[main] Error: " << e.what() << std::endl;
+        return 3;
+    }
+    unsigned int unit = index->unitId(unit_name);
+    if (unit == PCFG::npos) {
+        std::cerr << "[main] Error: Unknown unit '" << unit_name << "'." << std::endl;
+        return 4;
+    }
+
+    vector<unsigned int> found;
+    if (mode == "patterns")
+        found = index->patternsContaining(unit, !direct);
+    else if (mode == "classes")
+        found = index->classesContaining(unit, !direct);
+    else if (mode == "containers")
+        found = index->containers(unit);
+    else
+        found = index->reachable(unit);
+    for (unsigned int id : found) {
+        std::cout << index->unitName(id);
+        if (mode == "reachable" && index->kind(id) != GrammarIndex::Kind::Word) {
+            PathView elements = index->elements(id);
+            const char *separator = (index->kind(id) == GrammarIndex::Kind::Class) ? " | " : " ";
+            std::cout << " ->";
+            for (size_t k = 0; k < elements.size(); ++k)
+                std::cout << (k ? separator : " ") << index->unitName(elements[k]);
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+    return 0;
+}
+
+/**
+ * @brief Run the "batch" subcommand: distill every job of a manifest concurrently in this process.
+ *
+ * Jobs run on a shared pool of worker threads (see BatchRunner), each with its own memory limit
+ * and log file. A tab-separated report with one line per job and the batch totals is written to
+ * stdout or to --report.
+ *
+ * @param argc Number of subcommand arguments (argv[0] is "batch")
+ * @param argv Subcommand argument strings
+ * @return int Exit code (0 if every job succeeded, 6 if some failed, other nonzero for errors)
+ */
+int run_batch(int argc, char *argv[])
+{
+    CLI::App app{"madios batch: distill many corpora concurrently in one process\n\n"
+        "Usage: ./madios batch [options] manifest.txt\n"
+        "Manifest lines: corpus output eta alpha context_size coverage [format=pcfg|snapshot] [memory-mb=N]\n"};
+    std::string manifest_filename;
+    std::string report_filename;
+    unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t memory_mb = 0;
+    app.add_option("manifest", manifest_filename, "Job manifest, one job per line (required)")->required();
+    app.add_option("--threads", num_threads, "Number of worker threads (default: hardware concurrency)");
+    app.add_option("--memory-mb", memory_mb, "Memory limit of each job in MB (default: 0, unlimited)");
+    app.add_option("--report", report_filename, "Report file (default: stdout)");
+    CLI11_PARSE(app, argc, argv);
+
+    std::ifstream manifest_file(manifest_filename);
+    if (!manifest_file.good()) {
+        std::cerr << "[main] Error: Cannot open manifest file '" << manifest_filename << "'." << std::endl;
+        return 2;
+    }
+    vector<BatchRunner::Job> jobs;
+    try {
+        jobs = BatchRunner::readManifest(manifest_file, std::filesystem::path(manifest_filename).parent_path().string());
+    } catch (const std::exception &e) {
+        std::cerr << "[main] Error: " << e.what() << std::endl;
+        return 3;
+    }
+    if (jobs.empty()) {
+        std::cerr << "[main] Error: No jobs found in manifest file '" << manifest_filename << "'." << std::endl;
+        return 4;
+    }
+    std::ostream* out = &std::cout;
+    std::ofstream outfile;
+    if (!report_filename.empty()) {
+        outfile.open(report_filename);
+        if (!outfile.is_open()) {
+            std::cerr << "[main] Error: Cannot open report file '" << report_filename << "'." << std::endl;
+            return 5;
+        }
+        out = &outfile;
+    }
+
+    BatchRunner runner(num_threads, memory_mb << 20);
+    double start = getTime();
+    vector<BatchRunner::Result> results = runner.run(jobs);
+    runner.writeReport(*out, jobs, results, getTime() - start);
+    bool all_succeeded = std::all_of(results.begin(), results.end(), [](const BatchRunner::Result &r) { return r.status == BatchRunner::Status::Succeeded; });
+    return all_succeeded ? 0 : 6;
+}
+
 /**
  * @brief Run the CLI interface for the madios program.
  *
@@ -56,10 +400,25 @@ int run_cli(int argc, char *argv[])
     std::ostringstream cli_args;
     for (int i = 0; i < argc; ++i) cli_args << argv[i] << " ";
     madios::Logger::info("CLI arguments: " + cli_args.str());
+    if (argc > 1 && std::string(argv[1]) == "tag")
+        return run_tag(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "score")
+        return run_score(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "complete")
+        return run_complete(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "query")
+        return run_query(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "batch")
+        return run_batch(argc - 1, argv + 1);
 
     // --- Argument parsing using CLI11 ---
     CLI::App app{"madios: ADIOS grammar induction\n\n"
         "Usage: ./madios <input> <eta> <alpha> <context_size> <coverage> [options] [number_of_new_sequences]\n"
+        "       ./madios tag --grammar grammar.pcfg [-o output] < text   (see ./madios tag --help)\n"
+        "       ./madios score --grammar grammar.pcfg [--threads N] sentences.txt   (see ./madios score --help)\n"
+        "       ./madios complete --grammar grammar.pcfg [-n N] prefix tokens...   (see ./madios complete --help)\n"
+        "       ./madios query --grammar grammar.pcfg patterns|classes|containers|reachable unit   (see ./madios query --help)\n"
+        "       ./madios batch [--threads N] [--memory-mb M] manifest.txt   (see ./madios batch --help)\n"
         "Example: ./madios corpus.txt 0.9 0.01 5 0.65 --format json -o output.json\n\n"
         "Arguments:\n"
         "  input                Input corpus file (required)\n"
@@ -73,6 +432,23 @@ int run_cli(int argc, char *argv[])
         "  --format FORMAT      Output format: json, pcfg, or text (default: text)\n"
         "  --verbose            Enable verbose output\n"
         "  --quiet              Suppress all non-error output\n"
+        "  --relayout N         Renumber nodes/regroup paths for locality every N iterations (default: 0, off)\n"
+        "  --context-schedule L Converge at each context size in the comma-separated list L first, e.g. 2,3\n"
+        "                       (strictly increasing, below <context_size>)\n"
+        "  --events FILE        Stream learned SPs/ECs to FILE as JSON Lines during distillation\n"
+        "  --precision P        Statistics precision: double, single, or validate (default: double)\n"
+        "  --approximate-above N  Approximate significance tails for pattern counts >= N (default: 0, always exact)\n"
+        "  --approximation-error E  Largest error bound accepted for an approximated tail (default: 1e-6)\n"
+        "  --warm-start FILE    Start from the SPs/ECs of an earlier grammar (PCFG text or snapshot)\n"
+        "  --save-snapshot FILE Also write the learned grammar to FILE as a binary snapshot\n"
+        "  --out-of-core DIR    Keep paths, occurrence lists and parse trees in memory-mapped files in DIR\n"
+        "  --resident-mb N      Out-of-core: MB of hot occurrence lists to keep resident, and of the search memo (default: 256)\n"
+        "  --partition          Distill unconnected parts of the corpus separately, in parallel\n"
+        "                       (units are numbered by part; the grammar can differ from a serial run)\n"
+        "  --threads N          Partition: number of worker threads (default: hardware concurrency)\n"
+        "  --progressive N      Distill a random sample of N sentences, then doubled samples, then the corpus\n"
+        "  --budget S           Progressive: distill no further sample after S seconds (default: 0, no limit)\n"
+        "  --stage-output PREFIX  Progressive: write each sample's grammar to PREFIX.stageK.pcfg\n"
         "  --version            Show version and build info, then exit\n"
     };
 
@@ -87,6 +463,21 @@ int run_cli(int argc, char *argv[])
     bool quiet = false;
     bool show_version = false;
     int num_new_sequences = 0;
+    unsigned int relayout_interval = 0;
+    std::string events_filename;
+    std::string precision = "double";
+    unsigned int approximate_above = 0;
+    double approximation_error = 1e-6;
+    std::string warm_start_filename;
+    std::string snapshot_filename;
+    std::string out_of_core_dir;
+    std::size_t resident_mb = 256;
+    bool partition = false;
+    std::size_t progressive = 0;
+    double budget = 0.0;
+    std::string stage_prefix;
+    std::vector<unsigned int> context_schedule;
+    unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
 
     // Positional arguments (required)
     app.add_option("input", input_filename, "Input corpus file (required)")->required();
@@ -100,6 +491,25 @@ int run_cli(int argc, char *argv[])
         ->check(CLI::IsMember({"json", "pcfg", "text"}));
     app.add_flag("--verbose", verbose, "Enable verbose output");
     app.add_flag("--quiet", quiet, "Suppress all non-error output");
+    app.add_option("--relayout", relayout_interval, "Renumber nodes/regroup paths for locality every N iterations (default: 0, off)");
+    app.add_option("--context-schedule", context_schedule, "Converge at each context size in the comma-separated list first, e.g. 2,3 (strictly increasing, below <context_size>)")
+        ->delimiter(',')->check(CLI::Range(1, 100));
+    app.add_option("--events", events_filename, "Stream learned SPs/ECs to FILE as JSON Lines during distillation");
+    app.add_option("--precision", precision, "Statistics precision: double, single, or validate (default: double)")
+        ->check(CLI::IsMember({"double", "single", "validate"}));
+    app.add_option("--approximate-above", approximate_above, "Approximate significance tails for pattern counts >= N (default: 0, always exact)");
+    app.add_option("--approximation-error", approximation_error, "Largest error bound accepted for an approximated tail (default: 1e-6)")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--warm-start", warm_start_filename, "Start from the SPs/ECs of an earlier grammar (PCFG text or snapshot)");
+    app.add_option("--save-snapshot", snapshot_filename, "Also write the learned grammar to FILE as a binary snapshot");
+    app.add_option("--out-of-core", out_of_core_dir, "Keep paths, occurrence lists and parse trees in memory-mapped files in DIR");
+    app.add_option("--resident-mb", resident_mb, "Out-of-core: MB of hot occurrence lists to keep resident, and of the search memo (default: 256)");
+    app.add_flag("--partition", partition, "Distill unconnected parts of the corpus separately, in parallel (units are numbered by part; the grammar can differ from a serial run)");
+    app.add_option("--threads", num_threads, "Partition: number of worker threads (default: hardware concurrency)");
+    app.add_option("--progressive", progressive, "Distill a random sample of N sentences, then doubled samples, then the corpus");
+    app.add_option("--budget", budget, "Progressive: distill no further sample after S seconds (default: 0, no limit)")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--stage-output", stage_prefix, "Progressive: write each sample's grammar to PREFIX.stageK.pcfg");
     app.add_flag("--version", show_version, "Show version and build info, then exit");
 
     try {
@@ -119,6 +529,20 @@ int run_cli(int argc, char *argv[])
 
     // Mutually exclusive: if both set, quiet wins
     if (quiet) verbose = false;
+    if (partition && !events_filename.empty()) {
+        std::cerr << "[main] Error: --events cannot be combined with --partition." << std::endl;
+        return 1;
+    }
+    if (progressive > 0 && (partition || !warm_start_filename.empty())) {
+        std::cerr << "[main] Error: --progressive cannot be combined with --partition or --warm-start." << std::endl;
+        return 1;
+    }
+    for (size_t s = 0; s < context_schedule.size(); s++) {
+        if (context_schedule[s] >= static_cast<unsigned int>(context_size) || (s > 0 && context_schedule[s] <= context_schedule[s - 1])) {
+            std::cerr << "[main] Error: --context-schedule must be strictly increasing and below <context_size>." << std::endl;
+            return 1;
+        }
+    }
 
     // Simple logging utility for verbose mode
     auto log_info = [&](const std::string& msg) {
@@ -135,24 +559,161 @@ int run_cli(int argc, char *argv[])
         return 2;
     }
     infile.close();
-    // Read input sequences (robust to plain or ADIOS-style input)
-    log_info("[madios] Parsing sequences from file...");
-    vector<vector<string> > sequences = readSequencesFromFile(input_filename);
-    if (sequences.empty()) {
-        std::cerr << "[main] Error: No sequences found in input file '" << input_filename << "'." << std::endl;
-        return 4;
+    // Read input sequences (robust to plain or ADIOS-style input); out of core, they are streamed
+    // into the graph instead
+    vector<vector<string> > sequences;
+    if (out_of_core_dir.empty()) {
+        log_info("[madios] Parsing sequences from file...");
+        sequences = readSequencesFromFile(input_filename);
+        if (sequences.empty()) {
+            std::cerr << "[main] Error: No sequences found in input file '" << input_filename << "'." << std::endl;
+            return 4;
+        }
+    }
+    // --- Load the grammar to warm-start from, if any ---
+    PCFG warm_grammar;
+    if (!warm_start_filename.empty()) {
+        log_info("[madios] Reading warm-start grammar: " + warm_start_filename);
+        std::ifstream warm_file(warm_start_filename, std::ios::binary);
+        if (!warm_file.good()) {
+            std::cerr << "[main] Error: Cannot open grammar file '" << warm_start_filename << "'." << std::endl;
+            return 2;
+        }
+        try {
+            warm_grammar = PCFG::load(warm_file);
+        } catch (const std::exception &e) {
+            std::cerr << "[main] Error: " << e.what() << std::endl;
+            return 3;
+        }
+    }
+    // --- Set up out-of-core storage, if requested ---
+    std::shared_ptr<MappedStore> store;
+    if (!out_of_core_dir.empty()) {
+        try {
+            store = std::make_shared<MappedStore>(out_of_core_dir, resident_mb << 20);
+        } catch (const std::exception &e) {
+            std::cerr << "[main] Error: " << e.what() << std::endl;
+            return 2;
+        }
     }
     // --- Build the initial ADIOS graph ---
     log_info("[madios] Building initial graph...");
-    RDSGraph testGraph(sequences);
+    std::unique_ptr<RDSGraph> graph;
+    if (store) {
+        std::ifstream corpus(input_filename);
+        try {
+            graph = std::make_unique<RDSGraph>(corpus, store);
+        } catch (const std::invalid_argument &) {
+            std::cerr << "[main] Error: No sequences found in input file '" << input_filename << "'." << std::endl;
+            return 4;
+        }
+    } else {
+        graph = std::make_unique<RDSGraph>(sequences);
+    }
+    RDSGraph &testGraph = *graph;
     testGraph.setQuiet(format != "text" || quiet); // Suppress verbose output if not text or if quiet
+    ADIOSParams params(eta, alpha, context_size, coverage);
+    params.relayoutInterval = relayout_interval;
+    params.contextSchedule = context_schedule;
+    if (precision == "single")
+        params.precision = StatsPrecision::Single;
+    else if (precision == "validate")
+        params.precision = StatsPrecision::Validate;
+    params.approximateAbove = approximate_above;
+    params.approximationError = approximation_error;
+    std::shared_ptr<PatternEventLog> event_log;
+    if (!events_filename.empty()) {
+        try {
+            event_log = std::make_shared<PatternEventLog>(events_filename);
+        } catch (const std::exception &e) {
+            std::cerr << "[main] Error: " << e.what() << std::endl;
+            return 5;
+        }
+        testGraph.setEventLog(event_log);
+    }
     double startTime = getTime();
+    if (!warm_start_filename.empty()) {
+        try {
+            unsigned int units = testGraph.warmStart(warm_grammar);
+            log_info("[madios] Warm start: " + std::to_string(units) + " units from " + warm_start_filename);
+        } catch (const std::exception &e) {
+            std::cerr << "[main] Error: " << e.what() << std::endl;
+            return 3;
+        }
+    }
+    bool stage_error = false;
+    auto report_stage = [&](const ProgressiveStage &stage, const RDSGraph &graph) {
+        std::ostringstream summary;
+        summary << "Stage " << stage.number << ": " << stage.sentences << " sentences, " << stage.seededUnits << " units carried over, "
+                << stage.patterns << " SPs, " << stage.classes << " ECs, ";
+        if (stage.heldOutTested > 0)
+            summary << stage.heldOutParsed << "/" << stage.heldOutTested << " held-out sentences parsed, ";
+        summary << stage.seconds << " s (" << stage.elapsed << " s total)";
+        if (!stage.distilled)
+            summary << ", budget spent: corpus reduced, not distilled";
+        madios::Logger::info(summary.str());
+        if (!quiet) std::cerr << "[madios] " << summary.str() << std::endl;
+        if (stage.final || stage_prefix.empty())
+            return;
+        std::string stage_filename = stage_prefix + ".stage" + std::to_string(stage.number) + ".pcfg";
+        std::ofstream stage_file(stage_filename);
+        if (stage_file.is_open())
+            graph.convert2PCFG(stage_file);
+        if (!stage_file) {
+            std::cerr << "[main] Error: Cannot write stage grammar '" << stage_filename << "'." << std::endl;
+            stage_error = true;
+        }
+    };
+    bool first_run = true;
+    auto run_distillation = [&]() {
+        bool progressive_run = (progressive > 0) && first_run;
+        first_run = false;
+        if (progressive_run) {
+            testGraph.distillProgressive(params, progressive, budget, getDeterministicSeed(), report_stage);
+            return;
+        }
+        if (!partition) {
+            testGraph.distill(params);
+            return;
+        }
+        unsigned int components = testGraph.distillPartitioned(params, num_threads);
+        log_info("[madios] Partitioned distillation: " + std::to_string(components) + " components");
+    };
     // --- Run the ADIOS grammar induction algorithm ---
     log_info("[madios] Running distillation...");
     madios::Logger::trace("Running ADIOS grammar induction");
-    testGraph.distill(ADIOSParams(eta, alpha, context_size, coverage));
+    run_distillation();
     double endTime = getTime();
+    if (stage_error)
+        return 5;
     log_info("[madios] Distillation complete. Time elapsed: " + std::to_string(endTime - startTime) + " seconds");
+    if (params.precision == StatsPrecision::Validate) {
+        std::string summary = "Precision validation: " + std::to_string(testGraph.getPrecisionMismatches()) + " of " + std::to_string(testGraph.getPrecisionChecks()) + " pattern decisions differ in single precision";
+        madios::Logger::info(summary);
+        if (!quiet) std::cerr << "[madios] " << summary << std::endl;
+    }
+    if (!params.contextSchedule.empty()) {
+        std::ostringstream summary;
+        summary << "Context schedule:";
+        for (const auto &stage : testGraph.getContextStages())
+            summary << " " << stage.contextSize << " (" << stage.iterations << " iterations, " << stage.seconds << " s)";
+        madios::Logger::info(summary.str());
+        if (!quiet) std::cerr << "[madios] " << summary.str() << std::endl;
+    }
+    if (params.approximateAbove > 0) {
+        std::string summary = "Approximation: " + std::to_string(testGraph.getApproximatedSearches()) + " pattern searches used approximated tails; " + std::to_string(testGraph.getUncertainSearches()) + " could decide differently from exact mode";
+        madios::Logger::info(summary);
+        if (!quiet) std::cerr << "[madios] " << summary << std::endl;
+    }
+    if (!snapshot_filename.empty()) {
+        std::ofstream snapshot_file(snapshot_filename, std::ios::binary);
+        if (snapshot_file.is_open())
+            testGraph.toPCFG().writeSnapshot(snapshot_file);
+        if (!snapshot_file) {
+            std::cerr << "[main] Error: Cannot write snapshot file '" << snapshot_filename << "'." << std::endl;
+            return 5;
+        }
+    }
     // --- Output handling: JSON, PCFG, or human-readable ---
     std::ostream* out = &std::cout;
     std::ofstream outfile;
@@ -175,7 +736,7 @@ int run_cli(int argc, char *argv[])
     // Output results in JSON, PCFG, or human-readable format
     if(format == "json") {
         nlohmann::json j;
-        j["corpus"] = sequences;
+        j["corpus"] = store ? readSequencesFromFile(input_filename) : sequences;  // the document is built in memory anyway
         // --- Output search paths ---
         std::vector<std::vector<std::string>> search_paths;
         for(const auto& path : testGraph.getPaths()) {
@@ -218,15 +779,25 @@ int run_cli(int argc, char *argv[])
         (*out) << "contextSize = " << context_size << std::endl;
         (*out) << "overlapThreshold = " << coverage << std::endl;
         (*out) << "BEGIN CORPUS ----------" << std::endl;
-        for(unsigned int i = 0; i < sequences.size(); i++) {
-            for(unsigned int j = 0; j < sequences[i].size(); j++)
-                (*out) << sequences[i][j] << " ";
+        auto echo = [&](const vector<string> &sequence) {
+            for(unsigned int j = 0; j < sequence.size(); j++)
+                (*out) << sequence[j] << " ";
             (*out) << std::endl;
+        };
+        if (store) {
+            // out of core, the corpus is streamed from the input file again
+            std::ifstream corpus(input_filename);
+            vector<string> sequence;
+            while (readSequence(corpus, sequence))
+                echo(sequence);
+        } else {
+            for(unsigned int i = 0; i < sequences.size(); i++)
+                echo(sequences[i]);
         }
         (*out) << "END CORPUS ----------" << std::endl << std::endl << std::endl;
         (*out) << testGraph << std::endl;
         (*out) << "BEGIN DISTILLATION ----------" << std::endl;
-        testGraph.distill(ADIOSParams(eta, alpha, context_size, coverage));
+        run_distillation();
         (*out) << "END DISTILLATION ----------" << std::endl << std::endl;
         (*out) << testGraph << std::endl << std::endl;
         (*out) << std::endl << "Time elapsed: " << endTime - startTime << " seconds" << std::endl << std::endl << std::endl << std::endl;
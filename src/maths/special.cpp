@@ -13,6 +13,7 @@ using MathConstants::PI;
 
 #include <cassert>
 #include <cstdlib>
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <iostream>
@@ -313,6 +314,210 @@ double binom(unsigned int k, unsigned int n, double p)
     }
 }
 
+// Returns the regularized upper incomplete gamma function Q(a, x): the series for P(a, x) below
+// x = a + 1, the continued fraction for Q(a, x) above (modified Lentz)
+double gammq(double a, double x)
+{
+    assert((a > 0.0) && (x >= 0.0));
+
+    const int max_iterations = 100000;
+    if(x <= 0.0)
+        return 1.0;
+    double front = -x + a*log(x) - gammaln(a);
+    if(x < a + 1.0)
+    {
+        double term = 1.0 / a;
+        double sum = term;
+        for(int n = 1; n < max_iterations; n++)
+        {
+            term *= x / (a + n);
+            sum += term;
+            if(fabs(term) < fabs(sum) * DOUBLE_EPSILON)
+                break;
+        }
+        return 1.0 - sum * exp(front);
+    }
+    double b = x + 1.0 - a;
+    double c = 1.0 / realmin;
+    double d = 1.0 / b;
+    double h = d;
+    for(int n = 1; n < max_iterations; n++)
+    {
+        double an = -n * (n - a);
+        b += 2.0;
+        d = an * d + b;
+        if(fabs(d) < realmin)
+            d = realmin;
+        c = b + an / c;
+        if(fabs(c) < realmin)
+            c = realmin;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if(fabs(delta - 1.0) < DOUBLE_EPSILON)
+            break;
+    }
+    return exp(front) * h;
+}
+
+// Returns the standard normal distribution function
+double normal_cdf(double x)
+{
+    return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+// Returns the lower binomial tail P(X <= k) as the sum of its terms
+double binom_cdf(unsigned int k, unsigned int n, double p)
+{
+    double sum = 0.0;
+    for(unsigned int i = 0; i <= k; i++)
+        sum += binom(i, n, p);
+    return sum;
+}
+
+// Returns the continuity-corrected normal approximation of the lower binomial tail
+double binom_cdf_normal(unsigned int k, unsigned int n, double p)
+{
+    double mean = n * p;
+    double sd = sqrt(mean * (1.0 - p));
+    if(sd <= 0.0)
+        return (k >= mean) ? 1.0 : 0.0;
+    return normal_cdf((k + 0.5 - mean) / sd);
+}
+
+// Returns the Poisson(np) approximation of the lower binomial tail: P(Y <= k) = Q(k + 1, np)
+double binom_cdf_poisson(unsigned int k, unsigned int n, double p)
+{
+    return gammq(k + 1.0, n * p);
+}
+
+// Returns the Berry-Esseen bound on the error of the normal approximation (Shevtsova's constant)
+double binom_normal_error(unsigned int n, double p)
+{
+    double q = 1.0 - p;
+    double variance = n * p * q;
+    if(variance <= 0.0)
+        return std::numeric_limits<double>::infinity();
+    return 0.4748 * (p*p + q*q) / sqrt(variance);
+}
+
+// Returns the Barbour-Hall bound on the total variation distance between Bin(n, p) and Poisson(np)
+double binom_poisson_error(unsigned int n, double p)
+{
+    return (1.0 - exp(-(n * p))) * p;
+}
+
+namespace {
+
+// Utility: Continued fraction of the regularized incomplete beta function I_x(a, b) (modified
+// Lentz); iterations is set to the number of steps taken, max_iterations if it did not converge
+double betacf(double a, double b, double x, int max_iterations, int &iterations)
+{
+    double qab = a + b;
+    double qap = a + 1.0;
+    double qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 - qab * x / qap;
+    if(fabs(d) < realmin)
+        d = realmin;
+    d = 1.0 / d;
+    double h = d;
+    for(iterations = 1; iterations < max_iterations; iterations++)
+    {
+        double m = iterations;
+        double m2 = 2.0 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if(fabs(d) < realmin)
+            d = realmin;
+        c = 1.0 + aa / c;
+        if(fabs(c) < realmin)
+            c = realmin;
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if(fabs(d) < realmin)
+            d = realmin;
+        c = 1.0 + aa / c;
+        if(fabs(c) < realmin)
+            c = realmin;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if(fabs(delta - 1.0) < DOUBLE_EPSILON)
+            break;
+    }
+    return h;
+}
+
+}  // namespace
+
+// Returns the lower binomial tail as the regularized incomplete beta function I_{1-p}(n - k, k + 1),
+// with a bound on its rounding error: the log prefactor is a difference of terms up to n log n, so
+// its absolute rounding error, and the relative error of the tail, grow with their magnitude
+double binom_cdf_beta(unsigned int k, unsigned int n, double p, double &error)
+{
+    assert((p >= 0.0) && (p <= 1.0));
+
+    error = 0.0;
+    if((k >= n) || (p <= 0.0))
+        return 1.0;
+    if(p >= 1.0)
+        return 0.0;
+    const int max_iterations = 100000;
+    double a = n - k;
+    double b = k + 1.0;
+    double x = 1.0 - p;
+    double terms[] = {gammaln(a + b), gammaln(a), gammaln(b), a * log1p(-p), b * log(p)};
+    double front = terms[0] - terms[1] - terms[2] + terms[3] + terms[4];
+    double magnitude = 0.0;
+    for(double term : terms)
+        magnitude += fabs(term);
+    // the fraction converges fast on the side of the mode nearer x; the other side is the complement
+    bool direct = x < (a + 1.0) / (a + b + 2.0);
+    int iterations = 0;
+    double fraction = direct ? betacf(a, b, x, max_iterations, iterations) / a : betacf(b, a, p, max_iterations, iterations) / b;
+    if(iterations >= max_iterations)
+    {
+        error = std::numeric_limits<double>::infinity();
+        return binom_cdf(k, n, p);
+    }
+    double part = exp(front) * fraction;
+    error = DOUBLE_EPSILON * (16.0 * magnitude + 4.0 * iterations + 16.0) * part;
+    if(direct)
+        return part;
+    error += DOUBLE_EPSILON;
+    return 1.0 - part;
+}
+
+// Returns the lower binomial tail, approximated for large n when an approximation is accurate enough:
+// the O(1) normal or Poisson forms if their bound allows, otherwise the incomplete beta function
+double binom_tail(unsigned int k, unsigned int n, double p, unsigned int approximateAbove, double maxError, double &error)
+{
+    error = 0.0;
+    if((approximateAbove == 0) || (n < approximateAbove) || (k >= n))
+        return binom_cdf(k, n, p);
+    double normal_error = binom_normal_error(n, p);
+    double poisson_error = binom_poisson_error(n, p);
+    if(std::min(normal_error, poisson_error) <= maxError)
+    {
+        if(poisson_error <= normal_error)
+        {
+            error = poisson_error;
+            return binom_cdf_poisson(k, n, p);
+        }
+        error = normal_error;
+        return binom_cdf_normal(k, n, p);
+    }
+    double beta_error = 0.0;
+    double tail = binom_cdf_beta(k, n, p, beta_error);
+    if(beta_error > maxError)
+        return binom_cdf(k, n, p);
+    error = beta_error;
+    return tail;
+}
+
 // Solves cubic equations of the form o*x^3 + p*x^2 + q*x + r = 0
 unsigned int solve_cubic(double o, double p, double q, double r, double &result0, double &result1, double &result2)
 {
@@ -9,6 +9,7 @@
 
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <cstdio>
 #include <fstream>
@@ -25,17 +26,23 @@ using std::stringstream;
 std::vector<std::vector<std::string>> readSequencesFromFile(const std::string &filename) {
     std::vector<std::vector<std::string>> sequences;
     std::vector<std::string> tokens;
-    std::string token;
     std::ifstream in(filename.c_str(), std::ios::in);
     if(!in.is_open()) {
         madios::Logger::error("Unable to open file: " + filename);
-        std::cerr << "Unable to open file: " << filename << std::endl;
         exit(1);
     }
-    while(!in.eof()) {
-        std::string line;
-        getline(in, line);
-        if(line.empty()) continue;
+    while(readSequence(in, tokens))
+        sequences.push_back(tokens);
+    in.close();
+    return sequences;
+}
+
+// Reads the next non-empty sequence of a stream, skipping blank lines and dropping the markers.
+// Returns false at the end of the stream. Warns once if markers are missing.
+bool readSequence(istream &in, vector<string> &tokens) {
+    std::string line;
+    std::string token;
+    while(getline(in, line)) {
         stringstream ss(line);
         tokens.clear();
         bool has_star = false, has_hash = false;
@@ -44,19 +51,15 @@ std::vector<std::vector<std::string>> readSequencesFromFile(const std::string &f
             else if(token == "#") has_hash = true;
             else tokens.push_back(token);
         }
-        if(!tokens.empty()) {
-            if(!has_star || !has_hash) {
-                static bool warned = false;
-                if(!warned) {
-                    std::cerr << "Warning: Input line(s) missing '*' or '#' markers. Accepting as plain sequence.\n";
-                    warned = true;
-                }
-            }
-            sequences.push_back(tokens);
+        if(tokens.empty()) continue;
+        if(!has_star || !has_hash) {
+            static std::atomic<bool> warned(false);  // files may be read on several threads (batch mode)
+            if(!warned.exchange(true))
+                madios::Logger::warn("Input line(s) missing '*' or '#' markers. Accepting as plain sequence.");
         }
+        return true;
     }
-    in.close();
-    return sequences;
+    return false;
 }
 
 // Reads all lines from an input stream into a vector of strings.
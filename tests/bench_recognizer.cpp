@@ -0,0 +1,75 @@
+// File: bench_recognizer.cpp
+// Purpose: Benchmark of finite-state recognition (GrammarAutomaton) against chart parsing (InsideScorer).
+//
+// Usage: bench_recognizer <grammar.pcfg> <sentences.txt> [repetitions]
+//
+// Both recognizers are run over the same sentences; the program reports compile time, time per
+// sentence for each and the number of disagreements (which must be zero).
+
+#include "GrammarAutomaton.h"
+#include "InsideScorer.h"
+#include "MiscUtils.h"
+#include "PCFG.h"
+#include "TimeFuncs.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <grammar.pcfg> <sentences.txt> [repetitions]" << std::endl;
+        return 1;
+    }
+    std::ifstream grammar_file(argv[1]);
+    if (!grammar_file.good()) {
+        std::cerr << "Cannot open grammar file '" << argv[1] << "'" << std::endl;
+        return 2;
+    }
+    PCFG grammar = PCFG::read(grammar_file);
+    std::vector<std::vector<std::string> > sentences = readSequencesFromFile(argv[2]);
+    unsigned int repetitions = (argc > 3) ? std::atoi(argv[3]) : 10;
+    if (sentences.empty() || repetitions == 0) {
+        std::cerr << "Nothing to benchmark" << std::endl;
+        return 3;
+    }
+
+    double start = getTime();
+    GrammarAutomaton fsa(grammar);
+    double compiled = getTime();
+    InsideScorer chart(grammar);
+    double binarized = getTime();
+    std::cout << "automaton: " << (fsa.isCompiled() ? "compiled" : "fallback (" + fsa.fallbackReason() + ")")
+              << ", " << fsa.stateCount() << " states, " << fsa.transitionCount() << " transitions, "
+              << (compiled - start) << " s to build" << std::endl;
+    std::cout << "chart parser: " << chart.symbolCount() << " symbols, " << (binarized - compiled) << " s to build" << std::endl;
+
+    unsigned int fsa_accepted = 0, chart_accepted = 0, disagreements = 0;
+    std::vector<bool> fsa_results(sentences.size());
+    start = getTime();
+    for (unsigned int r = 0; r < repetitions; ++r)
+        for (size_t i = 0; i < sentences.size(); ++i)
+            fsa_results[i] = fsa.recognizes(sentences[i]);
+    double fsa_time = getTime() - start;
+    start = getTime();
+    for (size_t i = 0; i < sentences.size(); ++i) {
+        bool parsed = chart.score(sentences[i]).status == InsideScorer::Status::Parsed;
+        chart_accepted += parsed;
+        fsa_accepted += fsa_results[i];
+        disagreements += (parsed != fsa_results[i]);
+    }
+    double chart_time = getTime() - start;
+
+    double fsa_per_sentence = fsa_time / (static_cast<double>(repetitions) * sentences.size());
+    double chart_per_sentence = chart_time / sentences.size();
+    std::cout << "sentences: " << sentences.size() << ", accepted: " << fsa_accepted << " (automaton) / "
+              << chart_accepted << " (chart), disagreements: " << disagreements << std::endl;
+    std::cout << "automaton: " << fsa_per_sentence * 1e6 << " us/sentence" << std::endl;
+    std::cout << "chart:     " << chart_per_sentence * 1e6 << " us/sentence" << std::endl;
+    if (fsa_per_sentence > 0.0)
+        std::cout << "speedup:   " << chart_per_sentence / fsa_per_sentence << "x" << std::endl;
+    return (disagreements == 0) ? 0 : 4;
+}
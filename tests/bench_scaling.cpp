@@ -0,0 +1,299 @@
+// File: bench_scaling.cpp
+// Purpose: Empirical complexity harness: fits how distillation time and peak memory grow with the corpus.
+//
+// Usage: bench_scaling [--axis sentences|length|vocab] [--start N] [--steps K] [--factor F]
+//                      [--sentences N] [--length L] [--vocab V] [--seed S]
+//                      [--eta E] [--alpha A] [--context C] [--overlap O]
+//                      [--max-time-exponent X] [--max-memory-exponent X]
+//
+// A synthetic corpus is generated for every point of a geometric series along one axis (number of
+// sentences, sentence length or vocabulary size; the other two stay fixed). Each point runs in its
+// own child process so that peak memory is measured from a clean baseline. Three phases are timed:
+// graph construction, distillation and PCFG export. Memory is the growth of the peak resident set
+// during each phase, which is zero for a phase that stays below an earlier peak. For each phase the
+// exponent b of time ~ n^b and of peak growth ~ n^b is fitted by least squares in log-log space; the program fails (exit code 4)
+// if any exponent exceeds its threshold (default 2.5 for time, since the pattern search is inherently
+// about quadratic in the corpus size, and 1.5 for memory), which catches an accidental extra factor
+// of n such as a quadratic insertion inside rewiring.
+
+#include "ADIOSUtils.h"
+#include "Logger.h"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "TimeFuncs.h"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int phase_count = 3;
+const char *const phase_names[phase_count] = {"build", "distill", "export"};
+
+// Fewer points than this (after dropping unmeasurable ones) give no exponent.
+const unsigned int min_fit_points = 3;
+// Phases faster than this are too noisy to fit.
+const double min_fit_seconds = 1e-3;
+
+struct CorpusShape
+{
+    unsigned int sentences;
+    unsigned int length;
+    unsigned int vocabulary;
+};
+
+struct Sample
+{
+    double seconds[phase_count];
+    double kilobytes[phase_count];   // growth of the peak resident set during the phase
+};
+
+// Utility: generate a corpus from a fixed random template grammar. Words are split into a few word
+// classes; every sentence instantiates one of a few templates whose slots are either a fixed word or
+// a word class, so that distillation has patterns and equivalence classes to find at every size.
+std::vector<std::vector<std::string> > generateCorpus(const CorpusShape &shape, unsigned int seed)
+{
+    const unsigned int class_count = std::min(6u, shape.vocabulary);
+    const unsigned int template_count = 8;
+    std::mt19937 rng(seed);
+    std::vector<std::vector<std::string> > members(class_count);
+    for(unsigned int w = 0; w < shape.vocabulary; w++)
+        members[w % class_count].push_back("w" + std::to_string(w));
+
+    // A slot is a class index below class_count, or class_count + w for the fixed word w.
+    std::vector<std::vector<unsigned int> > templates(template_count, std::vector<unsigned int>(shape.length));
+    for(auto &slots : templates)
+        for(auto &slot : slots)
+            slot = (rng() % 2) ? (rng() % class_count) : (class_count + rng() % shape.vocabulary);
+
+    std::vector<std::vector<std::string> > corpus(shape.sentences);
+    for(auto &sentence : corpus)
+        for(unsigned int slot : templates[rng() % template_count])
+            if(slot < class_count)
+                sentence.push_back(members[slot][rng() % members[slot].size()]);
+            else
+                sentence.push_back("w" + std::to_string(slot - class_count));
+    return corpus;
+}
+
+// Utility: peak resident set size of this process in kilobytes.
+double peakKilobytes()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss);
+}
+
+// Utility: run the three phases on one corpus in the current process.
+Sample measure(const CorpusShape &shape, unsigned int seed, const ADIOSParams &params)
+{
+    std::vector<std::vector<std::string> > corpus = generateCorpus(shape, seed);
+    Sample sample;
+    double peak = peakKilobytes();
+
+    double start = getTime();
+    RDSGraph graph(corpus);
+    graph.setQuiet(true);
+    sample.seconds[0] = getTime() - start;
+    sample.kilobytes[0] = peakKilobytes() - peak;
+
+    peak = peakKilobytes();
+    start = getTime();
+    graph.distill(params);
+    sample.seconds[1] = getTime() - start;
+    sample.kilobytes[1] = peakKilobytes() - peak;
+
+    peak = peakKilobytes();
+    start = getTime();
+    PCFG grammar = graph.toPCFG();
+    sample.seconds[2] = getTime() - start;
+    sample.kilobytes[2] = peakKilobytes() - peak;
+    return sample;
+}
+
+// Utility: run measure() in a child process and read the sample back through a pipe.
+bool measureInChild(const CorpusShape &shape, unsigned int seed, const ADIOSParams &params, Sample &sample)
+{
+    int fds[2];
+    if(pipe(fds) != 0)
+        return false;
+    std::cout.flush();
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if(pid == 0)
+    {
+        close(fds[0]);
+        Sample result = measure(shape, seed, params);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    size_t received = 0;
+    char *buffer = reinterpret_cast<char *>(&sample);
+    while(received < sizeof(sample))
+    {
+        ssize_t n = read(fds[0], buffer + received, sizeof(sample) - received);
+        if(n <= 0)
+            break;
+        received += static_cast<size_t>(n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return (received == sizeof(sample)) && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+// Utility: least-squares slope of log(y) against log(x) over the points with y >= floor.
+// Returns NaN if fewer than min_fit_points remain.
+double fitExponent(const std::vector<double> &x, const std::vector<double> &y, double floor)
+{
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    unsigned int n = 0;
+    for(size_t i = 0; i < x.size(); i++)
+    {
+        if(y[i] < floor)
+            continue;
+        double lx = std::log(x[i]), ly = std::log(y[i]);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+        n++;
+    }
+    double denominator = n * sxx - sx * sx;
+    if((n < min_fit_points) || (denominator <= 0.0))
+        return std::nan("");
+    return (n * sxy - sx * sy) / denominator;
+}
+
+void usage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [--axis sentences|length|vocab] [--start N] [--steps K] [--factor F]\n"
+              << "       [--sentences N] [--length L] [--vocab V] [--seed S]\n"
+              << "       [--eta E] [--alpha A] [--context C] [--overlap O]\n"
+              << "       [--max-time-exponent X] [--max-memory-exponent X]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string axis = "sentences";
+    double start_size = 50.0, factor = 2.0;
+    unsigned int steps = 5, seed = 1;
+    CorpusShape shape = {200, 8, 60};
+    double eta = 0.9, alpha = 0.01, overlap = 0.65;
+    unsigned int context = 5;
+    double max_time_exponent = 2.5, max_memory_exponent = 1.5;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if(i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *value = argv[++i];
+        if(option == "--axis") axis = value;
+        else if(option == "--start") start_size = std::atof(value);
+        else if(option == "--steps") steps = std::atoi(value);
+        else if(option == "--factor") factor = std::atof(value);
+        else if(option == "--sentences") shape.sentences = std::atoi(value);
+        else if(option == "--length") shape.length = std::atoi(value);
+        else if(option == "--vocab") shape.vocabulary = std::atoi(value);
+        else if(option == "--seed") seed = std::atoi(value);
+        else if(option == "--eta") eta = std::atof(value);
+        else if(option == "--alpha") alpha = std::atof(value);
+        else if(option == "--context") context = std::atoi(value);
+        else if(option == "--overlap") overlap = std::atof(value);
+        else if(option == "--max-time-exponent") max_time_exponent = std::atof(value);
+        else if(option == "--max-memory-exponent") max_memory_exponent = std::atof(value);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    unsigned int CorpusShape::*axis_field = (axis == "sentences") ? &CorpusShape::sentences
+                                          : (axis == "length") ? &CorpusShape::length
+                                          : (axis == "vocab") ? &CorpusShape::vocabulary : nullptr;
+    if((axis_field == nullptr) || (steps < min_fit_points) || (factor <= 1.0) || (start_size < 1.0) ||
+       (shape.sentences == 0) || (shape.length == 0) || (shape.vocabulary == 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    ADIOSParams params(eta, alpha, context, overlap);
+    madios::Logger::setLevel(madios::Logger::Level::ERROR);
+
+    std::cout << "axis: " << axis << ", params: eta " << eta << " alpha " << alpha << " context " << context
+              << " overlap " << overlap << std::endl;
+    std::cout << std::setw(10) << axis;
+    for(const char *name : phase_names)
+        std::cout << std::setw(12) << (std::string(name) + " s");
+    for(const char *name : phase_names)
+        std::cout << std::setw(13) << (std::string(name) + " +KB");
+    std::cout << std::endl;
+
+    std::vector<double> sizes;
+    std::vector<double> seconds[phase_count], kilobytes[phase_count];
+    double size = start_size;
+    for(unsigned int step = 0; step < steps; step++, size *= factor)
+    {
+        shape.*axis_field = static_cast<unsigned int>(std::lround(size));
+        Sample sample;
+        if(!measureInChild(shape, seed, params, sample))
+        {
+            std::cerr << "Measurement failed at " << axis << " = " << shape.*axis_field << std::endl;
+            return 2;
+        }
+        sizes.push_back(shape.*axis_field);
+        std::cout << std::setw(10) << shape.*axis_field << std::fixed;
+        for(int p = 0; p < phase_count; p++)
+        {
+            seconds[p].push_back(sample.seconds[p]);
+            std::cout << std::setw(12) << std::setprecision(4) << sample.seconds[p];
+        }
+        for(int p = 0; p < phase_count; p++)
+        {
+            kilobytes[p].push_back(sample.kilobytes[p]);
+            std::cout << std::setw(13) << std::setprecision(0) << sample.kilobytes[p];
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    bool regressed = false;
+    std::cout << std::setprecision(3);
+    for(int p = 0; p < phase_count; p++)
+    {
+        double time_exponent = fitExponent(sizes, seconds[p], min_fit_seconds);
+        double memory_exponent = fitExponent(sizes, kilobytes[p], 1.0);
+        bool slow = !std::isnan(time_exponent) && (time_exponent > max_time_exponent);
+        bool large = !std::isnan(memory_exponent) && (memory_exponent > max_memory_exponent);
+        regressed = regressed || slow || large;
+        std::cout << std::setw(8) << phase_names[p] << ": time ~ n^";
+        if(std::isnan(time_exponent)) std::cout << "?";
+        else std::cout << time_exponent;
+        std::cout << (slow ? " (REGRESSED)" : "") << ", peak growth ~ n^";
+        if(std::isnan(memory_exponent)) std::cout << "?";
+        else std::cout << memory_exponent;
+        std::cout << (large ? " (REGRESSED)" : "") << std::endl;
+    }
+    std::cout << "thresholds: time " << max_time_exponent << ", memory " << max_memory_exponent << std::endl;
+    return regressed ? 4 : 0;
+}
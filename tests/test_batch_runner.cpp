@@ -0,0 +1,145 @@
+// File: test_batch_runner.cpp
+// Purpose: Unit tests for batch distillation (BatchRunner) and per-job memory budgets (JobMemory).
+
+#include "catch.hpp"
+#include "BatchRunner.h"
+#include "JobMemory.h"
+#include "MiscUtils.h"
+#include "RDSGraph.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// test/corpus.txt in the source tree (MADIOS_SOURCE_DIR is set by CMake)
+std::string testCorpusPath() {
+    return MADIOS_SOURCE_DIR "/test/corpus.txt";
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string expectedGrammar(const std::string& corpus, unsigned int contextSize) {
+    RDSGraph graph(readSequencesFromFile(corpus));
+    graph.setQuiet(true);
+    graph.distill(ADIOSParams(0.9, 0.01, contextSize, 0.65));
+    std::ostringstream out;
+    graph.convert2PCFG(out);
+    return out.str();
+}
+
+}  // namespace
+
+TEST_CASE("JobMemory: counts the thread's allocations and refuses those over the limit", "[batch]") {
+    {
+        JobMemory budget(0);
+        REQUIRE(JobMemory::active());
+        std::vector<char> block(1 << 20);
+        REQUIRE(budget.used() >= (1u << 20));
+        block = std::vector<char>();
+        REQUIRE(budget.used() < (1u << 20));
+        REQUIRE(budget.peak() >= (1u << 20));
+        REQUIRE_FALSE(budget.exceeded());
+    }
+    REQUIRE_FALSE(JobMemory::active());
+
+    JobMemory budget(1 << 20);
+    REQUIRE_THROWS_AS(std::vector<char>(2 << 20), std::bad_alloc);
+    REQUIRE(budget.exceeded());
+    std::vector<char> after(2 << 20);  // once refused, the budget only counts
+    REQUIRE(budget.peak() >= (2u << 20));
+}
+
+TEST_CASE("JobMemory: threads attached to a budget are charged to it", "[batch]") {
+    JobMemory budget(1 << 20);
+    bool attached = false, refused = false;
+    std::thread worker([&]() {  // Catch assertions stay on the test thread
+        JobMemory::Attach attach(&budget);
+        attached = (JobMemory::current() == &budget);
+        try { std::vector<char> block(2 << 20); } catch (const std::bad_alloc&) { refused = true; }
+    });
+    worker.join();
+    REQUIRE(attached);
+    REQUIRE(refused);
+    REQUIRE(budget.exceeded());
+}
+
+TEST_CASE("BatchRunner: manifests are parsed with options and relative paths", "[batch]") {
+    std::istringstream manifest("# nightly jobs\n"
+                                "\n"
+                                "a.txt a.pcfg 0.9 0.01 5 0.65\n"
+                                "/data/b.txt out/b.snap 0.8 0.05 3 0.5 format=snapshot memory-mb=64\n");
+    std::vector<BatchRunner::Job> jobs = BatchRunner::readManifest(manifest, "/corpora");
+    REQUIRE(jobs.size() == 2);
+    REQUIRE(jobs[0].corpus == "/corpora/a.txt");
+    REQUIRE(jobs[0].format == "pcfg");
+    REQUIRE(jobs[0].memoryLimit == 0);
+    REQUIRE(jobs[1].corpus == "/data/b.txt");
+    REQUIRE(jobs[1].output == "/corpora/out/b.snap");
+    REQUIRE(jobs[1].params.contextSize == 3);
+    REQUIRE(jobs[1].params.alpha == 0.05);
+    REQUIRE(jobs[1].format == "snapshot");
+    REQUIRE(jobs[1].memoryLimit == (std::size_t(64) << 20));
+
+    std::istringstream missing("a.txt a.pcfg 0.9 0.01\n");
+    REQUIRE_THROWS_AS(BatchRunner::readManifest(missing), std::runtime_error);
+    std::istringstream unknown("a.txt a.pcfg 0.9 0.01 5 0.65 threads=4\n");
+    REQUIRE_THROWS_AS(BatchRunner::readManifest(unknown), std::runtime_error);
+    std::istringstream range("a.txt a.pcfg 1.5 0.01 5 0.65\n");
+    REQUIRE_THROWS_AS(BatchRunner::readManifest(range), std::runtime_error);
+}
+
+TEST_CASE("BatchRunner: concurrent jobs learn the same grammars as single runs and fail alone", "[batch]") {
+    std::string corpus = testCorpusPath();
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "madios-batch-test";
+    std::filesystem::create_directories(directory);
+
+    std::vector<BatchRunner::Job> jobs;
+    for (unsigned int contextSize : {3u, 5u, 3u, 5u}) {
+        BatchRunner::Job job;
+        job.corpus = corpus;
+        job.output = (directory / ("job" + std::to_string(jobs.size()) + ".pcfg")).string();
+        job.params = ADIOSParams(0.9, 0.01, contextSize, 0.65);
+        jobs.push_back(job);
+    }
+    BatchRunner::Job missing = jobs[0];
+    missing.corpus = (directory / "missing.txt").string();
+    missing.output = (directory / "missing.pcfg").string();
+    jobs.push_back(missing);
+    BatchRunner::Job starved = jobs[0];
+    starved.output = (directory / "starved.pcfg").string();
+    starved.memoryLimit = 64 << 10;
+    jobs.push_back(starved);
+
+    BatchRunner runner(3);
+    std::vector<BatchRunner::Result> results = runner.run(jobs);
+    REQUIRE(results.size() == jobs.size());
+    std::string expected3 = expectedGrammar(corpus, 3);
+    std::string expected5 = expectedGrammar(corpus, 5);
+    for (unsigned int i = 0; i < 4; i++) {
+        REQUIRE(results[i].status == BatchRunner::Status::Succeeded);
+        REQUIRE(results[i].sequences > 0);
+        REQUIRE(results[i].peakBytes > 0);
+        REQUIRE(readFile(jobs[i].output) == ((i % 2 == 0) ? expected3 : expected5));
+        REQUIRE(std::filesystem::exists(jobs[i].output + ".log"));
+    }
+    REQUIRE(results[4].status == BatchRunner::Status::Failed);
+    REQUIRE(results[4].message.find("cannot open corpus") != std::string::npos);
+    REQUIRE(results[5].status == BatchRunner::Status::OutOfMemory);
+    REQUIRE(readFile(jobs[5].output + ".log").find("memory limit") != std::string::npos);
+
+    std::ostringstream report;
+    runner.writeReport(report, jobs, results, 1.0);
+    REQUIRE(report.str().find("# jobs 6 ok 4 failed 1 out-of-memory 1") != std::string::npos);
+
+    std::filesystem::remove_all(directory);
+}
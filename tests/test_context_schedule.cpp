@@ -0,0 +1,107 @@
+// File: test_context_schedule.cpp
+// Purpose: Unit tests for coarse-to-fine context size schedules in RDSGraph::distill.
+
+#include "catch.hpp"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<std::string>> scheduleCorpus() {
+    return corpusOf({"Cindy believes that Joe believes that to please is easy",
+                     "Cindy believes that Cindy believes that to read is tough",
+                     "Pam thinks that Jim believes that to please is tough",
+                     "Beth believes that George believes that to please is easy",
+                     "Pam believes that Cindy believes that to read is easy",
+                     "Beth thinks that Beth thinks that to read is tough",
+                     "that Cindy is easy to read annoys Cindy",
+                     "that the cat is eager to please disturbs the cat",
+                     "that the cow is easy to read annoys the horse",
+                     "that Cindy is eager to please bothers the dog",
+                     "that the horse is easy to please annoys Jim",
+                     "Pam thinks that Cindy thinks that to please is easy"});
+}
+
+std::string distilled(const ADIOSParams& params, std::vector<ContextStage>* stages = nullptr) {
+    RDSGraph graph(scheduleCorpus());
+    graph.setQuiet(true);
+    graph.distill(params);
+    if (stages) *stages = graph.getContextStages();
+    std::ostringstream out;
+    graph.convert2PCFG(out);
+    return out.str();
+}
+
+// The PCFG rules of the graph's units (all but the S rules)
+std::vector<std::string> unitRules(const RDSGraph& graph) {
+    std::ostringstream out;
+    graph.convert2PCFG(out);
+    std::istringstream in(out.str());
+    std::vector<std::string> rules;
+    std::string line;
+    while (std::getline(in, line))
+        if (!line.empty() && line.compare(0, 2, "S ") != 0) rules.push_back(line);
+    return rules;
+}
+
+}  // namespace
+
+TEST_CASE("RDSGraph: without a schedule distill runs one stage at contextSize", "[schedule]") {
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    std::vector<ContextStage> stages;
+    std::string plain = distilled(params, &stages);
+    REQUIRE(stages.size() == 1);
+    REQUIRE(stages[0].contextSize == 5);
+    REQUIRE(stages[0].iterations >= 1);
+}
+
+TEST_CASE("RDSGraph: a schedule must increase strictly and stay below contextSize", "[schedule]") {
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    for (const std::vector<unsigned int>& schedule : std::vector<std::vector<unsigned int>>{{5}, {2, 6}, {3, 2}, {2, 2}}) {
+        params.contextSchedule = schedule;
+        RDSGraph graph(scheduleCorpus());
+        graph.setQuiet(true);
+        REQUIRE_THROWS_AS(graph.distill(params), std::invalid_argument);
+        REQUIRE_THROWS_AS(graph.distillPartitioned(params, 2), std::invalid_argument);
+    }
+}
+
+TEST_CASE("RDSGraph: a schedule converges at each context size in turn", "[schedule]") {
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    params.contextSchedule = {2, 3};
+    std::vector<ContextStage> stages;
+    std::string scheduled = distilled(params, &stages);
+    REQUIRE(stages.size() == 3);
+    REQUIRE(stages[0].contextSize == 2);
+    REQUIRE(stages[1].contextSize == 3);
+    REQUIRE(stages[2].contextSize == 5);
+    for (const auto& stage : stages) {
+        REQUIRE(stage.iterations >= 1);  // every stage ends with an iteration that finds nothing
+        REQUIRE(stage.seconds >= 0.0);
+    }
+    REQUIRE(distilled(params) == scheduled);
+}
+
+TEST_CASE("RDSGraph: units learned at a coarse context size survive into the final grammar", "[schedule]") {
+    std::vector<std::vector<std::string>> corpus = testCorpus();
+    RDSGraph coarse(corpus);
+    coarse.setQuiet(true);
+    coarse.distill(ADIOSParams(0.9, 0.01, 2, 0.65));
+    std::vector<std::string> coarse_rules = unitRules(coarse);
+    REQUIRE(!coarse_rules.empty());
+
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    params.contextSchedule = {2, 3};
+    RDSGraph scheduled(corpus);
+    scheduled.setQuiet(true);
+    scheduled.distill(params);
+    std::vector<std::string> final_rules = unitRules(scheduled);
+    REQUIRE(final_rules.size() > coarse_rules.size());  // the finer stages add units
+    for (const auto& rule : coarse_rules)
+        REQUIRE(std::find(final_rules.begin(), final_rules.end(), rule) != final_rules.end());
+}
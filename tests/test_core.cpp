@@ -11,6 +11,7 @@
 #include "madios/BasicSymbol.h"
 #include "RDSNode.h"
 #include "RDSGraph.h"
+#include <unordered_set>
 
 // Test construction and equality of BasicSymbol
 TEST_CASE("BasicSymbol: construction and equality", "[core]") {
@@ -70,3 +71,57 @@ TEST_CASE("RDSNode: error handling for invalid input", "[core]") {
     Connection bad_parent = {1, static_cast<unsigned int>(-1)};
     REQUIRE_THROWS_AS(node.addParent(bad_parent), std::invalid_argument);
 }
+
+// Test zero-copy subpath views
+TEST_CASE("PathView: subpaths without copies", "[core]") {
+    SearchPath path(std::vector<unsigned int>{1, 2, 3, 4, 5});
+    PathView middle = path.view(1, 3);
+    REQUIRE(middle.size() == 3);
+    REQUIRE(middle.data() == path.data() + 1);  // views the path's own storage
+    REQUIRE(middle[0] == 2);
+    REQUIRE(middle.back() == 4);
+    REQUIRE(middle(1, 2).front() == 3);
+    REQUIRE(SearchPath(middle) == SearchPath(path(1, 3)));
+    REQUIRE(SignificantPattern(middle) == SignificantPattern(path(1, 3)));
+    REQUIRE(path.substitute(1, 3, path.view(4, 4)) == SearchPath(std::vector<unsigned int>({1, 5, 5})));
+    REQUIRE_THROWS_AS(EquivalenceClass(PathView()), std::invalid_argument);
+}
+
+// Test the incrementally maintained path hash
+TEST_CASE("SearchPath: hash follows rewire, set, substitute and relabel", "[core]") {
+    SearchPath path(std::vector<unsigned int>{0, 7, 3, 9, 4, 2, 8, 1});
+    REQUIRE(path.hash() == SearchPath::hashOf(path));
+    REQUIRE(SearchPath(std::vector<unsigned int>{0, 3, 7, 9, 4, 2, 8, 1}).hash() != path.hash());
+
+    path.rewire(2, 4, 11);  // short prefix: suffix derived from the prefix
+    REQUIRE(path == SearchPath(std::vector<unsigned int>{0, 7, 11, 2, 8, 1}));
+    REQUIRE(path.hash() == SearchPath::hashOf(path));
+    path.rewire(4, 4, 12);  // short suffix: read directly
+    REQUIRE(path.hash() == SearchPath::hashOf(path));
+    path.rewire(0, path.size() - 1, 5);
+    REQUIRE(path.hash() == SearchPath::hashOf(std::vector<unsigned int>{5}));
+
+    SearchPath long_path(std::vector<unsigned int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    std::vector<unsigned int> longer{20, 21, 22, 23};
+    SearchPath grown = long_path.substitute(1, 2, PathView(longer));
+    REQUIRE(grown.hash() == SearchPath::hashOf(grown));
+    SearchPath shrunk = long_path.substitute(6, 8, long_path.view(0, 0));
+    REQUIRE(shrunk == SearchPath(std::vector<unsigned int>{0, 1, 2, 3, 4, 5, 0, 9}));
+    REQUIRE(shrunk.hash() == SearchPath::hashOf(shrunk));
+
+    long_path.set(3, 30);
+    REQUIRE(long_path.hash() == SearchPath::hashOf(long_path));
+    long_path.relabel(std::vector<unsigned int>{9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 31});
+    REQUIRE(long_path[3] == 31);
+    REQUIRE(long_path.hash() == SearchPath::hashOf(long_path));
+
+    SearchPath moved(std::move(long_path));
+    REQUIRE(moved.hash() == SearchPath::hashOf(moved));
+    REQUIRE(long_path.hash() == SearchPath::hashOf(long_path));
+
+    std::unordered_set<SearchPath, SearchPathHash> seen;
+    seen.insert(grown);
+    seen.insert(shrunk);
+    seen.insert(SearchPath(std::vector<unsigned int>(grown.begin(), grown.end())));
+    REQUIRE(seen.size() == 2);
+}
@@ -0,0 +1,40 @@
+// File: test_distill_workspace.cpp
+// Purpose: Unit tests for ScratchMatrix reuse and the per-thread DistillWorkspace.
+
+#include "catch.hpp"
+#include "DistillWorkspace.h"
+#include <thread>
+
+TEST_CASE("ScratchMatrix: reset fills the region in use and keeps capacity", "[workspace]") {
+    ScratchMatrix<double> m;
+    m.reset(8, 2.0);
+    REQUIRE(m.dim1() == 8);
+    REQUIRE(m.dim2() == 8);
+    m(7, 3) = 0.5;
+    REQUIRE(m(7, 3) == 0.5);
+    REQUIRE(m(3, 7) == 2.0);
+    std::size_t capacity = m.capacity();
+    REQUIRE(capacity >= 64);
+
+    m.reset(3, -1.0);
+    REQUIRE(m.dim1() == 3);
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 3; j++)
+            REQUIRE(m(i, j) == -1.0);
+    REQUIRE(m.capacity() == capacity);
+    m.reset(8, 1.0);
+    REQUIRE(m(7, 3) == 1.0);
+    REQUIRE(m.capacity() == capacity);
+}
+
+TEST_CASE("DistillWorkspace: one workspace per thread", "[workspace]") {
+    DistillWorkspace* mine = &DistillWorkspace::local();
+    REQUIRE(&DistillWorkspace::local() == mine);
+    REQUIRE(static_cast<void*>(&mine->descents<float>()) != static_cast<void*>(&mine->descents<double>()));
+
+    DistillWorkspace* other = nullptr;
+    std::thread worker([&other]() { other = &DistillWorkspace::local(); });
+    worker.join();
+    REQUIRE(other != nullptr);
+    REQUIRE(other != mine);
+}
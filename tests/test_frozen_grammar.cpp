@@ -0,0 +1,140 @@
+// File: test_frozen_grammar.cpp
+// Purpose: Unit tests for FrozenGrammar: alias sampling, scoring and concurrent use of one instance.
+
+#include "catch.hpp"
+#include "FrozenGrammar.h"
+#include "GraphEpoch.h"
+#include "InsideScorer.h"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<std::string>> toyCorpus() {
+    std::vector<std::vector<std::string>> corpus;
+    for (const char* line : {"the cat sat on the mat", "the dog sat on the mat",
+                             "the cat lay on the rug", "the dog lay on the rug",
+                             "a cat sat on the mat", "a dog lay on the rug"})
+        corpus.push_back(words(line));
+    return corpus;
+}
+
+}  // namespace
+
+TEST_CASE("FrozenGrammar: alias tables follow rule probabilities", "[frozen]") {
+    FrozenGrammar grammar(parse(
+        "E1 -> x [0.7]\n"
+        "E1 -> y [0.2]\n"
+        "E1 -> z [0.1]\n"
+        "E2 -> u [0]\n"
+        "E2 -> v [0]\n"
+        "S -> E1 E2 [1]\n"));
+    REQUIRE(grammar.ruleCount() == 6);
+    REQUIRE(grammar.symbolId("q") == PCFG::npos);
+    REQUIRE(grammar.ruleProbability(grammar.symbolId("E1"), {grammar.symbolId("y")}) == Approx(0.2));
+
+    std::mt19937 rng(7);
+    const int draws = 20000;
+    int x = 0, y = 0, u = 0;
+    for (int i = 0; i < draws; i++) {
+        auto sentence = grammar.generate(rng);
+        REQUIRE(sentence.size() == 2);
+        x += (sentence[0] == "x");
+        y += (sentence[0] == "y");
+        u += (sentence[1] == "u");  // all-zero alternatives are drawn uniformly
+    }
+    REQUIRE(x / double(draws) == Approx(0.7).margin(0.02));
+    REQUIRE(y / double(draws) == Approx(0.2).margin(0.02));
+    REQUIRE(u / double(draws) == Approx(0.5).margin(0.02));
+}
+
+TEST_CASE("FrozenGrammar: rejects missing start symbol and runaway recursion", "[frozen]") {
+    REQUIRE_THROWS_AS(FrozenGrammar(parse("P1 -> a b [1]\n")), std::invalid_argument);
+    FrozenGrammar loop(parse("P1 -> a P1 [1]\nS -> P1 [1]\n"));
+    std::mt19937 rng(1);
+    REQUIRE_THROWS_AS(loop.generate(rng, 50), std::runtime_error);
+}
+
+TEST_CASE("FrozenGrammar: freeze matches the learned PCFG and serves concurrent readers", "[frozen]") {
+    auto corpus = toyCorpus();
+    RDSGraph g(corpus);
+    g.setQuiet(true);
+    g.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+
+    std::shared_ptr<const FrozenGrammar> frozen = g.freeze();
+    PCFG pcfg = g.toPCFG();
+    REQUIRE(frozen->symbolCount() == pcfg.symbolCount());
+    REQUIRE(frozen->ruleCount() == pcfg.rules().size());
+    InsideScorer reference(pcfg);
+    for (const auto& sentence : corpus) {
+        auto r = frozen->score(sentence);
+        REQUIRE(r.status == InsideScorer::Status::Parsed);
+        REQUIRE(r.logProbability == Approx(reference.score(sentence).logProbability));
+    }
+
+    const unsigned int num_threads = 4;
+    std::vector<int> failures(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; t++)
+        threads.emplace_back([frozen, t, &failures]() {
+            std::mt19937 rng(100 + t);
+            for (int i = 0; i < 500; i++) {
+                auto sentence = frozen->generate(rng);
+                if (frozen->score(sentence).status != InsideScorer::Status::Parsed)
+                    failures[t]++;
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+    for (int f : failures)
+        REQUIRE(f == 0);
+}
+
+TEST_CASE("RDSGraph: readers follow published epochs while distill() runs", "[frozen]") {
+    auto corpus = toyCorpus();
+    RDSGraph g(corpus);
+    g.setQuiet(true);
+    REQUIRE(g.snapshot() == nullptr);
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    params.publishInterval = 1;
+    std::thread learner([&g, &params]() { g.distill(params); });
+
+    std::shared_ptr<const GraphEpoch> epoch;
+    unsigned int last = 0, failures = 0;
+    std::mt19937 rng(7);
+    do {
+        epoch = g.snapshot();
+        if (!epoch || epoch->number == last) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (epoch->number < last || epoch->paths.size() != corpus.size() || epoch->pathNames(0).front() != "*")
+            failures++;
+        last = epoch->number;
+        auto sentence = epoch->grammar->generate(rng);
+        if (epoch->grammar->score(sentence).status != InsideScorer::Status::Parsed)
+            failures++;
+    } while (!epoch || !epoch->final);
+    learner.join();
+    REQUIRE(failures == 0);
+
+    // an epoch never changes, and the final one shows the learned graph
+    REQUIRE(epoch == g.snapshot());
+    REQUIRE(epoch->number == epoch->iteration);  // one per iteration that found patterns, and the last
+    REQUIRE(epoch->grammar->ruleCount() == g.freeze()->ruleCount());
+    for (unsigned int k = 0; k < corpus.size(); k++) {
+        std::vector<std::string> names;
+        for (unsigned int node : g.getPaths()[k])
+            names.push_back(g.getNodeName(node));
+        REQUIRE(epoch->pathNames(k) == names);
+    }
+}
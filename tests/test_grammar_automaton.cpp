@@ -0,0 +1,82 @@
+// File: test_grammar_automaton.cpp
+// Purpose: Unit tests for the finite-state recognizer compiled by GrammarAutomaton.
+//
+// The automaton must accept exactly the sentences the chart parser (InsideScorer) parses.
+
+#include "catch.hpp"
+#include "GrammarAutomaton.h"
+#include "InsideScorer.h"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+}  // namespace
+
+TEST_CASE("GrammarAutomaton: recognizes the language of a DAG grammar", "[automaton]") {
+    GrammarAutomaton fsa(parse(
+        "E1 -> x [0.6]\n"
+        "E1 -> y [0.4]\n"
+        "P2 -> E1 z [1]\n"
+        "S -> P2 w [0.5]\n"
+        "S -> P2 P2 [0.5]\n"));
+    REQUIRE(fsa.isCompiled());
+    REQUIRE(fsa.recognizes(words("x z w")));
+    REQUIRE(fsa.recognizes(words("y z x z")));
+    REQUIRE_FALSE(fsa.recognizes(words("x z")));
+    REQUIRE_FALSE(fsa.recognizes(words("x z w w")));
+    REQUIRE_FALSE(fsa.recognizes(words("x q w")));
+    REQUIRE_FALSE(fsa.recognizes(std::vector<std::string>()));
+    // start, after E1, after P2, after "P2 E1", final
+    REQUIRE(fsa.stateCount() == 5);
+}
+
+TEST_CASE("GrammarAutomaton: falls back to chart parsing", "[automaton]") {
+    GrammarAutomaton recursive(parse("P1 -> a P1 [0.5]\nP1 -> a [0.5]\nS -> P1 b [1]\n"));
+    REQUIRE_FALSE(recursive.isCompiled());
+    REQUIRE_FALSE(recursive.fallbackReason().empty());
+    REQUIRE(recursive.recognizes(words("a a a b")));
+    REQUIRE_FALSE(recursive.recognizes(words("b")));
+
+    GrammarAutomaton limited(parse("E1 -> x [0.5]\nE1 -> y [0.5]\nP2 -> E1 E1 E1 [1]\nS -> P2 P2 [1]\n"), 3);
+    REQUIRE_FALSE(limited.isCompiled());
+    REQUIRE(limited.recognizes(words("x y x y y x")));
+}
+
+TEST_CASE("GrammarAutomaton: agrees with the chart parser on a learned grammar", "[automaton]") {
+    std::vector<std::vector<std::string>> corpus;
+    for (const char* line : {"the cat sat on the mat", "the dog sat on the mat",
+                             "the cat lay on the rug", "the dog lay on the rug",
+                             "a cat sat on the mat", "a dog lay on the rug",
+                             "a cow lay on the mat", "the cow sat on the rug"})
+        corpus.push_back(words(line));
+    RDSGraph g(corpus);
+    g.setQuiet(true);
+    g.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+
+    PCFG grammar = PCFG::fromGraph(g);
+    GrammarAutomaton fsa(grammar);
+    InsideScorer chart(grammar);
+    REQUIRE(fsa.isCompiled());
+    std::vector<std::string> vocabulary = {"the", "a", "cat", "dog", "cow", "sat", "lay", "on", "mat", "rug"};
+    unsigned int accepted = 0;
+    // every sentence of the form D N V on the D N, plus some malformed ones
+    for (const auto& d1 : {"the", "a"})
+        for (const auto& n1 : {"cat", "dog", "cow", "rug"})
+            for (const auto& v : {"sat", "lay"})
+                for (const auto& n2 : {"mat", "rug", "cat"}) {
+                    std::vector<std::string> sentence = {d1, n1, v, "on", "the", n2};
+                    bool parsed = chart.score(sentence).status == InsideScorer::Status::Parsed;
+                    REQUIRE(fsa.recognizes(sentence) == parsed);
+                    accepted += parsed;
+                    sentence.pop_back();
+                    REQUIRE(fsa.recognizes(sentence) == (chart.score(sentence).status == InsideScorer::Status::Parsed));
+                }
+    for (const auto& sentence : corpus)
+        REQUIRE(fsa.recognizes(sentence));
+    REQUIRE(accepted >= corpus.size());
+}
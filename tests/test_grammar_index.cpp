@@ -0,0 +1,94 @@
+// File: test_grammar_index.cpp
+// Purpose: Unit tests for containment and reachability queries with GrammarIndex.
+
+#include "catch.hpp"
+#include "GrammarIndex.h"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+GrammarIndex indexOf(const char* text) {
+    return GrammarIndex(parse(text));
+}
+
+std::vector<std::string> names(const GrammarIndex& index, const std::vector<unsigned int>& ids) {
+    std::vector<std::string> found;
+    for (unsigned int id : ids) found.push_back(index.unitName(id));
+    return found;
+}
+
+std::set<std::string> nameSet(const GrammarIndex& index, const std::vector<unsigned int>& ids) {
+    std::vector<std::string> found = names(index, ids);
+    return std::set<std::string>(found.begin(), found.end());
+}
+
+}  // namespace
+
+TEST_CASE("GrammarIndex: direct and transitive containment", "[index]") {
+    GrammarIndex index = indexOf(
+        "E1 -> cat [0.5]\n"
+        "E1 -> dog [0.5]\n"
+        "P2 -> the E1 [1]\n"
+        "P3 -> P2 sat [1]\n"
+        "E4 -> P3 [0.5]\n"
+        "E4 -> cat [0.5]\n"
+        "S -> E4 [1]\n");
+    REQUIRE(index.unitId("S") == PCFG::npos);
+    REQUIRE(index.unitId("bird") == PCFG::npos);
+    unsigned int cat = index.unitId("cat");
+    REQUIRE(index.kind(cat) == GrammarIndex::Kind::Word);
+    REQUIRE(index.kind(index.unitId("P2")) == GrammarIndex::Kind::Pattern);
+    REQUIRE(index.kind(index.unitId("E1")) == GrammarIndex::Kind::Class);
+
+    REQUIRE(nameSet(index, index.classesContaining(cat, false)) == std::set<std::string>{"E1", "E4"});
+    REQUIRE(index.patternsContaining(cat, false).empty());
+    REQUIRE(nameSet(index, index.patternsContaining(cat)) == std::set<std::string>{"P2", "P3"});
+    REQUIRE(nameSet(index, index.containers(cat)) == std::set<std::string>{"E1", "E4", "P2", "P3"});
+    REQUIRE(index.containers(index.unitId("E4")).empty());
+
+    PathView p3 = index.elements(index.unitId("P3"));
+    REQUIRE(names(index, std::vector<unsigned int>(p3.begin(), p3.end())) == std::vector<std::string>{"P2", "sat"});
+    REQUIRE(nameSet(index, index.reachable(index.unitId("P3"))) == std::set<std::string>{"P2", "the", "E1", "cat", "dog", "sat"});
+    REQUIRE(index.reachable(cat).empty());
+    REQUIRE_THROWS_AS(index.reachable(index.unitCount()), std::out_of_range);
+}
+
+TEST_CASE("GrammarIndex: repeated elements are indexed once", "[index]") {
+    GrammarIndex index = indexOf("P1 -> a b a [1]\nS -> P1 [1]\n");
+    unsigned int a = index.unitId("a");
+    REQUIRE(index.parents(a).size() == 1);
+    REQUIRE(index.elements(index.unitId("P1")).size() == 3);
+    REQUIRE(index.reachable(index.unitId("P1")).size() == 2);
+}
+
+TEST_CASE("GrammarIndex: graph parents agree with the exported grammar", "[index]") {
+    std::vector<std::vector<std::string>> corpus;
+    for (const char* line : {"the cat sat on the mat", "the dog sat on the mat",
+                             "the cat lay on the rug", "the dog lay on the rug",
+                             "a cat sat on the mat", "a dog lay on the rug"})
+        corpus.push_back(words(line));
+    RDSGraph graph(corpus);
+    graph.setQuiet(true);
+    graph.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+
+    GrammarIndex from_graph = GrammarIndex::fromGraph(graph);
+    GrammarIndex from_pcfg(graph.toPCFG());
+    REQUIRE(from_graph.unitCount() == graph.getNodes().size());
+    unsigned int checked = 0;
+    for (unsigned int id = 0; id < from_pcfg.unitCount(); id++) {
+        unsigned int node = from_graph.unitId(from_pcfg.unitName(id));
+        REQUIRE(node != PCFG::npos);
+        REQUIRE(from_graph.kind(node) == from_pcfg.kind(id));
+        REQUIRE(nameSet(from_graph, from_graph.containers(node)) == nameSet(from_pcfg, from_pcfg.containers(id)));
+        REQUIRE(nameSet(from_graph, from_graph.reachable(node)) == nameSet(from_pcfg, from_pcfg.reachable(id)));
+        checked++;
+    }
+    REQUIRE(checked > 0);
+}
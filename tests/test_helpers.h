@@ -0,0 +1,38 @@
+// File: test_helpers.h
+// Purpose: Helpers shared by the unit tests: whitespace tokenization of inline corpora, the test
+// corpus file and inline grammars.
+
+#pragma once
+
+#include "MiscUtils.h"
+#include "PCFG.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Split a line into its whitespace-separated words, each with an optional prefix.
+inline std::vector<std::string> words(const std::string& line, const std::string& prefix = "") {
+    std::istringstream iss(line);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (iss >> token) tokens.push_back(prefix + token);
+    return tokens;
+}
+
+// Tokenize every line into one sentence of a corpus.
+inline std::vector<std::vector<std::string>> corpusOf(const std::vector<std::string>& lines, const std::string& prefix = "") {
+    std::vector<std::vector<std::string>> corpus;
+    for (const auto& line : lines) corpus.push_back(words(line, prefix));
+    return corpus;
+}
+
+// test/corpus.txt in the source tree (MADIOS_SOURCE_DIR is set by CMake)
+inline std::vector<std::vector<std::string>> testCorpus() {
+    return readSequencesFromFile(MADIOS_SOURCE_DIR "/test/corpus.txt");
+}
+
+// Read a grammar in the convert2PCFG text format.
+inline PCFG parse(const char* text) {
+    std::istringstream in(text);
+    return PCFG::read(in);
+}
@@ -0,0 +1,67 @@
+// File: test_inside_scorer.cpp
+// Purpose: Unit tests for the log-space inside algorithm of InsideScorer.
+
+#include "catch.hpp"
+#include "InsideScorer.h"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+}  // namespace
+
+TEST_CASE("InsideScorer: sums all derivations", "[inside]") {
+    InsideScorer scorer(parse(
+        "E1 -> x [0.6]\n"
+        "E1 -> y [0.4]\n"
+        "P2 -> E1 z [1]\n"
+        "P3 -> y z w [1]\n"
+        "S -> P2 w [0.3]\n"
+        "S -> x z w [0.2]\n"
+        "S -> E1 [0.3]\n"
+        "S -> P3 [0.2]\n"));
+
+    auto r = scorer.score(words("x z w"));
+    REQUIRE(r.status == InsideScorer::Status::Parsed);
+    REQUIRE(std::exp(r.logProbability) == Approx(0.3 * 0.6 + 0.2));
+    // "z w" is binarized once and shared by two rules
+    REQUIRE(std::exp(scorer.score(words("y z w")).logProbability) == Approx(0.3 * 0.4 + 0.2));
+    REQUIRE(std::exp(scorer.score(words("y")).logProbability) == Approx(0.3 * 0.4));
+
+    REQUIRE(scorer.score(words("x q w")).status == InsideScorer::Status::OutOfVocabulary);
+    REQUIRE(scorer.score(words("z x")).status == InsideScorer::Status::Unparsed);
+    REQUIRE(std::isinf(scorer.score(words("z x")).logProbability));
+    REQUIRE(std::string(InsideScorer::statusName(InsideScorer::Status::Parsed)) == "ok");
+}
+
+TEST_CASE("InsideScorer: rejects unary cycles and missing start symbol", "[inside]") {
+    REQUIRE_THROWS_AS(InsideScorer(parse("E1 -> E2 [1]\nE2 -> E1 [0.5]\nE2 -> a [0.5]\nS -> E1 [1]\n")), std::runtime_error);
+    REQUIRE_THROWS_AS(InsideScorer(parse("P1 -> a b [1]\n")), std::invalid_argument);
+}
+
+TEST_CASE("InsideScorer: training sentences parse under the learned grammar", "[inside]") {
+    std::vector<std::vector<std::string>> corpus;
+    for (const char* line : {"the cat sat on the mat", "the dog sat on the mat",
+                             "the cat lay on the rug", "the dog lay on the rug",
+                             "a cat sat on the mat", "a dog lay on the rug"})
+        corpus.push_back(words(line));
+    RDSGraph g(corpus);
+    g.setQuiet(true);
+    g.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+
+    InsideScorer scorer(PCFG::fromGraph(g));
+    double total = 0.0;
+    for (const auto& sentence : corpus) {
+        auto r = scorer.score(sentence);
+        REQUIRE(r.status == InsideScorer::Status::Parsed);
+        REQUIRE(r.logProbability <= 1e-9);
+        total += std::exp(r.logProbability);
+    }
+    REQUIRE(total <= 1.0 + 1e-4);
+}
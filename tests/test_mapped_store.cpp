@@ -0,0 +1,98 @@
+// File: test_mapped_store.cpp
+// Purpose: Unit tests for the MappedStore memory resource and out-of-core RDSGraph distillation.
+
+#include "catch.hpp"
+#include "MappedStore.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string tempDirectory() {
+    return std::filesystem::temp_directory_path().string();
+}
+
+std::string distilled(RDSGraph& graph, unsigned int contextSize) {
+    graph.setQuiet(true);
+    graph.distill(ADIOSParams(0.9, 0.01, contextSize, 0.65));
+    std::ostringstream out;
+    graph.convert2PCFG(out);
+    return out.str();
+}
+
+}  // namespace
+
+TEST_CASE("MappedStore: blocks are reused by size class and large blocks get their own mapping", "[outofcore]") {
+    MappedStore store(tempDirectory(), 0, 64 << 10);
+    REQUIRE(store.mappedBytes() >= (64u << 10));
+
+    void* small = store.allocate(24);
+    REQUIRE(store.owns(small));
+    REQUIRE(store.allocatedBytes() == 32);
+    store.deallocate(small, 24);
+    REQUIRE(store.allocatedBytes() == 0);
+    REQUIRE(store.allocate(30) == small);  // same size class, from the free list
+    store.deallocate(small, 30);
+
+    std::size_t mapped = store.mappedBytes();
+    {
+        std::pmr::vector<unsigned int> values(&store);
+        for (unsigned int i = 0; i < 100000; i++) values.push_back(i * 7);
+        REQUIRE(store.owns(values.data()));
+        REQUIRE(store.mappedBytes() > mapped);
+        bool intact = true;
+        for (unsigned int i = 0; i < values.size(); i++) intact = intact && (values[i] == i * 7);
+        REQUIRE(intact);
+        store.advise(values.data(), values.size() * sizeof(unsigned int), MappedStore::Access::Cold);
+        store.advise(values.data(), values.size() * sizeof(unsigned int), MappedStore::Access::WillNeed);
+        REQUIRE(values[99999] == 99999u * 7);
+    }
+    REQUIRE(store.mappedBytes() == mapped);
+    REQUIRE(store.allocatedBytes() == 0);
+
+    int local = 0;
+    REQUIRE_FALSE(store.owns(&local));
+    store.advise(&local, sizeof(local), MappedStore::Access::Cold);  // ignored
+
+    REQUIRE_THROWS_AS(MappedStore("/nonexistent/madios-store-dir"), std::runtime_error);
+}
+
+TEST_CASE("RDSGraph: out-of-core distillation learns the same grammar", "[outofcore]") {
+    std::vector<std::vector<std::string>> sentences = testCorpus();
+    REQUIRE(!sentences.empty());
+    for (unsigned int contextSize : {2u, 5u}) {
+        RDSGraph in_memory(sentences);
+        std::string expected = distilled(in_memory, contextSize);
+
+        auto store = std::make_shared<MappedStore>(tempDirectory(), 1 << 10, 256 << 10);
+        {
+            RDSGraph out_of_core(sentences, store);
+            REQUIRE(store->allocatedBytes() > 0);
+            REQUIRE(store->owns(out_of_core.getPaths()[0].data()));
+            REQUIRE(distilled(out_of_core, contextSize) == expected);
+            REQUIRE(store->owns(out_of_core.getPaths()[0].data()));
+        }
+        REQUIRE(store->allocatedBytes() == 0);
+    }
+}
+
+TEST_CASE("RDSGraph: a corpus streamed into the store learns the same grammar", "[outofcore]") {
+    RDSGraph in_memory(testCorpus());
+    std::string expected = distilled(in_memory, 5);
+
+    auto store = std::make_shared<MappedStore>(tempDirectory(), 1 << 10, 256 << 10);
+    std::ifstream corpus(MADIOS_SOURCE_DIR "/test/corpus.txt");
+    RDSGraph streamed(corpus, store);
+    REQUIRE(streamed.getPaths().size() == testCorpus().size());
+    REQUIRE(distilled(streamed, 5) == expected);
+
+    std::istringstream blank("\n  \n* #\n");
+    REQUIRE_THROWS_AS(RDSGraph(blank, store), std::invalid_argument);
+}
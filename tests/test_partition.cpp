@@ -0,0 +1,110 @@
+// File: test_partition.cpp
+// Purpose: Unit tests for partitioned distillation of RDSGraph.
+//
+// A corpus of two disjoint vocabularies splits into two components; distilling
+// them separately must not depend on the number of threads and must learn what
+// a run on the whole corpus learns.
+
+#include "catch.hpp"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<std::string>> partitionCorpus(const std::string& prefix) {
+    std::vector<std::string> lines = {
+        "Cindy believes that Joe believes that to please is easy",
+        "Cindy believes that Cindy believes that to read is tough",
+        "Pam thinks that Jim believes that to please is tough",
+        "Beth believes that George believes that to please is easy",
+        "Pam believes that Cindy believes that to read is easy",
+        "Beth thinks that Beth thinks that to read is tough",
+        "that Cindy is easy to read annoys Cindy",
+        "that the cat is eager to please disturbs the cat",
+        "that the cow is easy to read annoys the horse",
+        "that Cindy is eager to please bothers the dog",
+        "that the horse is easy to please annoys Jim",
+        "Pam thinks that Cindy thinks that to please is easy"
+    };
+    return corpusOf(lines, prefix);
+}
+
+// The two vocabularies interleaved, so that components are not contiguous runs of paths
+std::vector<std::vector<std::string>> mixedCorpus() {
+    std::vector<std::vector<std::string>> a = partitionCorpus(""), b = partitionCorpus("x_"), corpus;
+    for (size_t i = 0; i < a.size(); i++) {
+        corpus.push_back(a[i]);
+        corpus.push_back(b[i]);
+    }
+    return corpus;
+}
+
+std::string pcfgOf(RDSGraph& graph) {
+    std::ostringstream out;
+    graph.convert2PCFG(out);
+    return out.str();
+}
+
+unsigned int unitCount(const RDSGraph& graph) {
+    unsigned int units = 0;
+    for (const auto& node : graph.getNodes())
+        if (node.type == LexiconTypes::SP || node.type == LexiconTypes::EC) units++;
+    return units;
+}
+
+}  // namespace
+
+TEST_CASE("RDSGraph: partition() separates disjoint vocabularies", "[partition]") {
+    RDSGraph graph(mixedCorpus());
+    std::vector<std::vector<unsigned int>> components = graph.partition();
+    REQUIRE(components.size() == 2);
+    REQUIRE(components[0].size() == 12);
+    REQUIRE(components[1].size() == 12);
+    for (unsigned int i = 0; i < 12; i++) {
+        REQUIRE(components[0][i] == 2 * i);
+        REQUIRE(components[1][i] == 2 * i + 1);
+    }
+
+    RDSGraph single(partitionCorpus(""));
+    REQUIRE(single.partition().size() == 1);
+}
+
+TEST_CASE("RDSGraph: partitioned distillation is independent of the thread count", "[partition]") {
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    RDSGraph serial(mixedCorpus());
+    serial.setQuiet(true);
+    REQUIRE(serial.distillPartitioned(params, 1) == 2);
+    RDSGraph parallel(mixedCorpus());
+    parallel.setQuiet(true);
+    REQUIRE(parallel.distillPartitioned(params, 4) == 2);
+    REQUIRE(pcfgOf(serial) == pcfgOf(parallel));
+    REQUIRE(serial.getPaths() == parallel.getPaths());
+
+    // flows are normalised by the whole corpus, so the units are those a run on the whole graph
+    // learns (numbered by component instead of interleaved)
+    RDSGraph whole(mixedCorpus());
+    whole.setQuiet(true);
+    whole.distill(params);
+    REQUIRE(unitCount(serial) == unitCount(whole));
+    for (size_t i = 0; i < whole.getPaths().size(); i++)
+        REQUIRE(serial.getPaths()[i].size() == whole.getPaths()[i].size());
+    REQUIRE(serial.partition().size() == 2);  // merges never join components
+}
+
+TEST_CASE("RDSGraph: a single component is distilled like distill()", "[partition]") {
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    RDSGraph whole(partitionCorpus(""));
+    whole.setQuiet(true);
+    whole.distill(params);
+    RDSGraph partitioned(partitionCorpus(""));
+    partitioned.setQuiet(true);
+    REQUIRE(partitioned.distillPartitioned(params, 2) == 1);
+    REQUIRE(pcfgOf(whole) == pcfgOf(partitioned));
+
+    RDSGraph empty;
+    REQUIRE_THROWS_AS(empty.distillPartitioned(params, 2), std::runtime_error);
+}
@@ -0,0 +1,62 @@
+// File: test_path_set.cpp
+// Purpose: Unit tests for PathSet, the per-node set of paths used to prune occurrence scans.
+
+#include "catch.hpp"
+#include "PathSet.h"
+#include <memory_resource>
+#include <vector>
+
+namespace {
+
+ConnectionList occurrences(const std::vector<Connection>& list) {
+    return ConnectionList(list.begin(), list.end());
+}
+
+}  // namespace
+
+TEST_CASE("PathSet: sparse and dense forms hold the paths of an occurrence list", "[pathset]") {
+    PathSet sparse;
+    sparse.assign(occurrences({{7, 1}, {7, 4}, {2, 3}, {90, 1}}), 1000);  // corpus order, not slot order
+    REQUIRE_FALSE(sparse.isDense());
+    REQUIRE(sparse.size() == 3);
+    REQUIRE(sparse.contains(2));
+    REQUIRE(sparse.contains(7));
+    REQUIRE(sparse.contains(90));
+    REQUIRE_FALSE(sparse.contains(3));
+    REQUIRE_FALSE(sparse.contains(5000));
+
+    std::vector<Connection> many;
+    for (unsigned int path = 0; path < 1000; path += 3) many.push_back(Connection(path, 1));
+    PathSet dense;
+    dense.assign(occurrences(many), 1000);
+    REQUIRE(dense.isDense());
+    REQUIRE(dense.size() == 334);
+    REQUIRE(dense.contains(999));
+    REQUIRE_FALSE(dense.contains(998));
+    REQUIRE_FALSE(dense.contains(5000));
+
+    PathSet empty;
+    empty.assign(ConnectionList(), 1000);
+    REQUIRE(empty.size() == 0);
+    REQUIRE_FALSE(empty.contains(0));
+}
+
+TEST_CASE("PathSet: intersect keeps the paths in every set, in increasing order", "[pathset]") {
+    std::vector<Connection> thirds, halves;
+    for (unsigned int path = 0; path < 600; path += 3) thirds.push_back(Connection(path, 0));
+    for (unsigned int path = 0; path < 600; path += 2) halves.push_back(Connection(path, 2));
+    PathSet a, b, c;
+    a.assign(occurrences(thirds), 600);
+    b.assign(occurrences(halves), 600);
+    c.assign(occurrences({{300, 1}, {12, 0}, {13, 5}, {598, 2}}), 600);
+
+    std::pmr::vector<const PathSet*> sets = {&a, &b};
+    std::pmr::vector<unsigned int> out;
+    PathSet::intersect(sets, out);
+    REQUIRE(out.size() == 100);
+    for (unsigned int k = 0; k < out.size(); k++) REQUIRE(out[k] == 6 * k);
+
+    sets = {&a, &b, &c};
+    PathSet::intersect(sets, out);
+    REQUIRE(out == std::pmr::vector<unsigned int>({12, 300}));
+}
@@ -0,0 +1,92 @@
+// File: test_pattern_event_log.cpp
+// Purpose: Unit tests for the JSON Lines distillation event stream (PatternEventLog).
+
+#include "catch.hpp"
+#include "PatternEventLog.h"
+#include "RDSGraph.h"
+#include "utils/json.hpp"
+#include "test_helpers.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("PatternEventLog: one event per learned unit, in grammar order", "[rdsgraph][events]") {
+    const char* filename = "test_madios_events_tmp.jsonl";
+    RDSGraph g(corpusOf({"the cat sat on the mat", "the dog sat on the mat",
+                         "the cat lay on the rug", "the dog lay on the rug",
+                         "a cat sat on the mat", "a dog lay on the rug"}));
+    g.setQuiet(true);
+    {
+        auto log = std::make_shared<PatternEventLog>(filename);
+        g.setEventLog(log);
+        g.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+        log->flush();
+        g.setEventLog(nullptr);
+    }
+
+    std::ifstream in(filename);
+    REQUIRE(in.is_open());
+    std::vector<nlohmann::json> events;
+    std::string line;
+    while (std::getline(in, line)) events.push_back(nlohmann::json::parse(line));
+    in.close();
+    std::remove(filename);
+
+    REQUIRE(!events.empty());
+    REQUIRE(events.back()["event"] == "end");
+    unsigned int sps = 0, ecs = 0;
+    for (const auto& e : events) {
+        if (e["event"] == "SP" || e["event"] == "EC") {
+            unsigned int id = e["id"];
+            REQUIRE(id < g.getNodes().size());
+            REQUIRE(e["name"] == g.getNodeName(id));
+            REQUIRE(e["members"].size() >= 1);
+            REQUIRE(e["p_values"].size() == 2);
+            if (e["event"] == "SP") sps++; else ecs++;
+        }
+    }
+    REQUIRE(sps == g.getPatternCount());
+    REQUIRE(events.back()["patterns"] == sps);
+    REQUIRE(events.back()["classes"] == ecs);
+}
+
+TEST_CASE("PatternEventLog: a new EC has the occurrences of the pattern that holds it", "[rdsgraph][events]") {
+    const char* filename = "test_madios_ec_events_tmp.jsonl";
+    RDSGraph g(testCorpus());
+    g.setQuiet(true);
+    {
+        auto log = std::make_shared<PatternEventLog>(filename);
+        g.setEventLog(log);
+        g.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+        log->flush();
+        g.setEventLog(nullptr);
+    }
+
+    std::ifstream in(filename);
+    REQUIRE(in.is_open());
+    std::vector<nlohmann::json> events;
+    std::string line;
+    while (std::getline(in, line)) events.push_back(nlohmann::json::parse(line));
+    in.close();
+    std::remove(filename);
+
+    unsigned int ecs = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i]["event"] != "EC") continue;
+        ecs++;
+        size_t next = i + 1;
+        while (next < events.size() && events[next]["event"] == "EC") next++;
+        REQUIRE(next < events.size());
+        REQUIRE(events[next]["event"] == "SP");  // ECs are logged right before their pattern
+        REQUIRE(events[i]["occurrences"] >= 1);
+        REQUIRE(events[i]["occurrences"] == events[next]["occurrences"]);
+    }
+    REQUIRE(ecs > 0);
+}
+
+TEST_CASE("PatternEventLog: unwritable file throws", "[events]") {
+    REQUIRE_THROWS_AS(PatternEventLog("/nonexistent-dir/events.jsonl"), std::runtime_error);
+}
@@ -0,0 +1,96 @@
+// File: test_pattern_tagger.cpp
+// Purpose: Unit tests for PCFG parsing and the Aho-Corasick PatternTagger.
+
+#include "catch.hpp"
+#include "PCFG.h"
+#include "PatternTagger.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* tinyGrammar =
+    "E10 -> cat [0.5]\n"
+    "E10 -> dog [0.5]\n"
+    "P11 -> the E10 [1]\n"
+    "P12 -> P11 sat down [1]\n"
+    "S -> P12 [0.5]\n"
+    "S -> a P11 ran [0.5]\n";
+
+}  // namespace
+
+TEST_CASE("PCFG: parses the convert2PCFG text format", "[pcfg][tagger]") {
+    std::istringstream in(tinyGrammar);
+    PCFG g = PCFG::read(in);
+    REQUIRE(g.rules().size() == 6);
+    REQUIRE(g.startSymbol() != PCFG::npos);
+    REQUIRE(g.isPattern(g.symbolId("P11")));
+    REQUIRE_FALSE(g.isPattern(g.symbolId("E10")));
+    REQUIRE_FALSE(g.isNonterminal(g.symbolId("cat")));
+    REQUIRE(g.rulesFor(g.symbolId("E10")).size() == 2);
+    REQUIRE(g.symbolId("missing") == PCFG::npos);
+
+    std::istringstream bad("P1 -> a b\n");
+    REQUIRE_THROWS_AS(PCFG::read(bad), std::runtime_error);
+}
+
+TEST_CASE("PatternTagger: leftmost-longest pattern spans", "[tagger]") {
+    std::istringstream in(tinyGrammar);
+    PatternTagger tagger(PCFG::read(in));
+    REQUIRE(tagger.patternCount() == 2);
+    REQUIRE(tagger.skippedCount() == 0);
+
+    // the longer P12 wins over the P11 it contains
+    auto spans = tagger.tag(words("the dog sat down and the cat ran"));
+    REQUIRE(spans.size() == 2);
+    REQUIRE(spans[0].start == 0);
+    REQUIRE(spans[0].length == 4);
+    REQUIRE(tagger.patternName(spans[0].pattern) == "P12");
+    REQUIRE(spans[1].start == 5);
+    REQUIRE(spans[1].length == 2);
+    REQUIRE(tagger.patternName(spans[1].pattern) == "P11");
+
+    std::string out;
+    tagger.tagLine("  the cat sat down\tthe unknown dog ", out);
+    REQUIRE(out == "[P12 the cat sat down] the unknown dog");
+
+    // the cap skips patterns with too many expansions (P11 and P12 each have 2)
+    std::istringstream again(tinyGrammar);
+    PatternTagger capped(PCFG::read(again), 1);
+    REQUIRE(capped.patternCount() == 0);
+    REQUIRE(capped.skippedCount() == 2);
+    REQUIRE(capped.tag(words("the cat sat down")).empty());
+}
+
+TEST_CASE("PatternTagger: tags the sentences a grammar was learned from", "[tagger]") {
+    std::vector<std::vector<std::string>> corpus;
+    for (const char* line : {"the cat sat on the mat", "the dog sat on the mat",
+                             "the cat lay on the rug", "the dog lay on the rug",
+                             "a cat sat on the mat", "a dog lay on the rug"})
+        corpus.push_back(words(line));
+    RDSGraph g(corpus);
+    g.setQuiet(true);
+    g.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+
+    PCFG grammar = PCFG::fromGraph(g);
+    std::stringstream text;
+    g.convert2PCFG(text);
+    REQUIRE(grammar.rules().size() == static_cast<size_t>(std::count(std::istreambuf_iterator<char>(text), std::istreambuf_iterator<char>(), '\n')));
+
+    PatternTagger tagger(grammar);
+    REQUIRE(tagger.patternCount() == g.getPatternCount());
+    for (const auto& sentence : corpus) {
+        unsigned int covered = 0;
+        for (const auto& span : tagger.tag(sentence)) {
+            REQUIRE(span.start >= covered);
+            REQUIRE(span.start + span.length <= sentence.size());
+            covered = span.start + span.length;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// File: test_precision.cpp
+// Purpose: Unit tests for the single-precision statistics pipeline, its validation mode and approximated significance tails.
+
+#include "catch.hpp"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<std::string>> precisionCorpus() {
+    return corpusOf({"Cindy believes that Joe believes that to please is easy",
+                     "Cindy believes that Cindy believes that to read is tough",
+                     "Pam thinks that Jim believes that to please is tough",
+                     "Beth believes that George believes that to please is easy",
+                     "that Cindy is easy to read annoys Cindy",
+                     "that the cat is eager to please disturbs the cat",
+                     "that the cow is easy to read annoys the horse",
+                     "Pam thinks that Cindy thinks that to please is easy"});
+}
+
+std::string grammarWith(StatsPrecision::PrecisionEnum precision, unsigned int contextSize, RDSGraph& g) {
+    g.setQuiet(true);
+    ADIOSParams params(0.9, 0.01, contextSize, 0.65);
+    params.precision = precision;
+    g.distill(params);
+    std::stringstream ss;
+    g.convert2PCFG(ss);
+    return ss.str();
+}
+
+}  // namespace
+
+TEST_CASE("RDSGraph: single precision statistics learn the same grammar", "[rdsgraph][precision]") {
+    for (unsigned int contextSize : {2u, 5u}) {
+        RDSGraph reference(precisionCorpus());
+        RDSGraph single(precisionCorpus());
+        RDSGraph validated(precisionCorpus());
+        std::string expected = grammarWith(StatsPrecision::Double, contextSize, reference);
+        REQUIRE(grammarWith(StatsPrecision::Single, contextSize, single) == expected);
+        REQUIRE(grammarWith(StatsPrecision::Validate, contextSize, validated) == expected);
+        REQUIRE(reference.getPrecisionChecks() == 0);
+        REQUIRE(validated.getPrecisionChecks() > 0);
+        REQUIRE(validated.getPrecisionMismatches() == 0);
+    }
+}
+
+TEST_CASE("RDSGraph: significance approximation is off by default and counted when on", "[rdsgraph][precision]") {
+    RDSGraph exact(precisionCorpus());
+    std::string expected = grammarWith(StatsPrecision::Double, 5, exact);
+    REQUIRE(exact.getApproximatedSearches() == 0);
+    REQUIRE(exact.getUncertainSearches() == 0);
+
+    // Every tail may be approximated within the default error: the incomplete beta form applies at
+    // these counts, is counted, and learns the exact grammar.
+    RDSGraph approximate(precisionCorpus());
+    approximate.setQuiet(true);
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    params.approximateAbove = 1;
+    approximate.distill(params);
+    std::stringstream ss;
+    approximate.convert2PCFG(ss);
+    REQUIRE(ss.str() == expected);
+    REQUIRE(approximate.getApproximatedSearches() > 0);
+    REQUIRE(approximate.getUncertainSearches() <= approximate.getApproximatedSearches());
+    // memo hits add to the counters once, as the search they recall
+    REQUIRE(approximate.getRecalledSearches() > 0);
+    REQUIRE(approximate.getApproximatedSearches() <= approximate.getPatternSearches() + approximate.getRecalledSearches());
+}
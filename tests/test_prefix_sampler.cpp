@@ -0,0 +1,111 @@
+// File: test_prefix_sampler.cpp
+// Purpose: Unit tests for prefix probabilities and prefix-constrained sampling with PrefixSampler.
+
+#include "catch.hpp"
+#include "FrozenGrammar.h"
+#include "PCFG.h"
+#include "PrefixSampler.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::shared_ptr<const FrozenGrammar> frozenOf(const char* text) {
+    return std::make_shared<const FrozenGrammar>(parse(text));
+}
+
+std::string join(const std::vector<std::string>& tokens) {
+    std::string text;
+    for (const auto& token : tokens) text += (text.empty() ? "" : " ") + token;
+    return text;
+}
+
+}  // namespace
+
+TEST_CASE("PrefixSampler: tables and prefix probabilities", "[prefix]") {
+    PrefixSampler sampler(frozenOf(
+        "E1 -> a [0.25]\n"
+        "E1 -> b [0.75]\n"
+        "P2 -> the E1 [1]\n"
+        "S -> P2 sat [0.6]\n"
+        "S -> P2 ran fast [0.4]\n"));
+    const FrozenGrammar& g = sampler.grammar();
+    unsigned int S = g.startSymbol(), P2 = g.symbolId("P2");
+    REQUIRE(sampler.canStartWith(S, g.symbolId("the")));
+    REQUIRE_FALSE(sampler.canStartWith(S, g.symbolId("a")));
+    REQUIRE(sampler.canReach(S, g.symbolId("fast")));
+    REQUIRE_FALSE(sampler.canReach(P2, g.symbolId("fast")));
+
+    REQUIRE(sampler.prefixProbability({}) == 1.0);
+    REQUIRE(sampler.prefixProbability(words("the")) == Approx(1.0));
+    REQUIRE(sampler.prefixProbability(words("the b")) == Approx(0.75));
+    REQUIRE(sampler.prefixProbability(words("the b ran")) == Approx(0.3));
+    REQUIRE(sampler.prefixProbability(words("the a sat")) == Approx(0.15));
+    REQUIRE(sampler.prefixProbability(words("sat")) == 0.0);
+    REQUIRE(sampler.prefixProbability(words("the zzz")) == 0.0);
+
+    std::mt19937 rng(3);
+    REQUIRE(sampler.complete(words("sat"), 5, rng).empty());
+    for (const auto& c : sampler.complete(words("the b ran"), 20, rng))
+        REQUIRE(join(c) == "fast");
+    REQUIRE(sampler.complete(words("the a sat"), 1, rng).front().empty());
+
+    std::map<std::string, int> seen;
+    const int draws = 20000;
+    for (const auto& c : sampler.complete(words("the b"), draws, rng))
+        seen[join(c)]++;
+    REQUIRE(seen.size() == 2);
+    REQUIRE(seen["sat"] / double(draws) == Approx(0.6).margin(0.02));
+    REQUIRE(seen["ran fast"] / double(draws) == Approx(0.4).margin(0.02));
+}
+
+TEST_CASE("PrefixSampler: rejects recursive grammars", "[prefix]") {
+    REQUIRE_THROWS_AS(PrefixSampler(frozenOf("P1 -> a P1 [0.5]\nP1 -> a [0.5]\nS -> P1 [1]\n")), std::runtime_error);
+    REQUIRE_THROWS_AS(PrefixSampler(nullptr), std::invalid_argument);
+}
+
+TEST_CASE("PrefixSampler: learned grammar completions are consistent", "[prefix]") {
+    std::vector<std::vector<std::string>> corpus;
+    for (const char* line : {"the cat sat on the mat", "the dog sat on the mat",
+                             "the cat lay on the rug", "the dog lay on the rug",
+                             "a cat sat on the mat", "a dog lay on the rug"})
+        corpus.push_back(words(line));
+    RDSGraph graph(corpus);
+    graph.setQuiet(true);
+    graph.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+    PrefixSampler sampler(graph.freeze());
+    const FrozenGrammar& g = sampler.grammar();
+
+    // P(prefix) = P(sentence == prefix) + sum over next words w of P(prefix w)
+    for (const char* text : {"the", "the cat", "a dog lay"}) {
+        std::vector<std::string> prefix = words(text);
+        double total = 0.0;
+        auto whole = g.score(prefix);
+        if (whole.status == InsideScorer::Status::Parsed)
+            total += std::exp(whole.logProbability);
+        for (unsigned int id = 0; id < g.symbolCount(); id++)
+            if (!g.isNonterminal(id)) {
+                std::vector<std::string> longer(prefix);
+                longer.push_back(g.symbolName(id));
+                total += sampler.prefixProbability(longer);
+            }
+        REQUIRE(sampler.prefixProbability(prefix) > 0.0);
+        REQUIRE(total == Approx(sampler.prefixProbability(prefix)));
+    }
+
+    std::mt19937 rng(11);
+    std::vector<std::string> prefix = words("the cat");
+    for (const auto& c : sampler.complete(prefix, 200, rng)) {
+        std::vector<std::string> sentence(prefix);
+        sentence.insert(sentence.end(), c.begin(), c.end());
+        REQUIRE(g.score(sentence).status == InsideScorer::Status::Parsed);
+    }
+}
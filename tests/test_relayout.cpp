@@ -0,0 +1,78 @@
+// File: test_relayout.cpp
+// Purpose: Unit tests for the locality relayout of RDSGraph.
+//
+// Relayout only changes the storage layout, so distilling with it enabled must
+// give exactly the same grammar, paths and node names as a canonical run.
+
+#include "catch.hpp"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<std::string>> relayoutCorpus() {
+    std::vector<std::string> lines = {
+        "Cindy believes that Joe believes that to please is easy",
+        "Cindy believes that Cindy believes that to read is tough",
+        "Pam thinks that Jim believes that to please is tough",
+        "Beth believes that George believes that to please is easy",
+        "Pam believes that Cindy believes that to read is easy",
+        "Beth thinks that Beth thinks that to read is tough",
+        "that Cindy is easy to read annoys Cindy",
+        "that the cat is eager to please disturbs the cat",
+        "that the cow is easy to read annoys the horse",
+        "that Cindy is eager to please bothers the dog",
+        "that the horse is easy to please annoys Jim",
+        "Pam thinks that Cindy thinks that to please is easy"
+    };
+    return corpusOf(lines);
+}
+
+std::string distilledGrammar(unsigned int contextSize, unsigned int relayoutInterval,
+                             std::vector<std::string>& pathNames) {
+    RDSGraph g(relayoutCorpus());
+    g.setQuiet(true);
+    ADIOSParams params(0.9, 0.01, contextSize, 0.65);
+    params.relayoutInterval = relayoutInterval;
+    g.distill(params);
+    REQUIRE_FALSE(g.isRelaidOut());
+    pathNames.clear();
+    for (const auto& path : g.getPaths()) {
+        std::string names;
+        for (unsigned int node : path) names += g.getNodeName(node) + " ";
+        pathNames.push_back(names);
+    }
+    std::stringstream ss;
+    g.convert2PCFG(ss);
+    return ss.str();
+}
+
+}  // namespace
+
+TEST_CASE("RDSGraph: relayout does not change the distilled grammar", "[rdsgraph][relayout]") {
+    for (unsigned int contextSize : {2u, 5u}) {
+        std::vector<std::string> plainPaths, relaidPaths;
+        std::string plain = distilledGrammar(contextSize, 0, plainPaths);
+        std::string relaid = distilledGrammar(contextSize, 1, relaidPaths);
+        REQUIRE(plain == relaid);
+        REQUIRE(plainPaths == relaidPaths);
+    }
+}
+
+TEST_CASE("RDSGraph: relayout and restoreLayout round trip", "[rdsgraph][relayout]") {
+    RDSGraph g(relayoutCorpus());
+    std::string before = g.toString();
+    g.relayout();
+    REQUIRE(g.isRelaidOut());
+    // the start and end symbols keep their ids
+    REQUIRE(g.getNodeName(0) == "*");
+    REQUIRE(g.getNodeName(1) == "#");
+    // the hottest word is stored right after them
+    REQUIRE(g.getNodes()[2].getConnections().size() >= g.getNodes()[3].getConnections().size());
+    g.restoreLayout();
+    REQUIRE_FALSE(g.isRelaidOut());
+    REQUIRE(g.toString() == before);
+}
@@ -0,0 +1,56 @@
+// File: test_scratch_arena.cpp
+// Purpose: Unit tests for the per-path ScratchArena and the arena-backed ConnectionMatrix.
+
+#include "catch.hpp"
+#include "RDSNode.h"
+#include "ScratchArena.h"
+#include <memory_resource>
+#include <vector>
+
+TEST_CASE("ScratchArena: reserve grows to the high-water mark, then no heap allocations", "[arena]") {
+    ScratchArena arena;
+    REQUIRE(arena.reserved() == 0);
+
+    auto one_path = [&arena]() {
+        ScratchArena::Scope scope(arena);
+        std::pmr::vector<std::pmr::vector<int> > lists(&arena);
+        for (int i = 0; i < 64; i++) {
+            lists.emplace_back();
+            for (int j = 0; j < 100; j++) lists.back().push_back(j);
+        }
+        return arena.overflowCount();
+    };
+
+    REQUIRE(one_path() > 0);
+    std::size_t reserve = arena.reserved();
+    REQUIRE(reserve > 0);
+    for (int k = 0; k < 5; k++)
+        REQUIRE(one_path() == 0);
+    REQUIRE(arena.reserved() == reserve);
+}
+
+TEST_CASE("ScratchArena: reserve is capped", "[arena]") {
+    ScratchArena arena(4096);
+    {
+        ScratchArena::Scope scope(arena);
+        std::pmr::vector<char> big(1 << 16, 'x', &arena);
+    }
+    REQUIRE(arena.reserved() == 4096);
+}
+
+TEST_CASE("ConnectionMatrix: symmetric cells allocated from the matrix resource", "[arena]") {
+    ScratchArena arena;
+    ConnectionMatrix m(&arena);
+    m.reset(3);
+    REQUIRE(m.dim1() == 3);
+    REQUIRE(m.dim2() == 3);
+    m(2, 0).push_back(Connection(1, 2));
+    REQUIRE(m(0, 2).size() == 1);
+    REQUIRE(m(0, 2).get_allocator().resource() == &arena);
+
+    ConnectionList moved(m.resource());
+    moved.push_back(Connection(4, 5));
+    const Connection *data = moved.data();
+    m(1, 1) = std::move(moved);
+    REQUIRE(m(1, 1).data() == data);  // same resource: the list is moved, not copied
+}
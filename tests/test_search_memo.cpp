@@ -0,0 +1,103 @@
+// File: test_search_memo.cpp
+// Purpose: Unit tests for the SearchMemo table of pattern-search outcomes.
+
+#include "catch.hpp"
+#include "RDSGraph.h"
+#include "SearchMemo.h"
+#include "test_helpers.h"
+#include <set>
+#include <string>
+#include <vector>
+
+TEST_CASE("SearchMemo: entries are valid until a dependency or the corpus size changes", "[memo]") {
+    SearchMemo memo;
+    std::vector<unsigned int> versions(10, 0);
+    std::vector<unsigned int> path = {0, 4, 7, 1};
+    REQUIRE(memo.find(path, versions, 100) == nullptr);
+
+    SearchMemo::Outcome outcome;
+    outcome.patterns.push_back(Range(1, 2));
+    outcome.pvalues.push_back(SignificancePair(0.001, 0.002));
+    memo.store(path, {0, 1, 4, 5, 7}, versions, 100, outcome);
+    REQUIRE(memo.size() == 1);
+
+    const SearchMemo::Outcome* found = memo.find(path, versions, 100);
+    REQUIRE(found != nullptr);
+    REQUIRE(found->patterns == outcome.patterns);
+    REQUIRE(found->pvalues == outcome.pvalues);
+    std::vector<unsigned int> same_content = {0, 4, 7, 1};
+    REQUIRE(memo.find(same_content, versions, 100) != nullptr);
+    std::vector<unsigned int> other = {0, 4, 7};
+    REQUIRE(memo.find(other, versions, 100) == nullptr);
+
+    REQUIRE(memo.find(path, versions, 99) == nullptr);
+    versions[3]++;  // not a dependency
+    REQUIRE(memo.find(path, versions, 100) != nullptr);
+    versions[5]++;  // EC member read by the search
+    REQUIRE(memo.find(path, versions, 100) == nullptr);
+
+    memo.store(path, {0, 1, 4, 5, 7}, versions, 100, SearchMemo::Outcome());
+    REQUIRE(memo.size() == 1);
+    found = memo.find(path, versions, 100);
+    REQUIRE(found != nullptr);
+    REQUIRE(found->patterns.empty());
+    REQUIRE(memo.hits() == 4);
+    REQUIRE(memo.misses() == 4);
+
+    memo.clear();
+    REQUIRE(memo.size() == 0);
+    REQUIRE(memo.find(path, versions, 100) == nullptr);
+}
+
+TEST_CASE("RDSGraph: identical paths are searched once and recalled from the memo", "[memo]") {
+    std::vector<std::vector<std::string>> base = testCorpus();
+    std::set<std::vector<std::string>> distinct(base.begin(), base.end());
+    std::vector<std::vector<std::string>> corpus;
+    for (int copy = 0; copy < 3; copy++) corpus.insert(corpus.end(), distinct.begin(), distinct.end());
+
+    // nothing is significant at this alpha, so no rewire makes the copies differ
+    RDSGraph graph(corpus);
+    graph.setQuiet(true);
+    ADIOSParams params(0.9, 1e-300, 2, 0.65);
+    params.approximateAbove = 1;
+    graph.distill(params);
+    REQUIRE(graph.getPatternSearches() == distinct.size());
+    REQUIRE(graph.getRecalledSearches() == 2 * distinct.size());
+    // every search here evaluates a tail; a recalled one counts once, as the search it recalls
+    REQUIRE(graph.getApproximatedSearches() == graph.getPatternSearches() + graph.getRecalledSearches());
+    REQUIRE(graph.getUncertainSearches() == 0);
+}
+
+TEST_CASE("SearchMemo: a store that would exceed the capacity clears the memo first", "[memo]") {
+    SearchMemo memo;
+    std::vector<unsigned int> versions(10, 0);
+    std::vector<unsigned int> a = {0, 4, 7, 1}, b = {0, 5, 7, 1}, c = {0, 6, 7, 1};
+    memo.store(a, {0, 1, 4, 7}, versions, 100, SearchMemo::Outcome());
+    std::size_t entry = memo.bytes();
+    REQUIRE(entry > 0);
+    memo.store(a, {0, 1, 4, 7}, versions, 100, SearchMemo::Outcome());  // overwriting keeps the size
+    REQUIRE(memo.bytes() == entry);
+
+    memo.setCapacity(2 * entry);
+    memo.store(b, {0, 1, 5, 7}, versions, 100, SearchMemo::Outcome());
+    REQUIRE(memo.size() == 2);
+    REQUIRE(memo.overflows() == 0);
+    memo.store(c, {0, 1, 6, 7}, versions, 100, SearchMemo::Outcome());
+    REQUIRE(memo.size() == 1);
+    REQUIRE(memo.overflows() == 1);
+    REQUIRE(memo.bytes() == entry);
+    REQUIRE(memo.find(a, versions, 100) == nullptr);
+    REQUIRE(memo.find(c, versions, 100) != nullptr);
+
+    // overwriting a stale entry of a full memo does not grow it, so nothing is cleared
+    memo.store(a, {0, 1, 4, 7}, versions, 100, SearchMemo::Outcome());
+    REQUIRE(memo.size() == 2);
+    versions[6]++;
+    REQUIRE(memo.find(c, versions, 100) == nullptr);
+    memo.store(c, {0, 1, 6, 7}, versions, 100, SearchMemo::Outcome());
+    REQUIRE(memo.size() == 2);
+    REQUIRE(memo.overflows() == 1);
+    REQUIRE(memo.bytes() == 2 * entry);
+    REQUIRE(memo.find(a, versions, 100) != nullptr);
+    REQUIRE(memo.find(c, versions, 100) != nullptr);
+}
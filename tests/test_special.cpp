@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "maths/special.h"
+#include <algorithm>
 #include <cmath>
 
 TEST_CASE("special: uniform_rand and normal_rand", "[special]") {
@@ -27,3 +28,80 @@ TEST_CASE("special: solve_cubic real roots", "[special]") {
     REQUIRE((std::abs(r0-2)<1e-6 || std::abs(r1-2)<1e-6 || std::abs(r2-2)<1e-6));
     REQUIRE((std::abs(r0-1)<1e-6 || std::abs(r1-1)<1e-6 || std::abs(r2-1)<1e-6));
 }
+
+TEST_CASE("special: gammq and normal_cdf", "[special]") {
+    REQUIRE(std::abs(gammq(1.0, 2.0) - std::exp(-2.0)) < 1e-10);
+    REQUIRE(std::abs(gammq(3.0, 0.5) - std::exp(-0.5) * (1.0 + 0.5 + 0.125)) < 1e-10);  // Poisson(0.5) <= 2
+    REQUIRE(std::abs(gammq(5.0, 20.0) - std::exp(-20.0) * (1.0 + 20.0 + 200.0 + 8000.0 / 6.0 + 160000.0 / 24.0)) < 1e-12);
+    REQUIRE(gammq(2.0, 0.0) == 1.0);
+    REQUIRE(std::abs(normal_cdf(0.0) - 0.5) < 1e-12);
+    REQUIRE(std::abs(normal_cdf(1.959963985) - 0.975) < 1e-8);
+}
+
+TEST_CASE("special: binomial tail approximations stay within their error bounds", "[special]") {
+    REQUIRE(std::abs(binom_cdf(2, 4, 0.5) - 0.6875) < 1e-12);
+    REQUIRE(std::abs(binom_cdf(4, 4, 0.3) - 1.0) < 1e-12);
+    for (unsigned int n : {200u, 2000u, 20000u}) {
+        for (double p : {0.001, 0.01, 0.3, 0.5}) {
+            double mean = n * p;
+            for (double z : {-2.0, -0.5, 0.0, 1.0}) {
+                double x = mean + z * std::sqrt(mean * (1.0 - p));
+                if (x < 0.0) continue;
+                unsigned int k = static_cast<unsigned int>(x);
+                double exact = binom_cdf(k, n, p);
+                REQUIRE(std::abs(binom_cdf_normal(k, n, p) - exact) <= binom_normal_error(n, p));
+                REQUIRE(std::abs(binom_cdf_poisson(k, n, p) - exact) <= binom_poisson_error(n, p));
+            }
+        }
+    }
+}
+
+TEST_CASE("special: binom_tail is exact below its threshold or above its error budget", "[special]") {
+    double error = -1.0;
+    REQUIRE(binom_tail(3, 500, 0.001, 0, 1e-3, error) == binom_cdf(3, 500, 0.001));
+    REQUIRE(error == 0.0);
+    REQUIRE(binom_tail(3, 500, 0.001, 1000, 1e-3, error) == binom_cdf(3, 500, 0.001));
+    REQUIRE(error == 0.0);
+    REQUIRE(binom_tail(40, 100, 0.4, 50, 1e-18, error) == binom_cdf(40, 100, 0.4));  // no bound small enough
+    REQUIRE(error == 0.0);
+
+    double approximated = binom_tail(3, 500, 0.001, 100, 1e-3, error);
+    REQUIRE(error > 0.0);
+    REQUIRE(error <= 1e-3);
+    REQUIRE(std::abs(approximated - binom_cdf(3, 500, 0.001)) <= error);
+}
+
+TEST_CASE("special: the incomplete beta tail stays within its rounding bound, tiny tails included", "[special]") {
+    for (unsigned int n : {50u, 2000u, 20000u}) {
+        for (double p : {0.001, 0.01, 0.3, 0.5, 0.9}) {
+            double mean = n * p;
+            double sd = std::sqrt(mean * (1.0 - p));
+            for (double z : {-30.0, -8.0, -2.0, 0.0, 1.0, 5.0}) {
+                double x = mean + z * sd;
+                if (x < 0.0 || x >= n) continue;
+                unsigned int k = static_cast<unsigned int>(x);
+                // a sum of many terms near 1 loses digits, so the reference sums the smaller side
+                double lower = binom_cdf(k, n, p);
+                double upper = 0.0;
+                for (unsigned int i = k + 1; i <= n; i++) upper += binom(i, n, p);
+                double exact = (lower < upper) ? lower : 1.0 - upper;
+                double error = -1.0;
+                double tail = binom_cdf_beta(k, n, p, error);
+                REQUIRE(error >= 0.0);
+                REQUIRE(std::abs(tail - exact) <= error);
+                REQUIRE(error <= 1e-8 * std::max(std::min(exact, 1.0 - exact), 1e-7));  // relative in the tails
+            }
+        }
+    }
+    double error = -1.0;
+    REQUIRE(binom_cdf_beta(10, 10, 0.5, error) == 1.0);
+    REQUIRE(error == 0.0);
+}
+
+TEST_CASE("special: binom_tail uses the incomplete beta tail where the O(1) bounds are too loose", "[special]") {
+    double error = 0.0;
+    double tail = binom_tail(40, 100, 0.4, 50, 1e-6, error);
+    REQUIRE(error > 0.0);
+    REQUIRE(error <= 1e-11);
+    REQUIRE(std::abs(tail - binom_cdf(40, 100, 0.4)) <= error);
+}
@@ -0,0 +1,156 @@
+// File: test_warm_start.cpp
+// Purpose: Unit tests for grammar snapshots and warm-starting distillation from an earlier grammar.
+
+#include "catch.hpp"
+#include "PCFG.h"
+#include "RDSGraph.h"
+#include "test_helpers.h"
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::vector<std::string>> corpus() {
+    return corpusOf({"the cat sat on the mat", "the dog sat on the mat",
+                     "the cat lay on the rug", "the dog lay on the rug",
+                     "a cat sat on the mat", "a dog lay on the rug"});
+}
+
+std::string pcfgText(const RDSGraph& graph) {
+    std::ostringstream out;
+    graph.convert2PCFG(out);
+    return out.str();
+}
+
+}  // namespace
+
+TEST_CASE("PCFG: snapshots round-trip exactly and are detected by load", "[warmstart]") {
+    PCFG grammar = parse("E1 -> cat [0.3333333333333333]\nE1 -> dog [0.6666666666666667]\nP2 -> the E1 [1]\nS -> P2 sat [1]\n");
+    std::stringstream snapshot;
+    grammar.writeSnapshot(snapshot);
+
+    PCFG copy = PCFG::readSnapshot(snapshot);
+    REQUIRE(copy.symbolCount() == grammar.symbolCount());
+    REQUIRE(copy.rules().size() == grammar.rules().size());
+    for (size_t r = 0; r < grammar.rules().size(); r++) {
+        REQUIRE(copy.rules()[r].lhs == grammar.rules()[r].lhs);
+        REQUIRE(copy.rules()[r].rhs == grammar.rules()[r].rhs);
+        REQUIRE(copy.rules()[r].probability == grammar.rules()[r].probability);
+    }
+    REQUIRE(copy.isPattern(copy.symbolId("P2")));
+
+    snapshot.clear();
+    snapshot.seekg(0);
+    REQUIRE(PCFG::load(snapshot).rules().size() == 4);
+    std::istringstream text("P1 -> a b [1]\n");
+    REQUIRE(PCFG::load(text).rules().size() == 1);
+
+    std::string bytes = snapshot.str();
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 3));
+    REQUIRE_THROWS_AS(PCFG::readSnapshot(truncated), std::runtime_error);
+    std::istringstream not_snapshot("P1 -> a b [1]\n");
+    REQUIRE_THROWS_AS(PCFG::readSnapshot(not_snapshot), std::runtime_error);
+}
+
+TEST_CASE("RDSGraph: warm start on the same corpus reproduces the cold grammar", "[warmstart]") {
+    std::vector<std::vector<std::string>> sentences = testCorpus();
+    REQUIRE(!sentences.empty());
+    RDSGraph cold(sentences);
+    cold.setQuiet(true);
+    unsigned int initial_nodes = cold.getNodes().size();
+    cold.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+    PCFG learned = cold.toPCFG();
+    REQUIRE(cold.getNodes().size() > initial_nodes);
+
+    RDSGraph warm(sentences);
+    warm.setQuiet(true);
+    unsigned int units = warm.warmStart(learned);
+    REQUIRE(units == cold.getNodes().size() - initial_nodes);
+    REQUIRE(warm.getPaths().size() == cold.getPaths().size());
+    for (size_t i = 0; i < warm.getPaths().size(); i++)
+        REQUIRE(warm.getPaths()[i].size() == cold.getPaths()[i].size());
+    warm.distill(ADIOSParams(0.9, 0.01, 5, 0.65));
+    REQUIRE(pcfgText(warm) == pcfgText(cold));
+    REQUIRE_THROWS_AS(warm.warmStart(learned), std::logic_error);
+}
+
+TEST_CASE("RDSGraph: warm start keeps only units built from known words", "[warmstart]") {
+    RDSGraph graph(corpus());
+    graph.setQuiet(true);
+    unsigned int units = graph.warmStart(parse(
+        "E1 -> cat [0.4]\nE1 -> bird [0.3]\nE1 -> dog [0.3]\n"
+        "P2 -> the E1 [1]\n"
+        "P3 -> the bird [1]\n"
+        "P4 -> P2 sat [1]\n"
+        "S -> P4 [1]\n"));
+    REQUIRE(units == 3);  // E1 (without bird), P2 and P4
+    const auto& nodes = graph.getNodes();
+    unsigned int sp = 0, ec = 0;
+    for (const auto& node : nodes) {
+        if (node.type == LexiconTypes::SP) sp++;
+        if (node.type == LexiconTypes::EC) {
+            ec++;
+            REQUIRE(graph.getNodeString(&node - &nodes[0]).find("bird") == std::string::npos);
+        }
+    }
+    REQUIRE(sp == 2);
+    REQUIRE(ec == 1);
+    // "the cat sat ..." is reduced to P4, "the cat lay ..." only to P2, "a cat sat ..." not at all
+    REQUIRE(graph.getPaths()[0].size() == 1 + 1 + 3 + 1);
+    REQUIRE(graph.getPaths()[2].size() == 1 + 1 + 4 + 1);
+    REQUIRE(graph.getPaths()[4].size() == 8);
+
+    RDSGraph recursive(corpus());
+    REQUIRE_THROWS_AS(recursive.warmStart(parse("P1 -> the P1 [1]\n")), std::runtime_error);
+}
+
+TEST_CASE("RDSGraph: progressive distillation doubles the sample up to the corpus", "[warmstart]") {
+    ADIOSParams params(0.9, 0.01, 5, 0.65);
+    std::vector<std::vector<std::string>> sentences = testCorpus();
+    RDSGraph graph(sentences);
+    graph.setQuiet(true);
+    std::vector<ProgressiveStage> stages;
+    unsigned int count = graph.distillProgressive(params, 4, 0.0, 1, [&](const ProgressiveStage& stage, const RDSGraph& stageGraph) {
+        stages.push_back(stage);
+        REQUIRE(stageGraph.getPaths().size() == stage.sentences);
+    });
+    REQUIRE(count == 4);  // 4, 8 and 16 of the 20 sentences, then the corpus
+    REQUIRE(stages.size() == 4);
+    for (unsigned int i = 0; i < 3; i++) {
+        REQUIRE(stages[i].number == i + 1);
+        REQUIRE(stages[i].sentences == (4u << i));
+        REQUIRE_FALSE(stages[i].final);
+        REQUIRE(stages[i].heldOutTested == std::min<size_t>(4u << i, sentences.size() - (4u << i)));
+        REQUIRE(stages[i].heldOutParsed <= stages[i].heldOutTested);
+    }
+    REQUIRE(stages[0].seededUnits == 0);
+    REQUIRE(stages[3].final);
+    REQUIRE(stages[3].distilled);
+    REQUIRE(stages[3].sentences == sentences.size());
+    unsigned int patterns = 0;
+    for (const auto& node : graph.getNodes())
+        if (node.type == LexiconTypes::SP) patterns++;
+    REQUIRE(stages[3].patterns == patterns);
+    REQUIRE(graph.getPaths().size() == sentences.size());
+
+    // the same seed draws the same samples
+    RDSGraph again(sentences);
+    again.setQuiet(true);
+    again.distillProgressive(params, 4, 0.0, 1);
+    REQUIRE(pcfgText(again) == pcfgText(graph));
+
+    // a spent budget stops after the first sample; the corpus is only reduced
+    RDSGraph budgeted(sentences);
+    budgeted.setQuiet(true);
+    std::vector<ProgressiveStage> budgetedStages;
+    REQUIRE(budgeted.distillProgressive(params, 4, 1e-9, 1, [&](const ProgressiveStage& stage, const RDSGraph&) { budgetedStages.push_back(stage); }) == 2);
+    REQUIRE_FALSE(budgetedStages[1].distilled);
+    REQUIRE(budgetedStages[1].seededUnits == budgetedStages[0].patterns + budgetedStages[0].classes);
+    REQUIRE(budgeted.toPCFG().rules().size() > 0);
+
+    REQUIRE_THROWS_AS(graph.distillProgressive(params, 4, 0.0, 1), std::logic_error);
+    RDSGraph fresh(sentences);
+    REQUIRE_THROWS_AS(fresh.distillProgressive(params, 0, 0.0, 1), std::invalid_argument);
+}